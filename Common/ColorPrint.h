@@ -19,4 +19,12 @@
     printf(RESET);                      \
 } while (0)                              \
 
+
+#define COLOR_FPRINT(STREAM, COLOR, ...) do  \
+{                                             \
+    fprintf(STREAM, COLOR);                    \
+    fprintf(STREAM, __VA_ARGS__);               \
+    fprintf(STREAM, RESET);                      \
+} while (0)                                       \
+
 #endif
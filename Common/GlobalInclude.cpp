@@ -1,5 +1,6 @@
 #include <string.h>
 #include <assert.h>
+#include <time.h>
 #include "GlobalInclude.h"
 #include "ColorPrint.h"
 
@@ -30,3 +31,13 @@ void CodePlaceCtor(CodePlace* place, const char* const file, const int line, con
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+double GetWallTime()
+{
+    timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
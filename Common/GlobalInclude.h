@@ -19,6 +19,9 @@ struct CodePlace
 void PrintPlace     (                  const char* const file, const int line, const char* const func);
 void CodePlaceCtor  (CodePlace* place, const char* const file, const int line, const char* const func);
 
+// seconds of monotonic clock, for time of benchmarks and of batch runs
+double GetWallTime  ();
+
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
 #define PRINT_PLACE(color, file, line, func) printf(color); PrintPlace(file, line, func); printf(RESET)
@@ -0,0 +1,457 @@
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "BatchDiff.h"
+#include "Differentiator.h"
+#include "SimplifyTree.h"
+#include "../Common/GlobalInclude.h"
+
+
+// text of chunk is filled by one worker, then written by main thread
+struct BatchText_t
+{
+    char*  data;
+    size_t size;
+    size_t capacity;
+};
+
+struct BatchChunk_t
+{
+    BatchText_t text;
+    bool        isDone;
+    size_t      errors;     // rejected expressions, their lines in text are error lines
+};
+
+// chunk number n lives in chunks[n % windowSize]: worker can't take chunk, until chunk windowSize before it is written
+struct BatchDiff_t
+{
+    BulkInput_t*    bulk;
+    BatchChunk_t*   chunks;
+    size_t          windowSize;
+    size_t          taken;
+    size_t          written;
+    size_t          expressions;
+    size_t          errors;
+    bool            isInputOver;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t  chunkDone;
+    pthread_cond_t  chunkWritten;
+};
+
+static void*   BatchWorker         (void* batchPtr);
+static size_t  BatchTakeChunk      (BatchDiff_t* batch, BulkExpression_t* expressions, size_t* chunk);
+static void    BatchWriteChunks    (BatchDiff_t* batch, FILE* out);
+static TreeErr BatchDiffExpression (const BulkExpression_t* expression, BatchText_t* text, SyntaxErr_t* syntaxErr);
+
+static TreeErr TextPrintError      (BatchText_t* text, size_t offset, const char* msg);
+
+static TreeErr TextPrintNode       (BatchText_t* text, const Node_t* node);
+static TreeErr TextPrintNumber     (BatchText_t* text, Number num);
+static TreeErr TextPrint           (BatchText_t* text, const char* str);
+static const char* GetNodeName     (const Node_t* node);
+
+static size_t  GetOnlineCores      ();
+
+// worker takes BatchChunkSize expressions at once, so lock is taken once per chunk, not per expression
+static const size_t BatchChunkSize  = 64;
+static const size_t BatchWindowSize = 8; // chunks per worker, that may wait for writing
+static const size_t BatchStackSize  = (size_t) 256 << 20; // Diff, SimplifyTree and print recurse once per level of tree
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr BatchDiff(BulkInput_t* bulk, FILE* out, size_t threads, BatchDiffStats_t* stats)
+{
+    assert(bulk);
+    assert(out);
+
+    TreeErr err = {};
+
+    double start = GetWallTime();
+
+    if (threads == 0) threads = GetOnlineCores();
+
+    BatchDiff_t batch = {};
+
+    batch.bulk       = bulk;
+    batch.windowSize = BatchWindowSize * threads;
+    batch.chunks     = (BatchChunk_t*) calloc(batch.windowSize, sizeof(BatchChunk_t));
+
+    pthread_t* workers = (pthread_t*) calloc(threads, sizeof(pthread_t));
+
+    if (!batch.chunks || !workers)
+    {
+        FREE(batch.chunks);
+        FREE(workers);
+        err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    pthread_mutex_init(&batch.mutex,        nullptr);
+    pthread_cond_init (&batch.chunkDone,    nullptr);
+    pthread_cond_init (&batch.chunkWritten, nullptr);
+
+    pthread_attr_t attr = {};
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, BatchStackSize);
+
+    size_t started = 0;
+
+    while (started < threads && pthread_create(&workers[started], &attr, BatchWorker, &batch) == 0) started++;
+
+    pthread_attr_destroy(&attr);
+
+    // without all workers nothing is written: started ones stop after chunks they have taken
+    if (started < threads)
+    {
+        pthread_mutex_lock(&batch.mutex);
+        batch.isInputOver = true;
+        pthread_cond_broadcast(&batch.chunkWritten);
+        pthread_mutex_unlock(&batch.mutex);
+
+        err.err = TreeErrorType::THREAD_CREATE_FAILED;
+    }
+    else
+    {
+        BatchWriteChunks(&batch, out);
+    }
+
+    for (size_t i = 0; i < started; i++) pthread_join(workers[i], nullptr);
+
+    pthread_cond_destroy (&batch.chunkWritten);
+    pthread_cond_destroy (&batch.chunkDone);
+    pthread_mutex_destroy(&batch.mutex);
+
+    for (size_t i = 0; i < batch.windowSize; i++) free(batch.chunks[i].text.data);
+
+    FREE(batch.chunks);
+    FREE(workers);
+
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    if (stats)
+    {
+        stats->expressions          = batch.expressions;
+        stats->errors               = batch.errors;
+        stats->threads              = threads;
+        stats->seconds              = GetWallTime() - start;
+        stats->expressionsPerSecond = (stats->seconds > 0) ? (double) batch.expressions / stats->seconds : 0;
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static void* BatchWorker(void* batchPtr)
+{
+    assert(batchPtr);
+
+    BatchDiff_t* batch = (BatchDiff_t*) batchPtr;
+
+    BulkExpression_t expressions[BatchChunkSize] = {};
+    size_t           chunk                       = 0;
+    size_t           quant                       = 0;
+
+    while ((quant = BatchTakeChunk(batch, expressions, &chunk)) > 0)
+    {
+        BatchChunk_t* slot = &batch->chunks[chunk % batch->windowSize];
+
+        slot->text.size = 0;
+        slot->errors    = 0;
+
+        for (size_t i = 0; i < quant; i++)
+        {
+            SyntaxErr_t syntaxErr = {};
+            TreeErr     err       = BatchDiffExpression(&expressions[i], &slot->text, &syntaxErr);
+
+            if (err.err == TreeErrorType::NO_ERR) continue;
+
+            // syntax error points into expression, other errors point to its start
+            size_t      offset = (size_t) (expressions[i].start - batch->bulk->data);
+            const char* msg    = TreeErrorMessage(err.err);
+
+            if (err.err == TreeErrorType::INPUT_SYNTAX_ERROR)
+            {
+                offset += syntaxErr.place.offset;
+                msg     = syntaxErr.msg;
+            }
+
+            TREE_ASSERT(TextPrintError(&slot->text, offset, msg));
+            slot->errors++;
+        }
+
+        pthread_mutex_lock(&batch->mutex);
+        slot->isDone = true;
+        pthread_cond_signal(&batch->chunkDone);
+        pthread_mutex_unlock(&batch->mutex);
+    }
+
+    return nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// returns quant of expressions in taken chunk, 0 if input is over
+static size_t BatchTakeChunk(BatchDiff_t* batch, BulkExpression_t* expressions, size_t* chunk)
+{
+    assert(batch);
+    assert(expressions);
+    assert(chunk);
+
+    pthread_mutex_lock(&batch->mutex);
+
+    while (!batch->isInputOver && batch->taken >= batch->written + batch->windowSize)
+        pthread_cond_wait(&batch->chunkWritten, &batch->mutex);
+
+    size_t quant = 0;
+
+    while (!batch->isInputOver && quant < BatchChunkSize)
+    {
+        if (BulkInputNext(batch->bulk, &expressions[quant])) quant++;
+        else                                                 batch->isInputOver = true;
+    }
+
+    if (quant > 0)
+    {
+        *chunk = batch->taken++;
+        batch->expressions += quant;
+    }
+    else
+    {
+        pthread_cond_signal(&batch->chunkDone); // writer may wait for end of input
+    }
+
+    pthread_mutex_unlock(&batch->mutex);
+
+    return quant;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// main thread writes chunks one by one in input order; file is written without lock
+static void BatchWriteChunks(BatchDiff_t* batch, FILE* out)
+{
+    assert(batch);
+    assert(out);
+
+    pthread_mutex_lock(&batch->mutex);
+
+    while (true)
+    {
+        BatchChunk_t* slot = &batch->chunks[batch->written % batch->windowSize];
+
+        while (!slot->isDone && !(batch->isInputOver && batch->written == batch->taken))
+            pthread_cond_wait(&batch->chunkDone, &batch->mutex);
+
+        if (!slot->isDone) break;
+
+        pthread_mutex_unlock(&batch->mutex);
+        fwrite(slot->text.data, sizeof(char), slot->text.size, out);
+        pthread_mutex_lock(&batch->mutex);
+
+        slot->isDone = false;
+        batch->errors += slot->errors;
+        batch->written++;
+        pthread_cond_broadcast(&batch->chunkWritten);
+    }
+
+    pthread_mutex_unlock(&batch->mutex);
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// tree is created in worker, so its arena belongs to worker only.
+// failed expression adds nothing to text, offset in syntaxErr is from start of expression.
+// tree may be broken after failed Diff or SimplifyTree, so its arena is freed without verification
+static TreeErr BatchDiffExpression(const BulkExpression_t* expression, BatchText_t* text, SyntaxErr_t* syntaxErr)
+{
+    assert(expression);
+    assert(text);
+    assert(syntaxErr);
+
+    TreeErr err = {};
+
+    Tree_t tree     = {};
+    size_t textSize = text->size;
+
+    err = TreeCtorBuffer(&tree, expression->start, expression->size, syntaxErr);
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    err = Diff(&tree);
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err, TREE_ASSERT(NodeArenaDtor(&tree.arena)));
+
+    err = SimplifyTree(&tree);
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err, TREE_ASSERT(NodeArenaDtor(&tree.arena)));
+
+    err = TextPrintNode(text, tree.root);
+    if (err.err == TreeErrorType::NO_ERR) err = TextPrint(text, "\n");
+    if (err.err != TreeErrorType::NO_ERR) text->size = textSize;
+
+    TREE_ASSERT(TreeDtor(&tree));
+
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+#define _PRINT(func) do { err = func; RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err); } while (0)
+
+static TreeErr TextPrintNode(BatchText_t* text, const Node_t* node)
+{
+    assert(text);
+    assert(node);
+
+    TreeErr err = {};
+
+    switch (node->type)
+    {
+        case NodeArgType::number:   return TextPrintNumber(text, node->data.num);
+        case NodeArgType::variable: return TextPrint(text, GetNodeName(node));
+        case NodeArgType::function:
+        {
+            _PRINT(TextPrint    (text, GetNodeName(node)));
+            _PRINT(TextPrint    (text, "("));
+            _PRINT(TextPrintNode(text, node->left));
+            return TextPrint(text, ")");
+        }
+        case NodeArgType::operation:
+        {
+            _PRINT(TextPrint(text, "("));
+
+            if (!node->right)
+            {
+                _PRINT(TextPrint    (text, "-"));
+                _PRINT(TextPrintNode(text, node->left));
+                return TextPrint(text, ")");
+            }
+
+            _PRINT(TextPrintNode(text, node->left));
+            _PRINT(TextPrint    (text, GetNodeName(node)));
+            _PRINT(TextPrintNode(text, node->right));
+            return TextPrint(text, ")");
+        }
+        case NodeArgType::undefined:
+        default: assert(0 && "undefined node type in batch print.\n"); break;
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+#undef _PRINT
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// error line takes place of derivative, so lines of output still match lines of input
+static TreeErr TextPrintError(BatchText_t* text, size_t offset, const char* msg)
+{
+    assert(text);
+    assert(msg);
+
+    char str[128] = {};
+
+    snprintf(str, sizeof(str), "error: offset %lu: %s\n", offset, msg);
+
+    return TextPrint(text, str);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr TextPrintNumber(BatchText_t* text, Number num)
+{
+    assert(text);
+
+    char str[32] = {};
+
+    if (num < 0) snprintf(str, sizeof(str), "(%.17g)", num);
+    else         snprintf(str, sizeof(str), "%.17g",   num);
+
+    return TextPrint(text, str);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr TextPrint(BatchText_t* text, const char* str)
+{
+    assert(text);
+    assert(str);
+
+    TreeErr err = {};
+
+    size_t size = strlen(str);
+
+    if (text->size + size > text->capacity)
+    {
+        size_t capacity = (text->capacity > 0) ? 2 * text->capacity : 256;
+        while (capacity < text->size + size) capacity *= 2;
+
+        char* data = (char*) realloc(text->data, capacity);
+        RETURN_IF_FALSE(data, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+        text->data     = data;
+        text->capacity = capacity;
+    }
+
+    memcpy(text->data + text->size, str, size);
+    text->size += size;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static const char* GetNodeName(const Node_t* node)
+{
+    assert(node);
+
+    switch (node->type)
+    {
+        case NodeArgType::variable:
+        {
+            for (size_t i = 0; i < DefaultVariablesQuant; i++)
+            {
+                RETURN_IF_TRUE(node->data.var == DefaultVariables[i].value, DefaultVariables[i].name);
+            }
+            break;
+        }
+        case NodeArgType::function:
+        {
+            for (size_t i = 0; i < DefaultFunctionsQuant; i++)
+            {
+                RETURN_IF_TRUE(node->data.func == DefaultFunctions[i].value, DefaultFunctions[i].name);
+            }
+            break;
+        }
+        case NodeArgType::operation:
+        {
+            for (size_t i = 0; i < DefaultOperationsQuant; i++)
+            {
+                RETURN_IF_TRUE(node->data.oper == DefaultOperations[i].value, DefaultOperations[i].name);
+            }
+            break;
+        }
+        case NodeArgType::number:
+        case NodeArgType::undefined:
+        default: break;
+    }
+
+    assert(0 && "node has no name.\n");
+    return "?";
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static size_t GetOnlineCores()
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return (cores > 0) ? (size_t) cores : 1;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
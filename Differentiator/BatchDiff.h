@@ -0,0 +1,26 @@
+#ifndef BATCH_DIFF_H
+#define BATCH_DIFF_H
+
+#include <stdio.h>
+#include "../Tree/Tree.h"
+#include "../Tree/BulkInput.h"
+#include "../Tree/ReadTree.h"
+
+struct BatchDiffStats_t
+{
+    size_t expressions;
+    size_t errors;          // failed expressions, they have error lines in output
+    size_t threads;
+    double seconds;
+    double expressionsPerSecond;
+};
+
+// every expression of bulk is parsed, differentiated, simplified and printed to out, one line per expression.
+// workers take chunks of expressions and own their trees (so their arenas); lines are written in input order.
+// failed expression gets line "error: offset <from start of file>: <reason>" instead of derivative, the rest go on.
+// offset points to syntax error or, for errors of Diff and SimplifyTree, to start of expression
+// worker stack is BatchStackSize (256 MiB): expressions are nested up to about 100000 levels, like x+x+...+x of 100000 terms.
+// threads = 0 means one worker per online core, stats can be nullptr
+TreeErr BatchDiff(BulkInput_t* bulk, FILE* out, size_t threads, BatchDiffStats_t* stats);
+
+#endif
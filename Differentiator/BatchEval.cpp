@@ -0,0 +1,833 @@
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+#include "BatchEval.h"
+#include "Bytecode.h"
+#include "MathFunctions.h"
+#include "../Common/GlobalInclude.h"
+
+
+static void   BatchRunBlock         (const Bytecode_t* bytecode, Number** columns, const bool* isConst, size_t n);
+static void   BatchArithmetic       (BytecodeOp op, const Number* left, const Number* right, Number* dest, size_t n);
+static void   BatchArithmeticScalar (BytecodeOp op, const Number* left, const Number* right, Number* dest, size_t n);
+static void   BatchPow              (const Number* left, const Number* right, Number* dest, size_t n);
+static void   BatchFunction         (BytecodeOp op, const Number* arg, Number* dest, size_t n);
+static void   BatchFunctionScalar   (BytecodeOp op, const Number* arg, Number* dest, size_t n);
+
+#if defined(__x86_64__)
+static void   BatchArithmeticAvx    (BytecodeOp op, const Number* left, const Number* right, Number* dest, size_t n);
+static void   BatchArithmeticSse    (BytecodeOp op, const Number* left, const Number* right, Number* dest, size_t n);
+static void   BatchPowAvx           (const Number* left, const Number* right, Number* dest, size_t n);
+static void   BatchFunctionAvx      (BytecodeOp op, const Number* arg, Number* dest, size_t n);
+static bool   IsAvx2Supported       ();
+
+__attribute__((target("avx2"))) static __m256d PolyAvx   (__m256d x, const double* coeffs, size_t size);
+__attribute__((target("avx2"))) static __m256d Poly1Avx  (__m256d x, const double* coeffs, size_t size);
+__attribute__((target("avx2"))) static __m256d AbsAvx    (__m256d x);
+__attribute__((target("avx2"))) static __m256d Pow2Avx   (__m256d n);
+__attribute__((target("avx2"))) static __m256d ExpAvx    (__m256d x);
+__attribute__((target("avx2"))) static __m256d LogAvx    (__m256d x);
+__attribute__((target("avx2"))) static void    SinCosAvx (__m256d x, __m256d* sin, __m256d* cos);
+__attribute__((target("avx2"))) static __m256d AtanAvx   (__m256d x);
+__attribute__((target("avx2"))) static __m256d HalfExpAvx(__m256d x);
+__attribute__((target("avx2"))) static __m256d SinhAvx   (__m256d x);
+__attribute__((target("avx2"))) static __m256d TanhAvx   (__m256d x);
+#endif
+
+// registers are columns of BatchBlockSize values: one instruction is executed for whole block
+static const size_t BatchBlockSize = 256;
+
+static const uint32_t XRegister = 0;
+static const uint32_t YRegister = 1;
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr BatchEval(const Bytecode_t* bytecode, const Number* x, const Number* y, Number* out, size_t count, BatchStats_t* stats)
+{
+    assert(bytecode);
+    assert(bytecode->registers);
+    assert(x);
+    assert(out);
+
+    TreeErr err = {};
+
+    double start = GetWallTime();
+
+    size_t regQuant = bytecode->registerQuant;
+
+    Number*  block   = (Number*)  calloc(regQuant * BatchBlockSize, sizeof(Number));
+    Number** columns = (Number**) calloc(regQuant, sizeof(Number*));
+    bool*    isConst = (bool*)    calloc(regQuant, sizeof(bool));
+
+    if (!block || !columns || !isConst)
+    {
+        FREE(block);
+        FREE(columns);
+        FREE(isConst);
+        err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    // register, that no instruction writes, is constant: its column is filled once
+    for (size_t r = 0; r < regQuant; r++) isConst[r] = true;
+    for (size_t i = 0; i < bytecode->size; i++) isConst[bytecode->code[i].dest] = false;
+
+    isConst[XRegister] = false;
+    isConst[YRegister] = false;
+
+    for (size_t r = 0; r < regQuant; r++)
+    {
+        columns[r] = block + r * BatchBlockSize;
+        if (!isConst[r]) continue;
+
+        for (size_t lane = 0; lane < BatchBlockSize; lane++) columns[r][lane] = bytecode->registers[r];
+    }
+
+    for (size_t begin = 0; begin < count; begin += BatchBlockSize)
+    {
+        size_t n = (count - begin < BatchBlockSize) ? count - begin : BatchBlockSize;
+
+        memcpy(columns[XRegister], x + begin, n * sizeof(Number));
+        if (y) memcpy(columns[YRegister], y + begin, n * sizeof(Number));
+
+        BatchRunBlock(bytecode, columns, isConst, n);
+
+        memcpy(out + begin, columns[bytecode->result], n * sizeof(Number));
+    }
+
+    FREE(block);
+    FREE(columns);
+    FREE(isConst);
+
+    if (stats)
+    {
+        stats->points          = count;
+        stats->seconds         = GetWallTime() - start;
+        stats->pointsPerSecond = (stats->seconds > 0) ? (double) count / stats->seconds : 0;
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static void BatchRunBlock(const Bytecode_t* bytecode, Number** columns, const bool* isConst, size_t n)
+{
+    assert(bytecode);
+    assert(columns);
+    assert(isConst);
+
+    for (size_t i = 0; i < bytecode->size; i++)
+    {
+        const Instruction_t* instruction = &bytecode->code[i];
+
+        const Number* left  = columns[instruction->left];
+        const Number* right = columns[instruction->right];
+        Number*       dest  = columns[instruction->dest];
+
+        switch (instruction->op)
+        {
+            case BytecodeOp::op_add:
+            case BytecodeOp::op_sub:
+            case BytecodeOp::op_mul:
+            case BytecodeOp::op_div:
+            case BytecodeOp::op_neg:
+            case BytecodeOp::op_sqrt:
+            {
+                BatchArithmetic(instruction->op, left, right, dest, n);
+                break;
+            }
+
+            case BytecodeOp::op_pow:
+            {
+                // square is the most common power in derivatives
+                if (isConst[instruction->right] && IsDoubleEqual(right[0], 2, 1e-50))
+                {
+                    BatchArithmetic(BytecodeOp::op_mul, left, left, dest, n);
+                    break;
+                }
+
+                BatchPow(left, right, dest, n);
+                break;
+            }
+
+            case BytecodeOp::op_ln:
+            case BytecodeOp::op_sin:
+            case BytecodeOp::op_cos:
+            case BytecodeOp::op_tg:
+            case BytecodeOp::op_ctg:
+            case BytecodeOp::op_sh:
+            case BytecodeOp::op_ch:
+            case BytecodeOp::op_th:
+            case BytecodeOp::op_cth:
+            case BytecodeOp::op_arcsin:
+            case BytecodeOp::op_arccos:
+            case BytecodeOp::op_arctg:
+            case BytecodeOp::op_arcctg:
+            {
+                BatchFunction(instruction->op, left, dest, n);
+                break;
+            }
+
+            default: assert(0 && "undefined bytecode op.\n"); break;
+        }
+    }
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static void BatchArithmetic(BytecodeOp op, const Number* left, const Number* right, Number* dest, size_t n)
+{
+#if defined(__x86_64__)
+    if (IsAvx2Supported()) BatchArithmeticAvx   (op, left, right, dest, n);
+    else                   BatchArithmeticSse   (op, left, right, dest, n);
+#else
+                           BatchArithmeticScalar(op, left, right, dest, n);
+#endif
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static void BatchArithmeticScalar(BytecodeOp op, const Number* left, const Number* right, Number* dest, size_t n)
+{
+    assert(left);
+    assert(right);
+    assert(dest);
+
+    for (size_t lane = 0; lane < n; lane++)
+    {
+        switch (op)
+        {
+            case BytecodeOp::op_add:  dest[lane] = left[lane] + right[lane]; break;
+            case BytecodeOp::op_sub:  dest[lane] = left[lane] - right[lane]; break;
+            case BytecodeOp::op_mul:  dest[lane] = left[lane] * right[lane]; break;
+            case BytecodeOp::op_div:  dest[lane] = left[lane] / right[lane]; break;
+            case BytecodeOp::op_neg:  dest[lane] = -left[lane];              break;
+            case BytecodeOp::op_sqrt: dest[lane] = sqrt(left[lane]);         break;
+            case BytecodeOp::op_pow:
+            case BytecodeOp::op_ln:
+            case BytecodeOp::op_sin:
+            case BytecodeOp::op_cos:
+            case BytecodeOp::op_tg:
+            case BytecodeOp::op_ctg:
+            case BytecodeOp::op_sh:
+            case BytecodeOp::op_ch:
+            case BytecodeOp::op_th:
+            case BytecodeOp::op_cth:
+            case BytecodeOp::op_arcsin:
+            case BytecodeOp::op_arccos:
+            case BytecodeOp::op_arctg:
+            case BytecodeOp::op_arcctg:
+            default: assert(0 && "not arithmetic op in kernel.\n"); break;
+        }
+    }
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static void BatchPow(const Number* left, const Number* right, Number* dest, size_t n)
+{
+    assert(left);
+    assert(right);
+    assert(dest);
+
+#if defined(__x86_64__)
+    if (IsAvx2Supported())
+    {
+        BatchPowAvx(left, right, dest, n);
+        return;
+    }
+#endif
+
+    for (size_t lane = 0; lane < n; lane++) dest[lane] = pow(left[lane], right[lane]);
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static void BatchFunction(BytecodeOp op, const Number* arg, Number* dest, size_t n)
+{
+    assert(arg);
+    assert(dest);
+
+#if defined(__x86_64__)
+    if (IsAvx2Supported())
+    {
+        BatchFunctionAvx(op, arg, dest, n);
+        return;
+    }
+#endif
+
+    BatchFunctionScalar(op, arg, dest, n);
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// function is chosen once for block, then it is called in tight loop over lanes
+static void BatchFunctionScalar(BytecodeOp op, const Number* arg, Number* dest, size_t n)
+{
+    assert(arg);
+    assert(dest);
+
+    double (*function)(double) = GetBytecodeFunction(op);
+
+    for (size_t lane = 0; lane < n; lane++) dest[lane] = function(arg[lane]);
+
+    return;
+}
+
+//============================== x86-64 kernels ========================================================================================
+
+#if defined(__x86_64__)
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// 4 lanes in step, tail is done by sse kernel
+__attribute__((target("avx2")))
+static void BatchArithmeticAvx(BytecodeOp op, const Number* left, const Number* right, Number* dest, size_t n)
+{
+    assert(left);
+    assert(right);
+    assert(dest);
+
+    static const size_t Lanes = 4;
+
+    size_t lane = 0;
+
+    for (; lane + Lanes <= n; lane += Lanes)
+    {
+        __m256d a = _mm256_loadu_pd(left  + lane);
+        __m256d b = _mm256_loadu_pd(right + lane);
+        __m256d c = a;
+
+        switch (op)
+        {
+            case BytecodeOp::op_add:  c = _mm256_add_pd(a, b);                   break;
+            case BytecodeOp::op_sub:  c = _mm256_sub_pd(a, b);                   break;
+            case BytecodeOp::op_mul:  c = _mm256_mul_pd(a, b);                   break;
+            case BytecodeOp::op_div:  c = _mm256_div_pd(a, b);                   break;
+            case BytecodeOp::op_neg:  c = _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); break;
+            case BytecodeOp::op_sqrt: c = _mm256_sqrt_pd(a);                     break;
+            case BytecodeOp::op_pow:
+            case BytecodeOp::op_ln:
+            case BytecodeOp::op_sin:
+            case BytecodeOp::op_cos:
+            case BytecodeOp::op_tg:
+            case BytecodeOp::op_ctg:
+            case BytecodeOp::op_sh:
+            case BytecodeOp::op_ch:
+            case BytecodeOp::op_th:
+            case BytecodeOp::op_cth:
+            case BytecodeOp::op_arcsin:
+            case BytecodeOp::op_arccos:
+            case BytecodeOp::op_arctg:
+            case BytecodeOp::op_arcctg:
+            default: assert(0 && "not arithmetic op in kernel.\n"); break;
+        }
+
+        _mm256_storeu_pd(dest + lane, c);
+    }
+
+    BatchArithmeticSse(op, left + lane, right + lane, dest + lane, n - lane);
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// sse2 is in every x86-64 cpu; 2 lanes in step, last odd lane is scalar
+static void BatchArithmeticSse(BytecodeOp op, const Number* left, const Number* right, Number* dest, size_t n)
+{
+    assert(left);
+    assert(right);
+    assert(dest);
+
+    static const size_t Lanes = 2;
+
+    size_t lane = 0;
+
+    for (; lane + Lanes <= n; lane += Lanes)
+    {
+        __m128d a = _mm_loadu_pd(left  + lane);
+        __m128d b = _mm_loadu_pd(right + lane);
+        __m128d c = a;
+
+        switch (op)
+        {
+            case BytecodeOp::op_add:  c = _mm_add_pd(a, b);                 break;
+            case BytecodeOp::op_sub:  c = _mm_sub_pd(a, b);                 break;
+            case BytecodeOp::op_mul:  c = _mm_mul_pd(a, b);                 break;
+            case BytecodeOp::op_div:  c = _mm_div_pd(a, b);                 break;
+            case BytecodeOp::op_neg:  c = _mm_xor_pd(a, _mm_set1_pd(-0.0)); break;
+            case BytecodeOp::op_sqrt: c = _mm_sqrt_pd(a);                   break;
+            case BytecodeOp::op_pow:
+            case BytecodeOp::op_ln:
+            case BytecodeOp::op_sin:
+            case BytecodeOp::op_cos:
+            case BytecodeOp::op_tg:
+            case BytecodeOp::op_ctg:
+            case BytecodeOp::op_sh:
+            case BytecodeOp::op_ch:
+            case BytecodeOp::op_th:
+            case BytecodeOp::op_cth:
+            case BytecodeOp::op_arcsin:
+            case BytecodeOp::op_arccos:
+            case BytecodeOp::op_arctg:
+            case BytecodeOp::op_arcctg:
+            default: assert(0 && "not arithmetic op in kernel.\n"); break;
+        }
+
+        _mm_storeu_pd(dest + lane, c);
+    }
+
+    BatchArithmeticScalar(op, left + lane, right + lane, dest + lane, n - lane);
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// exp, log, sin, cos and atan of 4 lanes are cephes algorithms: range reduction and polynomial or rational approximation,
+// error is few ulp. Other functions are built from them, arguments, that kernels don't cover, go to libm
+static const double HalfPi        = 1.57079632679489661923;
+static const double QuarterPi     = 0.78539816339744830962;
+static const double ExactPi       = 3.14159265358979323846;
+static const double PiMoreBits    = 6.123233995736765886130e-17;
+
+static const double ExpMaxArg     = 709.78271289338399;
+static const double ExpMinArg     = -745.13321910194110842;
+static const double Log2e         = 1.4426950408889634073599;
+static const double ExpC1         = 6.93145751953125e-1;
+static const double ExpC2         = 1.42860682030941723212e-6;
+static const double ExpP[]        = {1.26177193074810590878e-4, 3.02994407707441961300e-2, 9.99999999999999999910e-1};
+static const double ExpQ[]        = {3.00198505138664455042e-6, 2.52448340349684104192e-3, 2.27265548208155028766e-1, 2.00000000000000000009e0};
+
+static const double LogSqrtHalf   = 0.70710678118654752440;
+static const double LogC1         = 0.693359375;
+static const double LogC2         = -2.121944400546905827679e-4;
+static const double LogP[]        = {1.01875663804580931796e-4, 4.97494994976747001425e-1, 4.70579119878881725854e0,
+                                     1.44989225341610930846e1,  1.79368678507819816313e1,  7.70838733755885391666e0};
+static const double LogQ[]        = {1.12873587189167450590e1,  4.52279145837532221105e1,  8.29875266912776603211e1,
+                                     7.11544750618563894466e1,  2.31251620126765340583e1};
+
+// |x| > SinCosMaxArg loses precision in reduction by pi/4, such lanes are computed by libm
+static const double SinCosMaxArg  = 1.073741824e9;
+static const double FourOverPi    = 1.27323954473516268615;
+static const double SinCosDP1     = 7.85398125648498535156e-1;
+static const double SinCosDP2     = 3.77489470793079817668e-8;
+static const double SinCosDP3     = 2.69515142907905952645e-15;
+static const double SinCoeffs[]   = {1.58962301576546568060e-10, -2.50507477628578072866e-8, 2.75573136213857245213e-6,
+                                     -1.98412698295895385996e-4, 8.33333333332211858878e-3,  -1.66666666666666307295e-1};
+static const double CosCoeffs[]   = {-1.13585365213876817300e-11, 2.08757008419747316778e-9, -2.75573141792967388112e-7,
+                                     2.48015872888517045348e-5,   -1.38888888888730564116e-3, 4.16666666666665929218e-2};
+
+static const double AtanTan3Pi8   = 2.41421356237309504880;
+static const double AtanP[]       = {-8.750608600031904122785e-1, -1.615753718733365076637e1, -7.500855792314704667340e1,
+                                     -1.228866684490136173410e2,  -6.485021904942025371773e1};
+static const double AtanQ[]       = {2.485846490142306297962e1,   1.650270098316988542046e2,  4.328810604912902668951e2,
+                                     4.853903996359136964868e2,   1.945506571482613964425e2};
+
+// sh(x) = x + x^3/3! + ... + x^17/17! for |x| < 1, there (e^x - e^-x) / 2 loses digits
+static const double SinhCoeffs[]  = {1.0 / 355687428096000, 1.0 / 1307674368000, 1.0 / 6227020800, 1.0 / 39916800,
+                                     1.0 / 362880,          1.0 / 5040,          1.0 / 120,        1.0 / 6,         1.0};
+
+#define SIZE(array) (sizeof(array) / sizeof(array[0]))
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// 4 lanes in step, tail is done by scalar kernel
+__attribute__((target("avx2")))
+static void BatchFunctionAvx(BytecodeOp op, const Number* arg, Number* dest, size_t n)
+{
+    assert(arg);
+    assert(dest);
+
+    static const size_t Lanes = 4;
+
+    const __m256d one     = _mm256_set1_pd(1);
+    const __m256d two     = _mm256_set1_pd(2);
+    const __m256d zero   = _mm256_setzero_pd();
+    const __m256d quarter = _mm256_set1_pd(0.25);
+
+    bool isTrig = (op == BytecodeOp::op_sin || op == BytecodeOp::op_cos || op == BytecodeOp::op_tg || op == BytecodeOp::op_ctg);
+
+    size_t lane = 0;
+
+    for (; lane + Lanes <= n; lane += Lanes)
+    {
+        __m256d x = _mm256_loadu_pd(arg + lane);
+        __m256d y = x;
+        __m256d s = x;
+        __m256d c = x;
+
+        if (isTrig)
+        {
+            __m256d isFar = _mm256_cmp_pd(AbsAvx(x), _mm256_set1_pd(SinCosMaxArg), _CMP_NLE_UQ);
+
+            if (_mm256_movemask_pd(isFar))
+            {
+                BatchFunctionScalar(op, arg + lane, dest + lane, Lanes);
+                continue;
+            }
+
+            SinCosAvx(x, &s, &c);
+        }
+
+        switch (op)
+        {
+            case BytecodeOp::op_ln:     y = LogAvx(x);                                                                   break;
+            case BytecodeOp::op_sin:    y = s;                                                                           break;
+            case BytecodeOp::op_cos:    y = c;                                                                           break;
+            case BytecodeOp::op_tg:     y = _mm256_div_pd(s, c);                                                         break;
+            case BytecodeOp::op_ctg:    y = _mm256_div_pd(c, s);                                                         break;
+            case BytecodeOp::op_sh:     y = SinhAvx(x);                                                                  break;
+            case BytecodeOp::op_ch:
+            {
+                __m256d e = HalfExpAvx(AbsAvx(x));
+                y = _mm256_add_pd(e, _mm256_div_pd(quarter, e));
+                break;
+            }
+            case BytecodeOp::op_th:     y = TanhAvx(x);                                                                  break;
+            case BytecodeOp::op_cth:    y = _mm256_div_pd(one, TanhAvx(x));                                              break;
+            // arcsin(x) = arctg(x / sqrt(1 - x^2)), arccos(x) = 2 arctg(sqrt((1 - x) / (1 + x))): no loss near |x| = 1
+            case BytecodeOp::op_arcsin:
+            {
+                __m256d root = _mm256_sqrt_pd(_mm256_mul_pd(_mm256_sub_pd(one, x), _mm256_add_pd(one, x)));
+                y = AtanAvx(_mm256_div_pd(x, root));
+                break;
+            }
+            case BytecodeOp::op_arccos:
+            {
+                __m256d root = _mm256_sqrt_pd(_mm256_div_pd(_mm256_sub_pd(one, x), _mm256_add_pd(one, x)));
+                y = _mm256_mul_pd(two, AtanAvx(root));
+                break;
+            }
+            case BytecodeOp::op_arctg:  y = AtanAvx(x);                                                                  break;
+            // arcctg x = arctg(1 / x), plus pi for x < 0: pi/2 - arctg x loses digits for big x
+            case BytecodeOp::op_arcctg:
+            {
+                __m256d isNeg = _mm256_cmp_pd(x, zero, _CMP_LT_OQ);
+                y = _mm256_add_pd(AtanAvx(_mm256_div_pd(one, x)), _mm256_and_pd(isNeg, _mm256_set1_pd(ExactPi)));
+                break;
+            }
+            case BytecodeOp::op_add:
+            case BytecodeOp::op_sub:
+            case BytecodeOp::op_mul:
+            case BytecodeOp::op_div:
+            case BytecodeOp::op_pow:
+            case BytecodeOp::op_neg:
+            case BytecodeOp::op_sqrt:
+            default: assert(0 && "not function op in kernel.\n"); break;
+        }
+
+        _mm256_storeu_pd(dest + lane, y);
+    }
+
+    BatchFunctionScalar(op, arg + lane, dest + lane, n - lane);
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// a^b = e^(b ln a) for finite a > 0 and finite b, error grows with |b ln a|. Other lanes (and a <= 0) go to libm pow
+__attribute__((target("avx2")))
+static void BatchPowAvx(const Number* left, const Number* right, Number* dest, size_t n)
+{
+    assert(left);
+    assert(right);
+    assert(dest);
+
+    static const size_t Lanes = 4;
+
+    const __m256d zero   = _mm256_setzero_pd();
+    const __m256d maxNum = _mm256_set1_pd(DBL_MAX);
+
+    size_t lane = 0;
+
+    for (; lane + Lanes <= n; lane += Lanes)
+    {
+        __m256d a = _mm256_loadu_pd(left  + lane);
+        __m256d b = _mm256_loadu_pd(right + lane);
+
+        __m256d isGood = _mm256_and_pd(_mm256_cmp_pd(a, zero, _CMP_GT_OQ), _mm256_cmp_pd(a, maxNum, _CMP_LE_OQ));
+        isGood         = _mm256_and_pd(isGood, _mm256_cmp_pd(AbsAvx(b), maxNum, _CMP_LE_OQ));
+
+        if (_mm256_movemask_pd(isGood) != 0xF)
+        {
+            for (size_t i = lane; i < lane + Lanes; i++) dest[i] = pow(left[i], right[i]);
+            continue;
+        }
+
+        _mm256_storeu_pd(dest + lane, ExpAvx(_mm256_mul_pd(b, LogAvx(a))));
+    }
+
+    for (; lane < n; lane++) dest[lane] = pow(left[lane], right[lane]);
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+static __m256d PolyAvx(__m256d x, const double* coeffs, size_t size)
+{
+    __m256d y = _mm256_set1_pd(coeffs[0]);
+
+    for (size_t i = 1; i < size; i++) y = _mm256_add_pd(_mm256_mul_pd(y, x), _mm256_set1_pd(coeffs[i]));
+
+    return y;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// polynomial with leading coefficient 1, that is not stored
+__attribute__((target("avx2")))
+static __m256d Poly1Avx(__m256d x, const double* coeffs, size_t size)
+{
+    __m256d y = _mm256_add_pd(x, _mm256_set1_pd(coeffs[0]));
+
+    for (size_t i = 1; i < size; i++) y = _mm256_add_pd(_mm256_mul_pd(y, x), _mm256_set1_pd(coeffs[i]));
+
+    return y;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+static __m256d AbsAvx(__m256d x)
+{
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// 2^n for whole n from -1022 to 1023: n is put to exponent bits
+__attribute__((target("avx2")))
+static __m256d Pow2Avx(__m256d n)
+{
+    // n + 1.5 * 2^52 has n in low bits of mantissa
+    const __m256d magic = _mm256_set1_pd(6755399441055744.0);
+
+    __m256i bits = _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(n, magic)), _mm256_castpd_si256(magic));
+    bits         = _mm256_slli_epi64(_mm256_add_epi64(bits, _mm256_set1_epi64x(1023)), 52);
+
+    return _mm256_castsi256_pd(bits);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// e^x = 2^n e^r, |r| <= ln2 / 2
+__attribute__((target("avx2")))
+static __m256d ExpAvx(__m256d x)
+{
+    const __m256d maxArg = _mm256_set1_pd(ExpMaxArg);
+    const __m256d minArg = _mm256_set1_pd(ExpMinArg);
+    const __m256d one    = _mm256_set1_pd(1);
+
+    // nan stays nan: min and max give second operand, if one of them is nan
+    __m256d arg = _mm256_max_pd(minArg, _mm256_min_pd(maxArg, x));
+
+    __m256d n = _mm256_round_pd(_mm256_mul_pd(arg, _mm256_set1_pd(Log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_sub_pd(arg, _mm256_mul_pd(n, _mm256_set1_pd(ExpC1)));
+    r         = _mm256_sub_pd(r,   _mm256_mul_pd(n, _mm256_set1_pd(ExpC2)));
+
+    __m256d rr = _mm256_mul_pd(r, r);
+    __m256d p  = _mm256_mul_pd(r, PolyAvx(rr, ExpP, SIZE(ExpP)));
+    __m256d q  = PolyAvx(rr, ExpQ, SIZE(ExpQ));
+    __m256d y  = _mm256_add_pd(one, _mm256_mul_pd(_mm256_set1_pd(2), _mm256_div_pd(p, _mm256_sub_pd(q, p))));
+
+    // n goes from -1075 (subnormal result) to 1024, so 2^n is built from two halves
+    __m256d n1 = _mm256_floor_pd(_mm256_mul_pd(n, _mm256_set1_pd(0.5)));
+    __m256d n2 = _mm256_sub_pd(n, n1);
+    y = _mm256_mul_pd(_mm256_mul_pd(y, Pow2Avx(n1)), Pow2Avx(n2));
+
+    y = _mm256_blendv_pd(y, _mm256_set1_pd(INFINITY), _mm256_cmp_pd(x, maxArg, _CMP_GT_OQ));
+    y = _mm256_blendv_pd(y, _mm256_setzero_pd(),      _mm256_cmp_pd(x, minArg, _CMP_LT_OQ));
+
+    return y;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// ln x = e ln2 + ln m, m from sqrt(1/2) to sqrt(2)
+__attribute__((target("avx2")))
+static __m256d LogAvx(__m256d x)
+{
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one  = _mm256_set1_pd(1);
+    const __m256d half = _mm256_set1_pd(0.5);
+
+    // subnormal x is scaled by 2^52 to have normal exponent
+    __m256d isSubnormal = _mm256_and_pd(_mm256_cmp_pd(x, zero, _CMP_GT_OQ), _mm256_cmp_pd(x, _mm256_set1_pd(DBL_MIN), _CMP_LT_OQ));
+    __m256d arg         = _mm256_blendv_pd(x, _mm256_mul_pd(x, _mm256_set1_pd(4503599627370496.0)), isSubnormal);
+    __m256d shift       = _mm256_blendv_pd(zero, _mm256_set1_pd(52), isSubnormal);
+
+    __m256i bits     = _mm256_castpd_si256(arg);
+    __m256i twoTo52  = _mm256_castpd_si256(_mm256_set1_pd(4503599627370496.0));
+    __m256i expBits  = _mm256_srli_epi64(bits, 52);
+    __m256d e        = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(expBits, twoTo52)), _mm256_set1_pd(4503599627370496.0));
+    e                = _mm256_sub_pd(e, _mm256_add_pd(_mm256_set1_pd(1022), shift));
+
+    __m256i mantissa = _mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFF));
+    __m256d m        = _mm256_castsi256_pd(_mm256_or_si256(mantissa, _mm256_castpd_si256(half)));
+
+    __m256d isSmall = _mm256_cmp_pd(m, _mm256_set1_pd(LogSqrtHalf), _CMP_LT_OQ);
+    e               = _mm256_sub_pd(e, _mm256_and_pd(isSmall, one));
+    __m256d t       = _mm256_sub_pd(_mm256_blendv_pd(m, _mm256_add_pd(m, m), isSmall), one);
+
+    __m256d z = _mm256_mul_pd(t, t);
+    __m256d y = _mm256_mul_pd(_mm256_mul_pd(t, z), _mm256_div_pd(PolyAvx(t, LogP, SIZE(LogP)), Poly1Avx(t, LogQ, SIZE(LogQ))));
+    y         = _mm256_add_pd(y, _mm256_mul_pd(e, _mm256_set1_pd(LogC2)));
+    y         = _mm256_sub_pd(y, _mm256_mul_pd(half, z));
+    y         = _mm256_add_pd(_mm256_add_pd(t, y), _mm256_mul_pd(e, _mm256_set1_pd(LogC1)));
+
+    y = _mm256_blendv_pd(y, _mm256_set1_pd(-INFINITY), _mm256_cmp_pd(x, zero, _CMP_EQ_OQ));
+    y = _mm256_blendv_pd(y, _mm256_set1_pd(NAN),       _mm256_cmp_pd(x, zero, _CMP_LT_OQ));
+    y = _mm256_blendv_pd(y, x,                         _mm256_cmp_pd(x, _mm256_set1_pd(DBL_MAX), _CMP_NLE_UQ));
+
+    return y;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// x is reduced to z from -pi/4 to pi/4 by j pi/4, even j chooses polynomial (sin or cos of z) and signs
+__attribute__((target("avx2")))
+static void SinCosAvx(__m256d x, __m256d* sin, __m256d* cos)
+{
+    assert(sin);
+    assert(cos);
+
+    const __m256d one      = _mm256_set1_pd(1);
+    const __m256d negZero  = _mm256_set1_pd(-0.0);
+
+    __m256d ax = AbsAvx(x);
+    __m256d j  = _mm256_floor_pd(_mm256_mul_pd(ax, _mm256_set1_pd(FourOverPi)));
+    j          = _mm256_add_pd(j, _mm256_sub_pd(j, _mm256_mul_pd(_mm256_set1_pd(2), _mm256_floor_pd(_mm256_mul_pd(j, _mm256_set1_pd(0.5))))));
+
+    __m256d z = _mm256_sub_pd(ax, _mm256_mul_pd(j, _mm256_set1_pd(SinCosDP1)));
+    z         = _mm256_sub_pd(z,  _mm256_mul_pd(j, _mm256_set1_pd(SinCosDP2)));
+    z         = _mm256_sub_pd(z,  _mm256_mul_pd(j, _mm256_set1_pd(SinCosDP3)));
+
+    __m256d octant = _mm256_sub_pd(j, _mm256_mul_pd(_mm256_set1_pd(8), _mm256_floor_pd(_mm256_mul_pd(j, _mm256_set1_pd(0.125)))));
+    __m256d isFlip = _mm256_cmp_pd(octant, _mm256_set1_pd(4), _CMP_GE_OQ);
+    octant         = _mm256_sub_pd(octant, _mm256_and_pd(isFlip, _mm256_set1_pd(4)));
+    __m256d isSwap = _mm256_cmp_pd(octant, _mm256_set1_pd(2), _CMP_EQ_OQ);
+
+    __m256d zz      = _mm256_mul_pd(z, z);
+    __m256d sinPoly = _mm256_add_pd(z, _mm256_mul_pd(_mm256_mul_pd(z, zz), PolyAvx(zz, SinCoeffs, SIZE(SinCoeffs))));
+    __m256d cosPoly = _mm256_sub_pd(one, _mm256_mul_pd(_mm256_set1_pd(0.5), zz));
+    cosPoly         = _mm256_add_pd(cosPoly, _mm256_mul_pd(_mm256_mul_pd(zz, zz), PolyAvx(zz, CosCoeffs, SIZE(CosCoeffs))));
+
+    __m256d sinSign = _mm256_xor_pd(_mm256_and_pd(isFlip, negZero), _mm256_and_pd(x, negZero));
+    __m256d cosSign = _mm256_xor_pd(_mm256_and_pd(isFlip, negZero), _mm256_and_pd(isSwap, negZero));
+
+    *sin = _mm256_xor_pd(_mm256_blendv_pd(sinPoly, cosPoly, isSwap), sinSign);
+    *cos = _mm256_xor_pd(_mm256_blendv_pd(cosPoly, sinPoly, isSwap), cosSign);
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// |x| is reduced to t from 0 to 0.66 by arctg x = pi/4 + arctg((x - 1) / (x + 1)) or pi/2 - arctg(1 / x)
+__attribute__((target("avx2")))
+static __m256d AtanAvx(__m256d x)
+{
+    const __m256d one = _mm256_set1_pd(1);
+
+    __m256d ax    = AbsAvx(x);
+    __m256d isBig = _mm256_cmp_pd(ax, _mm256_set1_pd(AtanTan3Pi8), _CMP_GT_OQ);
+    __m256d isMid = _mm256_andnot_pd(isBig, _mm256_cmp_pd(ax, _mm256_set1_pd(0.66), _CMP_GT_OQ));
+
+    __m256d t    = _mm256_blendv_pd(ax, _mm256_div_pd(_mm256_sub_pd(ax, one), _mm256_add_pd(ax, one)), isMid);
+    t            = _mm256_blendv_pd(t,  _mm256_div_pd(_mm256_set1_pd(-1), ax),                         isBig);
+    __m256d base = _mm256_blendv_pd(_mm256_setzero_pd(), _mm256_set1_pd(QuarterPi), isMid);
+    base         = _mm256_blendv_pd(base, _mm256_set1_pd(HalfPi), isBig);
+    __m256d more = _mm256_blendv_pd(_mm256_setzero_pd(), _mm256_set1_pd(0.5 * PiMoreBits), isMid);
+    more         = _mm256_blendv_pd(more, _mm256_set1_pd(PiMoreBits), isBig);
+
+    __m256d z = _mm256_mul_pd(t, t);
+    z         = _mm256_mul_pd(z, _mm256_div_pd(PolyAvx(z, AtanP, SIZE(AtanP)), Poly1Avx(z, AtanQ, SIZE(AtanQ))));
+    z         = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(t, z), t), more);
+
+    return _mm256_xor_pd(_mm256_add_pd(base, z), _mm256_and_pd(x, _mm256_set1_pd(-0.0)));
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// e^x / 2 = (e^(x/2))^2 / 2: it is finite up to x = 710.47, as sh x and ch x are, while e^x isn't.
+// sh x = e - 1 / 4e, ch x = e + 1 / 4e for e = e^x / 2
+__attribute__((target("avx2")))
+static __m256d HalfExpAvx(__m256d x)
+{
+    __m256d e = ExpAvx(_mm256_mul_pd(_mm256_set1_pd(0.5), x));
+
+    return _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(0.5), e), e);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+static __m256d SinhAvx(__m256d x)
+{
+    const __m256d one = _mm256_set1_pd(1);
+
+    __m256d ax = AbsAvx(x);
+    __m256d e  = HalfExpAvx(ax);
+
+    __m256d big   = _mm256_sub_pd(e, _mm256_div_pd(_mm256_set1_pd(0.25), e));
+    big           = _mm256_xor_pd(big, _mm256_and_pd(x, _mm256_set1_pd(-0.0)));
+    __m256d small = _mm256_mul_pd(x, PolyAvx(_mm256_mul_pd(x, x), SinhCoeffs, SIZE(SinhCoeffs)));
+
+    return _mm256_blendv_pd(big, small, _mm256_cmp_pd(ax, one, _CMP_LT_OQ));
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// th x = (1 - e^-2|x|) / (1 + e^-2|x|) with sign of x, it doesn't overflow; sh x / sqrt(1 + sh^2 x) near zero
+__attribute__((target("avx2")))
+static __m256d TanhAvx(__m256d x)
+{
+    const __m256d one = _mm256_set1_pd(1);
+
+    __m256d ax = AbsAvx(x);
+    __m256d t  = ExpAvx(_mm256_mul_pd(_mm256_set1_pd(-2), ax));
+
+    __m256d big   = _mm256_div_pd(_mm256_sub_pd(one, t), _mm256_add_pd(one, t));
+    big           = _mm256_xor_pd(big, _mm256_and_pd(x, _mm256_set1_pd(-0.0)));
+
+    __m256d sh    = SinhAvx(x);
+    __m256d small = _mm256_div_pd(sh, _mm256_sqrt_pd(_mm256_add_pd(one, _mm256_mul_pd(sh, sh))));
+
+    return _mm256_blendv_pd(big, small, _mm256_cmp_pd(ax, one, _CMP_LT_OQ));
+}
+
+#undef SIZE
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsAvx2Supported()
+{
+    static const bool isSupported = __builtin_cpu_supports("avx2");
+    return isSupported;
+}
+
+#endif
+
+//--------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,16 @@
+#ifndef BATCH_EVAL_H
+#define BATCH_EVAL_H
+
+#include "Bytecode.h"
+
+struct BatchStats_t
+{
+    size_t points;
+    double seconds;
+    double pointsPerSecond;
+};
+
+// out[i] = f(x[i], y[i]), y can be nullptr (then y = 0), stats can be nullptr
+TreeErr BatchEval(const Bytecode_t* bytecode, const Number* x, const Number* y, Number* out, size_t count, BatchStats_t* stats);
+
+#endif
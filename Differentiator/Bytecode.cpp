@@ -0,0 +1,389 @@
+#include <assert.h>
+#include <math.h>
+#include "Bytecode.h"
+#include "MathFunctions.h"
+#include "../Tree/Tree.h"
+#include "../Tree/LetTree.h"
+#include "../Common/GlobalInclude.h"
+
+
+struct BytecodeCompiler_t
+{
+    Bytecode_t* bytecode;
+    LetTree_t   let;
+    uint32_t*   bindingRegs;    // register of every binding, it lives till the end of program
+    LetIndex_t  constants;      // number node -> its register
+    bool*       isTemp;         // register holds temporary value, that is freed after use
+    size_t      regCapacity;
+    uint32_t*   freeRegs;
+    size_t      freeSize;
+};
+
+static TreeErr    BytecodeEmitNode     (BytecodeCompiler_t* compiler, const Node_t* node, size_t computed, uint32_t* reg);
+static TreeErr    BytecodeEmit         (BytecodeCompiler_t* compiler, BytecodeOp op, uint32_t left, uint32_t right, uint32_t* dest);
+static TreeErr    BytecodeRegisterNew  (BytecodeCompiler_t* compiler, bool isTemp, uint32_t* reg);
+static void       BytecodeRegisterFree (BytecodeCompiler_t* compiler, uint32_t reg);
+static BytecodeOp GetOperationOp       (Operation oper);
+static BytecodeOp GetFunctionOp        (Function func);
+
+static const uint32_t XRegister = 0;
+static const uint32_t YRegister = 1;
+
+static const size_t BytecodeMinCapacity = 64;
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// tree is compiled from its let-bound form: value of every common subtree is computed once to own register.
+// temporary registers are reused, when their value is consumed, so program needs about depth of tree registers
+TreeErr BytecodeCompile(const Tree_t* tree, Bytecode_t* bytecode)
+{
+    assert(tree);
+    assert(tree->root);
+    assert(bytecode);
+
+    TreeErr err = {};
+
+    *bytecode = {};
+
+    BytecodeCompiler_t compiler = {};
+    compiler.bytecode = bytecode;
+
+    TREE_ASSERT(LetTreeCtor (&compiler.let, tree));
+    TREE_ASSERT(LetIndexCtor(&compiler.constants, 0));
+
+    compiler.bindingRegs = (uint32_t*) calloc(compiler.let.size + 1, sizeof(uint32_t));
+    RETURN_IF_FALSE(compiler.bindingRegs, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    uint32_t reg = 0;
+    TREE_ASSERT(BytecodeRegisterNew(&compiler, false, &reg));
+    TREE_ASSERT(BytecodeRegisterNew(&compiler, false, &reg));
+
+    for (size_t i = 0; i < compiler.let.size; i++)
+    {
+        TREE_ASSERT(BytecodeEmitNode(&compiler, compiler.let.bindings[i], i, &reg));
+
+        compiler.isTemp[reg]    = false;
+        compiler.bindingRegs[i] = reg;
+    }
+
+    TREE_ASSERT(BytecodeEmitNode(&compiler, compiler.let.result, compiler.let.size, &bytecode->result));
+
+    TREE_ASSERT(LetTreeDtor (&compiler.let));
+    TREE_ASSERT(LetIndexDtor(&compiler.constants));
+    FREE(compiler.bindingRegs);
+    FREE(compiler.isTemp);
+    FREE(compiler.freeRegs);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr BytecodeDtor(Bytecode_t* bytecode)
+{
+    assert(bytecode);
+
+    TreeErr err = {};
+
+    FREE(bytecode->code);
+    FREE(bytecode->registers);
+
+    *bytecode = {};
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+Number BytecodeRun(Bytecode_t* bytecode, Number x, Number y)
+{
+    assert(bytecode);
+    assert(bytecode->registers);
+
+    Number*              reg  = bytecode->registers;
+    const Instruction_t* code = bytecode->code;
+
+    reg[XRegister] = x;
+    reg[YRegister] = y;
+
+    for (size_t i = 0; i < bytecode->size; i++)
+    {
+        Number left  = reg[code[i].left];
+        Number right = reg[code[i].right];
+        Number value = 0;
+
+        switch (code[i].op)
+        {
+            case BytecodeOp::op_add:     value = left + right;      break;
+            case BytecodeOp::op_sub:     value = left - right;      break;
+            case BytecodeOp::op_mul:     value = left * right;      break;
+            case BytecodeOp::op_div:     value = left / right;      break;
+            case BytecodeOp::op_pow:     value = pow(left, right);  break;
+            case BytecodeOp::op_neg:     value = -left;             break;
+            case BytecodeOp::op_sqrt:    value = sqrt(left);        break;
+            case BytecodeOp::op_ln:      value = log(left);         break;
+            case BytecodeOp::op_sin:     value = sin(left);         break;
+            case BytecodeOp::op_cos:     value = cos(left);         break;
+            case BytecodeOp::op_tg:      value = tan(left);         break;
+            case BytecodeOp::op_ctg:     value = ctg(left);         break;
+            case BytecodeOp::op_sh:      value = sinh(left);        break;
+            case BytecodeOp::op_ch:      value = cosh(left);        break;
+            case BytecodeOp::op_th:      value = tanh(left);        break;
+            case BytecodeOp::op_cth:     value = ctgh(left);        break;
+            case BytecodeOp::op_arcsin:  value = asin(left);        break;
+            case BytecodeOp::op_arccos:  value = acos(left);        break;
+            case BytecodeOp::op_arctg:   value = atan(left);        break;
+            case BytecodeOp::op_arcctg:  value = actg(left);        break;
+            default: assert(0 && "undefined bytecode op.\n");       break;
+        }
+
+        reg[code[i].dest] = value;
+    }
+
+    return reg[bytecode->result];
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// bindings with number < computed are already in their registers
+static TreeErr BytecodeEmitNode(BytecodeCompiler_t* compiler, const Node_t* node, size_t computed, uint32_t* reg)
+{
+    assert(compiler);
+    assert(node);
+    assert(reg);
+
+    TreeErr err = {};
+
+    size_t binding = LetTreeFind(&compiler->let, node);
+    RETURN_IF_TRUE(binding < computed, err, *reg = compiler->bindingRegs[binding]);
+
+    uint32_t left  = XRegister;
+    uint32_t right = XRegister;
+
+    switch (node->type)
+    {
+        case NodeArgType::variable:
+        {
+            *reg = (node->data.var == Variable::x) ? XRegister : YRegister;
+            break;
+        }
+
+        case NodeArgType::number:
+        {
+            size_t known = LetIndexFind(&compiler->constants, node);
+            RETURN_IF_TRUE(known != LetNull, err, *reg = (uint32_t) known);
+
+            TREE_ASSERT(BytecodeRegisterNew(compiler, false, reg));
+            TREE_ASSERT(LetIndexInsert(&compiler->constants, node, *reg));
+
+            compiler->bytecode->registers[*reg] = node->data.num;
+            break;
+        }
+
+        case NodeArgType::function:
+        {
+            TREE_ASSERT(BytecodeEmitNode(compiler, node->left, computed, &left));
+            BytecodeRegisterFree(compiler, left);
+
+            TREE_ASSERT(BytecodeEmit(compiler, GetFunctionOp(node->data.func), left, left, reg));
+            break;
+        }
+
+        case NodeArgType::operation:
+        {
+            TREE_ASSERT(BytecodeEmitNode(compiler, node->left, computed, &left));
+
+            if (node->right)
+            {
+                TREE_ASSERT(BytecodeEmitNode(compiler, node->right, computed, &right));
+            }
+
+            BytecodeRegisterFree(compiler, left);
+            BytecodeRegisterFree(compiler, right);
+
+            BytecodeOp op = node->right ? GetOperationOp(node->data.oper) : BytecodeOp::op_neg;
+            TREE_ASSERT(BytecodeEmit(compiler, op, left, node->right ? right : left, reg));
+            break;
+        }
+
+        case NodeArgType::undefined:
+        default: err.err = TreeErrorType::UNDEFINED_NODE_TYPE; break;
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr BytecodeEmit(BytecodeCompiler_t* compiler, BytecodeOp op, uint32_t left, uint32_t right, uint32_t* dest)
+{
+    assert(compiler);
+    assert(dest);
+
+    TreeErr err = {};
+
+    Bytecode_t* bytecode = compiler->bytecode;
+
+    if (bytecode->size == bytecode->capacity)
+    {
+        size_t         capacity = bytecode->capacity ? 2 * bytecode->capacity : BytecodeMinCapacity;
+        Instruction_t* code     = (Instruction_t*) realloc(bytecode->code, capacity * sizeof(Instruction_t));
+
+        RETURN_IF_FALSE(code, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+        bytecode->code     = code;
+        bytecode->capacity = capacity;
+    }
+
+    TREE_ASSERT(BytecodeRegisterNew(compiler, true, dest));
+
+    bytecode->code[bytecode->size++] = {op, *dest, left, right};
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// temporary register is taken from freed ones, if there are any
+static TreeErr BytecodeRegisterNew(BytecodeCompiler_t* compiler, bool isTemp, uint32_t* reg)
+{
+    assert(compiler);
+    assert(reg);
+
+    TreeErr err = {};
+
+    Bytecode_t* bytecode = compiler->bytecode;
+
+    if (isTemp && compiler->freeSize)
+    {
+        *reg = compiler->freeRegs[--compiler->freeSize];
+        compiler->isTemp[*reg] = true;
+
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    if (bytecode->registerQuant == compiler->regCapacity)
+    {
+        size_t    capacity  = compiler->regCapacity ? 2 * compiler->regCapacity : BytecodeMinCapacity;
+        Number*   registers = (Number*)   realloc(bytecode->registers, capacity * sizeof(Number));
+        if (registers) bytecode->registers = registers;
+
+        bool*     temp      = (bool*)     realloc(compiler->isTemp,    capacity * sizeof(bool));
+        if (temp)      compiler->isTemp    = temp;
+
+        uint32_t* freeRegs  = (uint32_t*) realloc(compiler->freeRegs,  capacity * sizeof(uint32_t));
+        if (freeRegs)  compiler->freeRegs  = freeRegs;
+
+        RETURN_IF_FALSE(registers && temp && freeRegs, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+        compiler->regCapacity = capacity;
+    }
+
+    *reg = (uint32_t) bytecode->registerQuant++;
+
+    bytecode->registers[*reg] = 0;
+    compiler->isTemp   [*reg] = isTemp;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// registers of variables, constants and bindings are never freed
+static void BytecodeRegisterFree(BytecodeCompiler_t* compiler, uint32_t reg)
+{
+    assert(compiler);
+
+    if (!compiler->isTemp[reg]) return;
+
+    compiler->isTemp[reg] = false;
+    compiler->freeRegs[compiler->freeSize++] = reg;
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static BytecodeOp GetOperationOp(Operation oper)
+{
+    switch (oper)
+    {
+        case Operation::plus:  return BytecodeOp::op_add;
+        case Operation::minus: return BytecodeOp::op_sub;
+        case Operation::mul:   return BytecodeOp::op_mul;
+        case Operation::dive:  return BytecodeOp::op_div;
+        case Operation::power: return BytecodeOp::op_pow;
+        case Operation::undefined_operation:
+        default: assert(0 && "undefined operation in bytecode.\n"); break;
+    }
+
+    return BytecodeOp::op_add;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static BytecodeOp GetFunctionOp(Function func)
+{
+    switch (func)
+    {
+        case Function::Sqrt:   return BytecodeOp::op_sqrt;
+        case Function::Ln:     return BytecodeOp::op_ln;
+        case Function::Sin:    return BytecodeOp::op_sin;
+        case Function::Cos:    return BytecodeOp::op_cos;
+        case Function::Tg:     return BytecodeOp::op_tg;
+        case Function::Ctg:    return BytecodeOp::op_ctg;
+        case Function::Sh:     return BytecodeOp::op_sh;
+        case Function::Ch:     return BytecodeOp::op_ch;
+        case Function::Th:     return BytecodeOp::op_th;
+        case Function::Cth:    return BytecodeOp::op_cth;
+        case Function::Arcsin: return BytecodeOp::op_arcsin;
+        case Function::Arccos: return BytecodeOp::op_arccos;
+        case Function::Arctg:  return BytecodeOp::op_arctg;
+        case Function::Arcctg: return BytecodeOp::op_arcctg;
+        case Function::undefined_function:
+        default: assert(0 && "undefined function in bytecode.\n"); break;
+    }
+
+    return BytecodeOp::op_sqrt;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// libm or MathFunctions function of function opcode
+double (*GetBytecodeFunction(BytecodeOp op)) (double)
+{
+    switch (op)
+    {
+        case BytecodeOp::op_sqrt:    return sqrt;
+        case BytecodeOp::op_ln:      return log;
+        case BytecodeOp::op_sin:     return sin;
+        case BytecodeOp::op_cos:     return cos;
+        case BytecodeOp::op_tg:      return tan;
+        case BytecodeOp::op_ctg:     return ctg;
+        case BytecodeOp::op_sh:      return sinh;
+        case BytecodeOp::op_ch:      return cosh;
+        case BytecodeOp::op_th:      return tanh;
+        case BytecodeOp::op_cth:     return ctgh;
+        case BytecodeOp::op_arcsin:  return asin;
+        case BytecodeOp::op_arccos:  return acos;
+        case BytecodeOp::op_arctg:   return atan;
+        case BytecodeOp::op_arcctg:  return actg;
+        case BytecodeOp::op_add:
+        case BytecodeOp::op_sub:
+        case BytecodeOp::op_mul:
+        case BytecodeOp::op_div:
+        case BytecodeOp::op_pow:
+        case BytecodeOp::op_neg:
+        default: assert(0 && "not function opcode.\n"); break;
+    }
+
+    return nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,59 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <stdint.h>
+#include "../Tree/Tree.h"
+
+// every operation and every function has own opcode, so instruction is executed by one switch
+enum BytecodeOp
+{
+    op_add,
+    op_sub,
+    op_mul,
+    op_div,
+    op_pow,
+    op_neg,
+    op_sqrt,
+    op_ln,
+    op_sin,
+    op_cos,
+    op_tg,
+    op_ctg,
+    op_sh,
+    op_ch,
+    op_th,
+    op_cth,
+    op_arcsin,
+    op_arccos,
+    op_arctg,
+    op_arcctg,
+};
+
+// registers[dest] = registers[left] op registers[right], unary op uses only left
+struct Instruction_t
+{
+    BytecodeOp op;
+    uint32_t   dest;
+    uint32_t   left;
+    uint32_t   right;
+};
+
+// register 0 is x, register 1 is y, constants are put to their registers by compiler,
+// so run only sets variables and executes instructions
+struct Bytecode_t
+{
+    Instruction_t* code;
+    size_t         size;
+    size_t         capacity;
+    Number*        registers;
+    size_t         registerQuant;
+    uint32_t       result;
+};
+
+TreeErr BytecodeCompile (const Tree_t* tree, Bytecode_t* bytecode);
+TreeErr BytecodeDtor    (Bytecode_t* bytecode);
+Number  BytecodeRun     (Bytecode_t* bytecode, Number x, Number y);
+
+double (*GetBytecodeFunction(BytecodeOp op)) (double);
+
+#endif
@@ -0,0 +1,768 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "CanonicalTree.h"
+#include "SimplifyTree.h"
+#include "MathFunctions.h"
+#include "../Tree/Tree.h"
+#include "../Tree/NodeTable.h"
+#include "../Common/GlobalInclude.h"
+
+
+// sum is kept as list of (term, coefficient) and constant, product - as list of (base, exponent) and coefficient
+struct CanonItem_t
+{
+    Node_t* node;
+    Number  num;
+};
+
+struct CanonList_t
+{
+    CanonItem_t* items;
+    size_t       size;
+    size_t       capacity;
+    Number       constant;
+    Number       divisor;  // product: numeric divisors, constant/divisor is reduced by CanonListReduce
+};
+
+// state of one CanonicalTree call
+struct Canon_t
+{
+    bool      memo; // dag: canonical form of shared node is built only once
+    NodeMap_t done; // source node -> its canonical form
+};
+
+
+static TreeErr CanonNode             (Canon_t* c, const Node_t* node, Node_t** canon);
+static TreeErr CanonSum              (Canon_t* c, const Node_t* node, Node_t** canon);
+static TreeErr CanonProduct          (Canon_t* c, const Node_t* node, Number* coeff, Node_t** rest);
+static TreeErr CollectSum            (Canon_t* c, CanonList_t* list, const Node_t* node, Number sign);
+static TreeErr CollectProduct        (Canon_t* c, CanonList_t* list, const Node_t* node, Number sign);
+static TreeErr CollectNumberFactor   (CanonList_t* list, Node_t* number, Number sign);
+static TreeErr MergePowers           (Node_t** base, Number* exponent);
+static TreeErr MakeTerm              (Number coeff, Node_t* rest, Node_t** term);
+
+static TreeErr CanonListPush         (CanonList_t* list, Node_t* node, Number num);
+static TreeErr CanonListMerge        (CanonList_t* list);
+static TreeErr CanonListRemoveZeros  (CanonList_t* list);
+static void    CanonListReduce       (CanonList_t* list);
+static TreeErr CanonListDtor         (CanonList_t* list);
+static int     CanonItemCompare      (const void* first, const void* second);
+static int     NodeCompare           (const Node_t* first, const Node_t* second);
+static int     NodeTypeRank          (NodeArgType type);
+
+static bool    IsOperation           (const Node_t* node, Operation oper);
+static bool    IsSumNode             (const Node_t* node);
+static bool    IsProductNode         (const Node_t* node);
+static bool    IsUnaryMinus          (const Node_t* node);
+static bool    IsNumEqual            (Number first, Number second);
+static bool    IsNumWhole            (Number num);
+static Number  NumGcd                (Number first, Number second);
+
+static const Number eps = 0.0000000001;
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// x*2*3 -> 6*x, x+x+x -> 3*x, x*x -> x^2, x*(1/x) -> 1: chains of + and of * and / are flattened to lists, divisor f is
+// factor f^-1, operands are sorted by NodeCompare, equal terms and equal bases are merged. Coefficient goes first
+// in product, constant goes first in sum: (-2)+x. Factors with negative exponent are written back as denominator.
+TreeErr CanonicalTree(Tree_t* tree)
+{
+    assert(tree);
+    assert(tree->root);
+
+    TreeErr err = {};
+
+    NodeArena_t* oldArena = NodeArenaSwitch(&tree->arena);
+
+    Canon_t c = {};
+    c.memo = (tree->arena.unique != nullptr);
+    TREE_ASSERT(NodeMapCtor(&c.done, 0));
+
+    Node_t* canon = nullptr;
+    TREE_ASSERT(CanonNode(&c, tree->root, &canon));
+    TREE_ASSERT(NodeAndUnderTreeDtor(tree->root));
+    tree->root = canon;
+
+    TREE_ASSERT(NodeMapDtor(&c.done));
+
+    NodeArenaSwitch(oldArena);
+
+    return TREE_VERIF(tree, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr CanonNode(Canon_t* c, const Node_t* node, Node_t** canon)
+{
+    assert(c);
+    assert(node);
+    assert(canon);
+
+    TreeErr err = {};
+    NODE_RETURN_IF_ERR(node, err);
+
+    Node_t* known = c->memo ? NodeMapFind(&c->done, node) : nullptr;
+    RETURN_IF_TRUE(known, NODE_VERIF(known, err), *canon = known);
+
+    Node_t* left  = nullptr;
+    Node_t* right = nullptr;
+
+    NodeArgType type = node->type;
+
+    switch (type)
+    {
+        case NodeArgType::number:
+        case NodeArgType::variable:
+        {
+            TREE_ASSERT(NodeCtor(canon, type, node->data, nullptr, nullptr));
+            break;
+        }
+
+        case NodeArgType::function:
+        {
+            TREE_ASSERT(CanonNode(c, node->left, &left));
+            TREE_ASSERT(FoldNodeCtor(canon, type, node->data, left, nullptr));
+            break;
+        }
+
+        case NodeArgType::operation:
+        {
+            if (IsSumNode(node) || IsUnaryMinus(node))
+            {
+                TREE_ASSERT(CanonSum(c, node, canon));
+            }
+
+            else if (IsProductNode(node))
+            {
+                Number coeff = 0;
+                TREE_ASSERT(CanonProduct(c, node, &coeff, &left));
+                TREE_ASSERT(MakeTerm(coeff, left, canon));
+            }
+
+            else
+            {
+                TREE_ASSERT(CanonNode(c, node->left,  &left));
+                TREE_ASSERT(CanonNode(c, node->right, &right));
+
+                if (IsOperation(node, Operation::power) && right->type == NodeArgType::number)
+                {
+                    Number exponent = right->data.num;
+                    TREE_ASSERT(NodeDtor(right));
+                    TREE_ASSERT(MergePowers(&left, &exponent));
+                    _NUM(&right, exponent);
+                }
+
+                TREE_ASSERT(FoldNodeCtor(canon, type, node->data, left, right));
+            }
+
+            break;
+        }
+
+        case NodeArgType::undefined: err.err = UNDEFINED_NODE_TYPE;           break;
+        default: assert(0 && "you forgot about some node type.\n");           break;
+    }
+
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    if (c->memo)
+    {
+        TREE_ASSERT(NodeMapInsert(&c->done, node, *canon));
+    }
+
+    return NODE_VERIF(*canon, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr CanonSum(Canon_t* c, const Node_t* node, Node_t** canon)
+{
+    assert(c);
+    assert(node);
+    assert(canon);
+
+    TreeErr err = {};
+
+    CanonList_t list = {};
+    list.constant = 0;
+
+    TREE_ASSERT(CollectSum(c, &list, node, 1));
+    TREE_ASSERT(CanonListMerge(&list));
+    TREE_ASSERT(CanonListRemoveZeros(&list));
+
+    Node_t* sum = nullptr;
+
+    if (!IsNumEqual(list.constant, 0) || list.size == 0)
+    {
+        _NUM(&sum, list.constant);
+    }
+
+    else
+    {
+        // sum without constant starts from positive term, if there is one: x - y, not -y + x
+        size_t first = 0;
+        while (first < list.size && list.items[first].num < 0) first++;
+
+        if (first < list.size)
+        {
+            CanonItem_t positive = list.items[first];
+            memmove(list.items + 1, list.items, first * sizeof(CanonItem_t));
+            list.items[0] = positive;
+        }
+    }
+
+    for (size_t i = 0; i < list.size; i++)
+    {
+        Node_t* rest  = list.items[i].node;
+        Number  coeff = list.items[i].num;
+
+        if (!sum)
+        {
+            TREE_ASSERT(MakeTerm(coeff, rest, &sum));
+            continue;
+        }
+
+        Node_t* term = nullptr;
+        TREE_ASSERT(MakeTerm(coeff < 0 ? -coeff : coeff, rest, &term));
+
+        if (coeff < 0) _SUB(&sum, sum, term);
+        else           _ADD(&sum, sum, term);
+    }
+
+    TREE_ASSERT(CanonListDtor(&list));
+
+    *canon = sum;
+
+    return NODE_VERIF(*canon, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// product is split to numeric coefficient and rest without numbers; rest is nullptr, if there are only numbers
+static TreeErr CanonProduct(Canon_t* c, const Node_t* node, Number* coeff, Node_t** rest)
+{
+    assert(c);
+    assert(node);
+    assert(coeff);
+    assert(rest);
+
+    TreeErr err = {};
+
+    CanonList_t list = {};
+    list.constant = 1;
+    list.divisor  = 1;
+
+    TREE_ASSERT(CollectProduct(c, &list, node, 1));
+    TREE_ASSERT(CanonListMerge(&list));
+    TREE_ASSERT(CanonListRemoveZeros(&list));
+    CanonListReduce(&list);
+
+    Node_t* numerator   = nullptr;
+    Node_t* denominator = nullptr;
+
+    for (size_t i = 0; i < list.size; i++)
+    {
+        Node_t* factor   = list.items[i].node;
+        Number  exponent = list.items[i].num;
+
+        if (IsNumEqual(list.constant, 0))
+        {
+            TREE_ASSERT(NodeAndUnderTreeDtor(factor));
+            continue;
+        }
+
+        Node_t** part = (exponent < 0) ? &denominator : &numerator;
+        if (exponent < 0) exponent = -exponent;
+
+        if (!IsNumEqual(exponent, 1))
+        {
+            Node_t* power = nullptr;
+            _NUM(&power, exponent);
+            _POW(&factor, factor, power);
+        }
+
+        if (*part) _MUL(part, *part, factor);
+        else       *part = factor;
+    }
+
+    if (!IsNumEqual(list.divisor, 1))
+    {
+        Node_t* divisor = nullptr;
+        _NUM(&divisor, list.divisor);
+
+        if (denominator) _MUL(&denominator, divisor, denominator);
+        else             denominator = divisor;
+    }
+
+    if (denominator)
+    {
+        if (!numerator) _NUM(&numerator, 1);
+        _DIV(&numerator, numerator, denominator);
+    }
+
+    *coeff = list.constant;
+    *rest  = numerator;
+
+    TREE_ASSERT(CanonListDtor(&list));
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// terms of flattened sum: term is taken with sign, that +, - and unary - above it give
+static TreeErr CollectSum(Canon_t* c, CanonList_t* list, const Node_t* node, Number sign)
+{
+    assert(c);
+    assert(list);
+    assert(node);
+
+    TreeErr err = {};
+
+    if (IsUnaryMinus(node))
+    {
+        return CollectSum(c, list, node->left, -sign);
+    }
+
+    if (IsSumNode(node))
+    {
+        TREE_ASSERT(CollectSum(c, list, node->left, sign));
+        return CollectSum(c, list, node->right, IsOperation(node, Operation::minus) ? -sign : sign);
+    }
+
+    if (IsProductNode(node))
+    {
+        Number  coeff = 0;
+        Node_t* rest  = nullptr;
+        TREE_ASSERT(CanonProduct(c, node, &coeff, &rest));
+
+        if (rest) return CanonListPush(list, rest, sign * coeff);
+
+        list->constant += sign * coeff;
+        return err;
+    }
+
+    Node_t* term = nullptr;
+    TREE_ASSERT(CanonNode(c, node, &term));
+
+    if (term->type == NodeArgType::number)
+    {
+        list->constant += sign * term->data.num;
+        return NodeDtor(term);
+    }
+
+    // folding of term can give new sum or product, it is flattened too. k/f becomes term 1/f with coefficient k,
+    // so -1/f and 1/f are like terms
+    if (IsSumNode(term) || IsUnaryMinus(term) || IsProductNode(term))
+    {
+        TREE_ASSERT(CollectSum(c, list, term, sign));
+        return NodeAndUnderTreeDtor(term);
+    }
+
+    return CanonListPush(list, term, sign);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// factors of flattened product: numbers go to coefficient, f^n gives base f with exponent n.
+// sign is -1 under divisor: there f^n gives exponent -n, so x and 1/x are like factors
+static TreeErr CollectProduct(Canon_t* c, CanonList_t* list, const Node_t* node, Number sign)
+{
+    assert(c);
+    assert(list);
+    assert(node);
+
+    if (IsUnaryMinus(node))
+    {
+        list->constant = -list->constant;
+        return CollectProduct(c, list, node->left, sign);
+    }
+
+    if (IsProductNode(node))
+    {
+        TREE_ASSERT(CollectProduct(c, list, node->left, sign));
+        return CollectProduct(c, list, node->right, IsOperation(node, Operation::dive) ? -sign : sign);
+    }
+
+    Node_t* factor = nullptr;
+    TREE_ASSERT(CanonNode(c, node, &factor));
+
+    if (factor->type == NodeArgType::number)
+    {
+        return CollectNumberFactor(list, factor, sign);
+    }
+
+    if (IsUnaryMinus(factor) || IsProductNode(factor))
+    {
+        TREE_ASSERT(CollectProduct(c, list, factor, sign));
+        return NodeAndUnderTreeDtor(factor);
+    }
+
+    if (IsOperation(factor, Operation::power) && factor->right->type == NodeArgType::number)
+    {
+        Node_t* base     = factor->left;
+        Number  exponent = factor->right->data.num;
+
+        TREE_ASSERT(NodeDtor(factor->right));
+        TREE_ASSERT(NodeDtor(factor));
+
+        TREE_ASSERT(MergePowers(&base, &exponent));
+
+        return CanonListPush(list, base, sign * exponent);
+    }
+
+    return CanonListPush(list, factor, sign);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// number goes to coefficient, divisor - to divisor of coefficient. Division by 0 stays in tree, it is not folded
+static TreeErr CollectNumberFactor(CanonList_t* list, Node_t* number, Number sign)
+{
+    assert(list);
+    assert(number);
+
+    Number num = number->data.num;
+
+    if (sign < 0 && IsNumEqual(num, 0))
+    {
+        return CanonListPush(list, number, sign);
+    }
+
+    if (sign > 0) list->constant *= num;
+    else          list->divisor  *= num;
+
+    return NodeDtor(number);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// (f^m)^n = f^(m*n) for whole n, so (x^5)^2 and x^3 are like factors and (x^2)^3 is x^6
+static TreeErr MergePowers(Node_t** base, Number* exponent)
+{
+    assert(base);
+    assert(*base);
+    assert(exponent);
+
+    TreeErr err = {};
+
+    while (IsOperation(*base, Operation::power) && (*base)->right->type == NodeArgType::number && IsNumWhole(*exponent))
+    {
+        Node_t* inner = (*base)->left;
+        *exponent *= (*base)->right->data.num;
+
+        TREE_ASSERT(NodeDtor((*base)->right));
+        TREE_ASSERT(NodeDtor(*base));
+
+        *base = inner;
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr MakeTerm(Number coeff, Node_t* rest, Node_t** term)
+{
+    assert(term);
+
+    TreeErr err = {};
+
+    if (!rest || IsNumEqual(coeff, 0))
+    {
+        if (rest) TREE_ASSERT(NodeAndUnderTreeDtor(rest));
+        _NUM(term, rest ? 0 : coeff);
+        return NODE_VERIF(*term, err);
+    }
+
+    if (IsNumEqual(coeff, 1))
+    {
+        *term = rest;
+        return NODE_VERIF(*term, err);
+    }
+
+    if (IsNumEqual(coeff, -1))
+    {
+        _SUB(term, rest, nullptr);
+        return NODE_VERIF(*term, err);
+    }
+
+    Node_t* number = nullptr;
+    _NUM(&number, coeff);
+    _MUL(term, number, rest);
+
+    return NODE_VERIF(*term, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr CanonListPush(CanonList_t* list, Node_t* node, Number num)
+{
+    assert(list);
+    assert(node);
+
+    TreeErr err = {};
+
+    if (list->size == list->capacity)
+    {
+        size_t       capacity = list->capacity ? 2 * list->capacity : 8;
+        CanonItem_t* items    = (CanonItem_t*) realloc(list->items, capacity * sizeof(CanonItem_t));
+
+        RETURN_IF_FALSE(items, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+        list->items    = items;
+        list->capacity = capacity;
+    }
+
+    list->items[list->size].node = node;
+    list->items[list->size].num  = num;
+    list->size++;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// sorted items with equal nodes are neighbours: their numbers are added, copies of node are freed
+static TreeErr CanonListMerge(CanonList_t* list)
+{
+    assert(list);
+
+    TreeErr err = {};
+
+    RETURN_IF_TRUE(list->size == 0, err);
+
+    qsort(list->items, list->size, sizeof(CanonItem_t), CanonItemCompare);
+
+    size_t last = 0;
+
+    for (size_t i = 1; i < list->size; i++)
+    {
+        if (NodeCompare(list->items[last].node, list->items[i].node) == 0)
+        {
+            list->items[last].num += list->items[i].num;
+            TREE_ASSERT(NodeAndUnderTreeDtor(list->items[i].node));
+            continue;
+        }
+
+        list->items[++last] = list->items[i];
+    }
+
+    list->size = last + 1;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// terms with zero coefficient and factors with zero exponent are dropped
+static TreeErr CanonListRemoveZeros(CanonList_t* list)
+{
+    assert(list);
+
+    TreeErr err = {};
+
+    size_t size = 0;
+
+    for (size_t i = 0; i < list->size; i++)
+    {
+        if (IsNumEqual(list->items[i].num, 0))
+        {
+            TREE_ASSERT(NodeAndUnderTreeDtor(list->items[i].node));
+            continue;
+        }
+
+        list->items[size++] = list->items[i];
+    }
+
+    list->size = size;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// x/3*3 -> x, 2*x/4 -> x/2, x/(2*x) -> 0.5: whole quotient of coefficient goes to constant, product of numbers only
+// is folded to one number, other fraction of whole numbers is cancelled by gcd: x/3 stays x/3, not 0.333*x
+static void CanonListReduce(CanonList_t* list)
+{
+    assert(list);
+
+    if (list->divisor < 0)
+    {
+        list->constant = -list->constant;
+        list->divisor  = -list->divisor;
+    }
+
+    Number quotient = list->constant / list->divisor;
+
+    if (list->size == 0 || IsNumWhole(quotient))
+    {
+        list->constant = quotient;
+        list->divisor  = 1;
+        return;
+    }
+
+    if (IsNumWhole(list->constant) && IsNumWhole(list->divisor))
+    {
+        Number gcd = NumGcd(fabs(round(list->constant)), round(list->divisor));
+
+        list->constant = round(list->constant) / gcd;
+        list->divisor  = round(list->divisor)  / gcd;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr CanonListDtor(CanonList_t* list)
+{
+    assert(list);
+
+    TreeErr err = {};
+
+    FREE(list->items);
+    list->size     = 0;
+    list->capacity = 0;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static int CanonItemCompare(const void* first, const void* second)
+{
+    assert(first);
+    assert(second);
+
+    return NodeCompare(((const CanonItem_t*) first)->node, ((const CanonItem_t*) second)->node);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// total order of subtrees: numbers, variables, functions, operations; then by data and by children.
+// 0 means, that subtrees are equal
+static int NodeCompare(const Node_t* first, const Node_t* second)
+{
+    RETURN_IF_TRUE(first == second, 0);
+    RETURN_IF_FALSE(first,  -1);
+    RETURN_IF_FALSE(second,  1);
+
+    int rank = NodeTypeRank(first->type) - NodeTypeRank(second->type);
+    RETURN_IF_TRUE(rank != 0, rank);
+
+    NodeData_t a = first->data;
+    NodeData_t b = second->data;
+
+    switch (first->type)
+    {
+        case NodeArgType::number:
+        {
+            RETURN_IF_TRUE(a.num < b.num, -1);
+            RETURN_IF_TRUE(a.num > b.num,  1);
+            return 0;
+        }
+
+        case NodeArgType::variable:  RETURN_IF_TRUE(a.var  != b.var,  (a.var  < b.var)  ? -1 : 1); return 0;
+        case NodeArgType::function:  RETURN_IF_TRUE(a.func != b.func, (a.func < b.func) ? -1 : 1); break;
+        case NodeArgType::operation: RETURN_IF_TRUE(a.oper != b.oper, (a.oper < b.oper) ? -1 : 1); break;
+        case NodeArgType::undefined:
+        default: assert(0 && "undefined node type in compare.\n"); return 0;
+    }
+
+    int left = NodeCompare(first->left, second->left);
+    RETURN_IF_TRUE(left != 0, left);
+
+    return NodeCompare(first->right, second->right);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static int NodeTypeRank(NodeArgType type)
+{
+    switch (type)
+    {
+        case NodeArgType::number:    return 0;
+        case NodeArgType::variable:  return 1;
+        case NodeArgType::function:  return 2;
+        case NodeArgType::operation: return 3;
+        case NodeArgType::undefined:
+        default: assert(0 && "undefined node type in compare.\n"); break;
+    }
+
+    return 4;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsOperation(const Node_t* node, Operation oper)
+{
+    assert(node);
+
+    return (node->type == NodeArgType::operation) && (node->data.oper == oper);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsSumNode(const Node_t* node)
+{
+    assert(node);
+
+    return IsOperation(node, Operation::plus) || (IsOperation(node, Operation::minus) && node->right);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsProductNode(const Node_t* node)
+{
+    assert(node);
+
+    return IsOperation(node, Operation::mul) || IsOperation(node, Operation::dive);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsUnaryMinus(const Node_t* node)
+{
+    assert(node);
+
+    return IsOperation(node, Operation::minus) && !node->right;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsNumEqual(Number first, Number second)
+{
+    return IsDoubleEqual(first, second, eps);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsNumWhole(Number num)
+{
+    return IsNumEqual(num, round(num));
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// both numbers are whole and not negative, second is not 0
+static Number NumGcd(Number first, Number second)
+{
+    while (!IsNumEqual(second, 0))
+    {
+        Number rest = fmod(first, second);
+        first  = second;
+        second = rest;
+    }
+
+    return first;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
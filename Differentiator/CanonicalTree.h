@@ -0,0 +1,8 @@
+#ifndef CANONICAL_TREE_H
+#define CANONICAL_TREE_H
+
+#include "../Tree/Tree.h"
+
+TreeErr CanonicalTree(Tree_t* tree);
+
+#endif
@@ -0,0 +1,280 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include "Dsl.h"
+#include "../Differentiator.h"
+#include "../SimplifyTree.h"
+#include "../MathFunctions.h"
+#include "../../Tree/Tree.h"
+#include "../../Tree/LetTree.h"
+#include "../../Common/GlobalInclude.h"
+
+
+static TreeErr     CodeGenerateDerivative (FILE* file, const Tree_t* tree, size_t index);
+static void        CodeGenerateNode       (FILE* file, const LetTree_t* let, const Node_t* node, size_t computed);
+static void        CodeGenerateNumber     (FILE* file, Number num);
+static const char* GetOperationCode       (Operation oper);
+static const char* GetFunctionCode        (Function func);
+
+static const char*  CodeCompiler      = "cc -O2 -shared -fPIC";
+static const char*  CodeFunctionName  = "expression";
+static const size_t MaxPathLen        = 128;
+static const size_t MaxCommandLen     = 512;
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// file is standalone C: it needs only math.h, functions, that libm doesn't have, are defined as in MathFunctions.cpp
+TreeErr CodeGenerate(FILE* file, const Tree_t* tree, const char* name, size_t order)
+{
+    assert(file);
+    assert(tree);
+    assert(tree->root);
+    assert(name);
+
+    TreeErr err = {};
+
+    fprintf(file, "#include <math.h>\n\n");
+
+    fprintf(file, "static double ctg (double arg) { double tg  = tan (arg); if (tg  < 1e-50 && tg  > -1e-50) return INFINITY; return 1 / tg;  }\n");
+    fprintf(file, "static double actg(double arg) { return %.17g / 2 - atan(arg); }\n", Pi);
+    fprintf(file, "static double ctgh(double arg) { double tgh = tanh(arg); if (tgh < 1e-50 && tgh > -1e-50) return INFINITY; return 1 / tgh; }\n\n");
+
+    fprintf(file, "void %s(double x, double y, double* out)\n{\n", name);
+    fprintf(file, "    (void) x;\n    (void) y;\n\n");
+
+    TREE_ASSERT(CodeGenerateDerivative(file, tree, 0));
+
+    // every next derivative is taken from previous one, as in Taylor
+    Tree_t derivative = {};
+
+    for (size_t index = 1; index <= order; index++)
+    {
+        Tree_t next = {};
+
+        TREE_ASSERT(Diff(index == 1 ? tree : &derivative, &next, Variable::x));
+        TREE_ASSERT(SimplifyTree(&next));
+
+        if (derivative.root) TREE_ASSERT(TreeDtor(&derivative));
+        derivative = next;
+
+        TREE_ASSERT(CodeGenerateDerivative(file, &derivative, index));
+    }
+
+    if (derivative.root) TREE_ASSERT(TreeDtor(&derivative));
+
+    fprintf(file, "}\n");
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// source and library live in temporary directory only while they are built and loaded
+TreeErr CodeCompile(const Tree_t* tree, size_t order, CompiledCode_t* code)
+{
+    assert(tree);
+    assert(code);
+
+    TreeErr err = {};
+
+    *code = {};
+
+    char dir[] = "/tmp/differentiatorXXXXXX";
+    RETURN_IF_FALSE(mkdtemp(dir), err, err.err = TreeErrorType::CODE_GENERATE_FAILED, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    char source [MaxPathLen] = {};
+    char library[MaxPathLen] = {};
+    snprintf(source,  MaxPathLen, "%s/expression.c",  dir);
+    snprintf(library, MaxPathLen, "%s/expression.so", dir);
+
+    FILE* file = fopen(source, "w");
+    RETURN_IF_FALSE(file, err, rmdir(dir), err.err = TreeErrorType::CODE_GENERATE_FAILED, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    err = CodeGenerate(file, tree, CodeFunctionName, order);
+    fclose(file);
+
+    char command[MaxCommandLen] = {};
+    snprintf(command, MaxCommandLen, "%s -o %s %s -lm", CodeCompiler, library, source);
+
+    if (err.err == TreeErrorType::NO_ERR && system(command) == 0)
+    {
+        code->library = dlopen(library, RTLD_NOW | RTLD_LOCAL);
+    }
+
+    // loaded library stays mapped after its file is removed
+    unlink(source);
+    unlink(library);
+    rmdir(dir);
+
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+    RETURN_IF_FALSE(code->library, err, err.err = TreeErrorType::CODE_GENERATE_FAILED, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    void* function = dlsym(code->library, CodeFunctionName);
+    RETURN_IF_FALSE(function, err, dlclose(code->library), code->library = nullptr, err.err = TreeErrorType::CODE_GENERATE_FAILED, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    memcpy(&code->function, &function, sizeof(code->function));
+    code->order = order;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr CompiledCodeDtor(CompiledCode_t* code)
+{
+    assert(code);
+
+    TreeErr err = {};
+
+    if (code->library) dlclose(code->library);
+
+    *code = {};
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// derivative is written in its let-bound form: common subtrees are local constants
+static TreeErr CodeGenerateDerivative(FILE* file, const Tree_t* tree, size_t index)
+{
+    assert(file);
+    assert(tree);
+
+    TreeErr err = {};
+
+    LetTree_t let = {};
+    TREE_ASSERT(LetTreeCtor(&let, tree));
+
+    fprintf(file, "    {\n");
+
+    for (size_t i = 0; i < let.size; i++)
+    {
+        fprintf(file, "        const double t%lu = ", i);
+        CodeGenerateNode(file, &let, let.bindings[i], i);
+        fprintf(file, ";\n");
+    }
+
+    fprintf(file, "        out[%lu] = ", index);
+    CodeGenerateNode(file, &let, let.result, let.size);
+    fprintf(file, ";\n    }\n");
+
+    TREE_ASSERT(LetTreeDtor(&let));
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// bindings with number < computed are already declared
+static void CodeGenerateNode(FILE* file, const LetTree_t* let, const Node_t* node, size_t computed)
+{
+    assert(file);
+    assert(let);
+    assert(node);
+
+    size_t binding = LetTreeFind(let, node);
+
+    if (binding < computed)
+    {
+        fprintf(file, "t%lu", binding);
+        return;
+    }
+
+    switch (node->type)
+    {
+        case NodeArgType::number:    CodeGenerateNumber(file, node->data.num);                           break;
+        case NodeArgType::variable:  fprintf(file, "%s", (node->data.var == Variable::x) ? "x" : "y");  break;
+        case NodeArgType::function:
+        {
+            fprintf(file, "%s(", GetFunctionCode(node->data.func));
+            CodeGenerateNode(file, let, node->left, computed);
+            fprintf(file, ")");
+            break;
+        }
+        case NodeArgType::operation:
+        {
+            if (!node->right)
+            {
+                fprintf(file, "(-");
+                CodeGenerateNode(file, let, node->left, computed);
+                fprintf(file, ")");
+                break;
+            }
+
+            bool isPower = (node->data.oper == Operation::power);
+
+            fprintf(file, "%s", isPower ? "pow(" : "(");
+            CodeGenerateNode(file, let, node->left, computed);
+
+            if (isPower) fprintf(file, ", ");
+            else         fprintf(file, " %s ", GetOperationCode(node->data.oper));
+
+            CodeGenerateNode(file, let, node->right, computed);
+            fprintf(file, ")");
+            break;
+        }
+        case NodeArgType::undefined:
+        default: assert(0 && "undefined node type in code generation.\n"); break;
+    }
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static void CodeGenerateNumber(FILE* file, Number num)
+{
+    assert(file);
+
+    if      (isnan(num)) fprintf(file, "NAN");
+    else if (isinf(num)) fprintf(file, "%sINFINITY", (num < 0) ? "-" : "");
+    else if (num < 0)    fprintf(file, "(%.17g)", num);
+    else                 fprintf(file, "%.17g", num);
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static const char* GetOperationCode(Operation oper)
+{
+    #define GENERATE_OPERATION_CMD(operation, text) case Operation::operation: return text;
+
+    switch (oper)
+    {
+        #include "Operations.h"
+
+        case Operation::power:
+        case Operation::undefined_operation:
+        default: assert(0 && "no C operator for operation.\n"); break;
+    }
+
+    return "";
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static const char* GetFunctionCode(Function func)
+{
+    #define GENERATE_FUNCTION_CMD(function, text) case Function::function: return text;
+
+    switch (func)
+    {
+        #include "Operations.h"
+
+        case Function::undefined_function:
+        default: assert(0 && "no C function for function.\n"); break;
+    }
+
+    return "";
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
@@ -1,7 +1,21 @@
 #ifndef DSL_H
 #define DSL_H
 
+#include <stdio.h>
+#include "../../Tree/Tree.h"
 
+// out[k] = k-th derivative by x in (x, y), k = 0 .. order
+typedef void (*CompiledFunction_t)(double x, double y, double* out);
 
+struct CompiledCode_t
+{
+    void*              library;
+    CompiledFunction_t function;
+    size_t             order;
+};
+
+TreeErr CodeGenerate     (FILE* file, const Tree_t* tree, const char* name, size_t order);
+TreeErr CodeCompile      (const Tree_t* tree, size_t order, CompiledCode_t* code);
+TreeErr CompiledCodeDtor (CompiledCode_t* code);
 
 #endif
@@ -2,8 +2,31 @@
 #define GENERATE_OPERATION_CMD(...)
 #endif
 
+#ifndef GENERATE_FUNCTION_CMD
+#define GENERATE_FUNCTION_CMD(...)
+#endif
+
+// GENERATE_OPERATION_CMD(operation, C operator), power is written as pow() call
+GENERATE_OPERATION_CMD(plus,  "+")
+GENERATE_OPERATION_CMD(minus, "-")
+GENERATE_OPERATION_CMD(mul,   "*")
+GENERATE_OPERATION_CMD(dive,  "/")
+
+// GENERATE_FUNCTION_CMD(function, C function), ctg, actg and ctgh are defined in generated file
+GENERATE_FUNCTION_CMD(Sqrt,   "sqrt")
+GENERATE_FUNCTION_CMD(Ln,     "log")
+GENERATE_FUNCTION_CMD(Sin,    "sin")
+GENERATE_FUNCTION_CMD(Cos,    "cos")
+GENERATE_FUNCTION_CMD(Tg,     "tan")
+GENERATE_FUNCTION_CMD(Ctg,    "ctg")
+GENERATE_FUNCTION_CMD(Sh,     "sinh")
+GENERATE_FUNCTION_CMD(Ch,     "cosh")
+GENERATE_FUNCTION_CMD(Th,     "tanh")
+GENERATE_FUNCTION_CMD(Cth,    "ctgh")
+GENERATE_FUNCTION_CMD(Arcsin, "asin")
+GENERATE_FUNCTION_CMD(Arccos, "acos")
+GENERATE_FUNCTION_CMD(Arctg,  "atan")
+GENERATE_FUNCTION_CMD(Arcctg, "actg")
 
-GENERATE_OPERATION_CMD(plus, 
-{
-    return 
-})
+#undef GENERATE_OPERATION_CMD
+#undef GENERATE_FUNCTION_CMD
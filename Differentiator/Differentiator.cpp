@@ -4,211 +4,470 @@
 #include "Differentiator.h"
 #include "../Tree/Tree.h"
 #include "../Tree/TreeDump.h"
+#include "../Tree/NodeTable.h"
+#include "SimplifyTree.h"
 #include "../Common/ColorPrint.h"
 #include "../Common/GlobalInclude.h"
 
-static TreeErr DiffNode                  (Node_t** node);
-
-static TreeErr HandleDiffNum             (Node_t** node);
-static TreeErr HandleDiffVar             (Node_t** node);
-static TreeErr HandleDiffOperation       (Node_t** node);
-static TreeErr HandleDiffFunction        (Node_t** node);
-
-static TreeErr HandleDiffPlus            (Node_t** node);
-static TreeErr HandleDiffMinus           (Node_t** node);
-static TreeErr HandleDiffMul             (Node_t** node);
-static TreeErr HandleDiffDiv             (Node_t** node);
-static TreeErr HandleDiffPow             (Node_t** node);
-
-static TreeErr HandleDiffFunctionHelper  (Node_t** node);
-static TreeErr HandleDiffLn              (Node_t** node);
-static TreeErr HandleDiffSqrt            (Node_t** node);
-static TreeErr HandleDiffSin             (Node_t** node);
-static TreeErr HandleDiffCos             (Node_t** node);
-static TreeErr HandleDiffTg              (Node_t** node);
-static TreeErr HandleDiffCtg             (Node_t** node);
-static TreeErr HandleDiffSh              (Node_t** node);
-static TreeErr HandleDiffCh              (Node_t** node);
-static TreeErr HandleDiffTh              (Node_t** node);
-static TreeErr HandleDiffCth             (Node_t** node);
-static TreeErr HandleDiffArcsin          (Node_t** node);
-static TreeErr HandleDiffArccos          (Node_t** node);
-static TreeErr HandleDiffArctg           (Node_t** node);
-static TreeErr HandleDiffArcctg          (Node_t** node);
-
-
-static bool IsNodeConst(const Node_t* node);
-
-#define _L (*node)->left
-#define _R (*node)->right
+// state of one Diff call
+struct Diff_t
+{
+    uint32_t  varMask;  // VariableBit of variables, derivative is taken by
+    bool      isDag;    // in dag results are shared; in tree folding eats them, so cache keeps own copies
+    NodeMap_t cache;    // source subtree -> its derivative, equal subtrees are matched by structural hash
+    NodeMap_t copies;   // source node -> its copy in derivative dag
+    NodeMap_t repeated; // tree only: source subtrees, that appear more than once, only they are cached
+};
+
+// in-place Diff takes derivative by every variable, as it always did
+static const uint32_t AllVariables = UINT32_MAX;
+
+
+static TreeErr DiffNode                  (Diff_t* d, const Node_t* node, Node_t** diff);
+
+static TreeErr HandleDiffNum             (const Node_t* node, Node_t** diff);
+static TreeErr HandleDiffVar             (const Node_t* node, Node_t** diff);
+static TreeErr HandleDiffOperation       (Diff_t* d, const Node_t* node, Node_t** diff);
+static TreeErr HandleDiffFunction        (Diff_t* d, const Node_t* node, Node_t** diff);
+
+static TreeErr HandleDiffPlus            (Diff_t* d, const Node_t* node, Node_t** diff);
+static TreeErr HandleDiffMinus           (Diff_t* d, const Node_t* node, Node_t** diff);
+static TreeErr HandleDiffMul             (Diff_t* d, const Node_t* node, Node_t** diff);
+static TreeErr HandleDiffDiv             (Diff_t* d, const Node_t* node, Node_t** diff);
+static TreeErr HandleDiffPow             (Diff_t* d, const Node_t* node, Node_t** diff);
+
+static TreeErr HandleDiffFunctionHelper  (Diff_t* d, const Node_t* node, Node_t** diff);
+static TreeErr HandleDiffLn              (Node_t* arg, Node_t** diff);
+static TreeErr HandleDiffSqrt            (Node_t* arg, Node_t** diff);
+static TreeErr HandleDiffSin             (Node_t* arg, Node_t** diff);
+static TreeErr HandleDiffCos             (Node_t* arg, Node_t** diff);
+static TreeErr HandleDiffTg              (Node_t* arg, Node_t** diff);
+static TreeErr HandleDiffCtg             (Node_t* arg, Node_t** diff);
+static TreeErr HandleDiffSh              (Node_t* arg, Node_t** diff);
+static TreeErr HandleDiffCh              (Node_t* arg, Node_t** diff);
+static TreeErr HandleDiffTh              (Node_t* arg, Node_t** diff);
+static TreeErr HandleDiffCth             (Node_t* arg, Node_t** diff);
+static TreeErr HandleDiffArcsin          (Node_t* arg, Node_t** diff);
+static TreeErr HandleDiffArccos          (Node_t* arg, Node_t** diff);
+static TreeErr HandleDiffArctg           (Node_t* arg, Node_t** diff);
+static TreeErr HandleDiffArcctg          (Node_t* arg, Node_t** diff);
+
+
+static TreeErr DiffRoot                  (const Node_t* root, Node_t** diff, uint32_t varMask, bool isDag);
+static TreeErr DiffCopy                  (Diff_t* d, Node_t** copy, const Node_t* node);
+static TreeErr DiffFindRepeated          (const Node_t* node, NodeMap_t* seen, NodeMap_t* repeated);
+static TreeErr DiffCacheInsert           (Diff_t* d, const Node_t* node, Node_t* diff);
+static bool    IsNodeConst               (const Diff_t* d, const Node_t* node);
+
+#define _L node->left
+#define _R node->right
+
+// rules can fail (e.g. on division by 0 in folded constant), error goes up to caller of Diff
+#define _DIFF(func) do { err = func; RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err); } while (0)
 
 //-------------------------------------------------------------------------------------------------------------------------------------
 
+// derivative is built as new nodes, source tree is only read. Subtrees of source, that derivative needs,
+// are taken with DiffCopy, so in hash-consed dag they are shared instead of being copied.
+// Rules build nodes with _FOLD_* constructors, so 0*g, 1*f', x^(2-1) are reduced before they are created.
+
 TreeErr Diff(Tree_t* tree)
 {
     assert(tree);
 
     TreeErr err = {};
 
-    TREE_ASSERT(DiffNode(&tree->root));
+    Node_t* diff = nullptr;
+
+    NodeArena_t* oldArena = NodeArenaSwitch(&tree->arena);
+
+    err = DiffRoot(tree->root, &diff, AllVariables, tree->arena.unique != nullptr);
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err, NodeArenaSwitch(oldArena));
+
+    TREE_ASSERT(NodeAndUnderTreeDtor(tree->root));
+    NodeArenaSwitch(oldArena);
+
+    tree->root = diff;
 
     return TREE_VERIF(tree, err);    
 }
 
 //-------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr DiffNode(Node_t** node)
+// 'in' isn't changed, so it can be differentiated many times or by many threads at once.
+// other variables are constants. If 'in' is dag, 'out' is dag too.
+TreeErr Diff(const Tree_t* in, Tree_t* out, Variable var)
+{
+    assert(in);
+    assert(in->root);
+    assert(out);
+    assert(!out->root);
+
+    TreeErr err = {};
+
+    if (in->arena.unique && !out->arena.unique)
+    {
+        TREE_ASSERT(DagArenaCtor(&out->arena));
+    }
+
+    NodeArena_t* oldArena = NodeArenaSwitch(&out->arena);
+
+    err = DiffRoot(in->root, &out->root, VariableBit(var), out->arena.unique != nullptr);
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err, NodeArenaSwitch(oldArena));
+
+    NodeArenaSwitch(oldArena);
+
+    return TREE_VERIF(out, err);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr DiffRoot(const Node_t* root, Node_t** diff, uint32_t varMask, bool isDag)
+{
+    assert(root);
+    assert(diff);
+
+    TreeErr err = {};
+
+    Diff_t d = {};
+    d.varMask = varMask;
+    d.isDag   = isDag;
+
+    TREE_ASSERT(NodeCacheCtor(&d.cache,    0));
+    TREE_ASSERT(NodeMapCtor  (&d.copies,   0));
+    TREE_ASSERT(NodeCacheCtor(&d.repeated, 0));
+
+    if (!isDag)
+    {
+        NodeMap_t seen = {};
+        TREE_ASSERT(NodeCacheCtor(&seen, 0));
+        TREE_ASSERT(DiffFindRepeated(root, &seen, &d.repeated));
+        TREE_ASSERT(NodeMapDtor(&seen));
+    }
+
+    // on error half-built derivative stays in arena, it dies with arena
+    TreeErr diffErr = DiffNode(&d, root, diff);
+
+    // in tree cached derivatives are own copies, nobody else points to them
+    for (size_t i = 0; !isDag && i < d.cache.capacity; i++)
+    {
+        if (d.cache.items[i].key) TREE_ASSERT(NodeAndUnderTreeDtor(d.cache.items[i].value));
+    }
+
+    TREE_ASSERT(NodeMapDtor(&d.cache));
+    TREE_ASSERT(NodeMapDtor(&d.copies));
+    TREE_ASSERT(NodeMapDtor(&d.repeated));
+
+    RETURN_IF_TRUE(diffErr.err != TreeErrorType::NO_ERR, diffErr);
+
+    return NODE_VERIF(*diff, err);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------
+
+// marks source subtrees, that appear twice or more: only their derivatives are worth keeping in tree cache.
+// Walk keeps its own stack: long chains like x+x+...+x are deeper, than stack of worker thread
+static TreeErr DiffFindRepeated(const Node_t* node, NodeMap_t* seen, NodeMap_t* repeated)
+{
+    assert(node);
+    assert(seen);
+    assert(repeated);
+
+    TreeErr err = {};
+
+    size_t stackSize     = 0;
+    size_t stackCapacity = 64;
+
+    const Node_t** stack = (const Node_t**) calloc(stackCapacity, sizeof(*stack));
+    RETURN_IF_FALSE(stack, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    stack[stackSize++] = node;
+
+    while (stackSize > 0)
+    {
+        node = stack[--stackSize];
+
+        if (NodeMapContains(seen, node))
+        {
+            TREE_ASSERT(NodeMapInsert(repeated, node, nullptr));
+            continue;
+        }
+
+        TREE_ASSERT(NodeMapInsert(seen, node, nullptr));
+
+        if (stackSize + 2 > stackCapacity)
+        {
+            const Node_t** newStack = (const Node_t**) realloc(stack, 2 * stackCapacity * sizeof(*stack));
+
+            if (!newStack)
+            {
+                err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+                CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+                break;
+            }
+
+            stack          = newStack;
+            stackCapacity *= 2;
+        }
+
+        // right is pushed first, so left subtree is walked first, as before
+        if (node->right) stack[stackSize++] = node->right;
+        if (node->left)  stack[stackSize++] = node->left;
+    }
+
+    FREE(stack);
+
+    return err;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------
+
+// in dag derivative itself is cached. In tree caller gets derivative to fold it into its own node, so cache gets
+// private copy of it, that folding never touches, and every hit copies it again
+static TreeErr DiffCacheInsert(Diff_t* d, const Node_t* node, Node_t* diff)
+{
+    assert(d);
+    assert(node);
+    assert(diff);
+
+    TreeErr err = {};
+
+    if (d->isDag) return NodeMapInsert(&d->cache, node, diff);
+
+    RETURN_IF_FALSE(NodeMapContains(&d->repeated, node), err);
+
+    Node_t* own = nullptr;
+    TREE_ASSERT(NodeCopy(&own, diff));
+
+    return NodeMapInsert(&d->cache, node, own);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------
+
+// copy of source subtree in current arena, every source node is really copied only once
+static TreeErr DiffCopy(Diff_t* d, Node_t** copy, const Node_t* node)
+{
+    assert(d);
+    assert(copy);
+    assert(node);
+
+    // in tree copy is own nodes anyway: copy of source costs as much as copy of earlier copy
+    RETURN_IF_FALSE(d->isDag, NodeCopy(copy, node));
+
+    TreeErr err = {};
+
+    Node_t* known = NodeMapFind(&d->copies, node);
+    RETURN_IF_TRUE(known, NodeCopy(copy, known));
+
+    Node_t* left  = nullptr;
+    Node_t* right = nullptr;
+
+    if (node->left)
+    {
+        TREE_ASSERT(DiffCopy(d, &left, node->left));
+    }
+
+    if (node->right)
+    {
+        TREE_ASSERT(DiffCopy(d, &right, node->right));
+    }
+
+    TREE_ASSERT(NodeCtor(copy, node->type, node->data, left, right));
+    TREE_ASSERT(NodeMapInsert(&d->copies, node, *copy));
+
+    return NODE_VERIF(*copy, err);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr DiffNode(Diff_t* d, const Node_t* node, Node_t** diff)
 {
+    assert(d);
     assert(node);
+    assert(diff);
 
     TreeErr err = {};
 
-    NodeArgType type = (*node)->type;
+    // subtree without variables has zero derivative, it isn't walked at all
+    if (IsNodeConst(d, node))
+    {
+        _NUM(diff, 0);
+        return NODE_VERIF(*diff, err);
+    }
+
+    // repeated subterm takes derivative, that was already built: shared in dag, copied in tree
+    Node_t* known = NodeMapFind(&d->cache, node);
+    RETURN_IF_TRUE(known, NodeCopy(diff, known));
+
+    NodeArgType type = node->type;
 
     switch (type)
     {
-        case NodeArgType::number:    TREE_ASSERT(HandleDiffNum(node));       break;
-        case NodeArgType::variable:  TREE_ASSERT(HandleDiffVar(node));       break;
-        case NodeArgType::operation: TREE_ASSERT(HandleDiffOperation(node)); break;
-        case NodeArgType::function:  TREE_ASSERT(HandleDiffFunction(node));  break;
-        case NodeArgType::undefined: err.err = UNDEFINED_NODE_TYPE;          break;
-        default: assert(0 && "you forgot about some operation.\n");          break;
+        case NodeArgType::number:    _DIFF(HandleDiffNum(node, diff));          break;
+        case NodeArgType::variable:  _DIFF(HandleDiffVar(node, diff));          break;
+        case NodeArgType::operation: _DIFF(HandleDiffOperation(d, node, diff)); break;
+        case NodeArgType::function:  _DIFF(HandleDiffFunction(d, node, diff));  break;
+        case NodeArgType::undefined: err.err = UNDEFINED_NODE_TYPE;                   break;
+        default: assert(0 && "you forgot about some operation.\n");                   break;
     }
-    return NODE_VERIF(*node, err);
+
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    TREE_ASSERT(DiffCacheInsert(d, node, *diff));
+
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffNum(Node_t** node)
+static TreeErr HandleDiffNum(const Node_t* node, Node_t** diff)
 {
     assert(node);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
+    NODE_RETURN_IF_ERR(node, err);
 
-    _SET_NUM(*node, 0);
-    return NODE_VERIF(*node, err);
+    _NUM(diff, 0);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffVar(Node_t** node)
+static TreeErr HandleDiffVar(const Node_t* node, Node_t** diff)
 {
     assert(node);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
+    NODE_RETURN_IF_ERR(node, err);
 
-    _SET_NUM(*node, 1);
+    _NUM(diff, 1);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffOperation(Node_t** node)
+static TreeErr HandleDiffOperation(Diff_t* d, const Node_t* node, Node_t** diff)
 {
     assert(node);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
+    NODE_RETURN_IF_ERR(node, err);
 
-    Operation operation_type = (*node)->data.oper;
+    Operation operation_type = node->data.oper;
 
     switch (operation_type)
     {
-        case Operation::plus:   TREE_ASSERT(HandleDiffPlus(node));                              break;
-        case Operation::minus:  TREE_ASSERT(HandleDiffMinus(node));                             break;
-        case Operation::mul:    TREE_ASSERT(HandleDiffMul(node));                               break;
-        case Operation::dive:   TREE_ASSERT(HandleDiffDiv(node));                               break;
-        case Operation::power:  TREE_ASSERT(HandleDiffPow(node));                               break;
+        case Operation::plus:   _DIFF(HandleDiffPlus(d, node, diff));                     break;
+        case Operation::minus:  _DIFF(HandleDiffMinus(d, node, diff));                    break;
+        case Operation::mul:    _DIFF(HandleDiffMul(d, node, diff));                      break;
+        case Operation::dive:   _DIFF(HandleDiffDiv(d, node, diff));                      break;
+        case Operation::power:  _DIFF(HandleDiffPow(d, node, diff));                      break;
         case Operation::undefined_operation: err.err = TreeErrorType::UNDEFINED_OPERATION_TYPE; break;
         default: assert(0 && "You forgot abour some operation.\n");                             break;
     }
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffPlus(Node_t** node)
+static TreeErr HandleDiffPlus(Diff_t* d, const Node_t* node, Node_t** diff)
 {
     assert(node);
-    assert(*node);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
+    NODE_RETURN_IF_ERR(node, err);
 
-    TREE_ASSERT(DiffNode(&_L));
-    TREE_ASSERT(DiffNode(&_R));
+    Node_t* diff_left  = {};
+    Node_t* diff_right = {};
 
-    return NODE_VERIF(*node, err);
+    _DIFF(DiffNode(d, _L, &diff_left));
+    _DIFF(DiffNode(d, _R, &diff_right));
+
+    _FOLD_ADD(diff, diff_left, diff_right);
+
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffMinus(Node_t** node)
+static TreeErr HandleDiffMinus(Diff_t* d, const Node_t* node, Node_t** diff)
 {
     assert(node);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
+    NODE_RETURN_IF_ERR(node, err);
+
+    Node_t* diff_left  = {};
+    Node_t* diff_right = nullptr;
 
-    TREE_ASSERT(DiffNode(&_L));
+    _DIFF(DiffNode(d, _L, &diff_left));
 
     if (_R)
     {
-        TREE_ASSERT(DiffNode(&_R));
+        _DIFF(DiffNode(d, _R, &diff_right));
     }
 
-    return NODE_VERIF(*node, err);
+    _FOLD_SUB(diff, diff_left, diff_right);
+
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffMul(Node_t** node)
+static TreeErr HandleDiffMul(Diff_t* d, const Node_t* node, Node_t** diff)
 {
     assert(node);
-    assert(*node);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
-
-    _SET_ADD_ONLY(*node);
+    NODE_RETURN_IF_ERR(node, err);
 
     Node_t* diff_left  = {};
     Node_t* diff_right = {};
 
-    TREE_ASSERT(NodeCopy(&diff_left,  _L));
-    TREE_ASSERT(NodeCopy(&diff_right, _R));
+    Node_t* copy_left  = {};
+    Node_t* copy_right = {};
+
+    _DIFF(DiffNode(d, _L, &diff_left));
+    _DIFF(DiffNode(d, _R, &diff_right));
 
-    TREE_ASSERT(DiffNode(&diff_left));
-    TREE_ASSERT(DiffNode(&diff_right));
+    TREE_ASSERT(DiffCopy(d, &copy_left,  _L));
+    TREE_ASSERT(DiffCopy(d, &copy_right, _R));
 
     Node_t* new_left  = {};
     Node_t* new_right = {};
 
 
-    _MUL(&new_left, diff_left, _R);
-    _MUL(&new_right, _L, diff_right);
+    _FOLD_MUL(&new_left,  diff_left, copy_right);
+    _FOLD_MUL(&new_right, copy_left, diff_right);
 
-    _L  = new_left;
-    _R = new_right;
+    _FOLD_ADD(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffDiv(Node_t** node)
+static TreeErr HandleDiffDiv(Diff_t* d, const Node_t* node, Node_t** diff)
 {
     assert(node);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
+    NODE_RETURN_IF_ERR(node, err);
 
 
     Node_t* diff_left  = {};
     Node_t* diff_right = {};
+
+    Node_t* copy_left  = {};
+    Node_t* copy_right = {};
     
     Node_t* new_left  = {};
     Node_t* new_right = {};
@@ -219,44 +478,42 @@ static TreeErr HandleDiffDiv(Node_t** node)
     Node_t* new_right_left  = {};
     Node_t* new_right_right = {};
 
-    _SET_DIV_ONLY(*node);
+    _DIFF(DiffNode(d, _L, &diff_left));
+    _DIFF(DiffNode(d, _R, &diff_right));
 
-    TREE_ASSERT(NodeCopy(&diff_left,  _L));
-    TREE_ASSERT(NodeCopy(&diff_right, _R));
-    TREE_ASSERT(DiffNode(&diff_left));
-    TREE_ASSERT(DiffNode(&diff_right));
+    TREE_ASSERT(DiffCopy(d, &copy_left,  _L));
+    TREE_ASSERT(DiffCopy(d, &copy_right, _R));
     
 
-    TREE_ASSERT(NodeCopy(&new_right_left, _R));
+    TREE_ASSERT(DiffCopy(d, &new_right_left, _R));
     _NUM                (&new_right_right, 2);
 
-    _MUL(&new_left_left,  diff_left,     _R);
-    _MUL(&new_left_right, _L, diff_right);
+    _FOLD_MUL(&new_left_left,  diff_left, copy_right);
+    _FOLD_MUL(&new_left_right, copy_left, diff_right);
 
-    _SUB(&new_left,  new_left_left,  new_left_right);
-    _POW(&new_right, new_right_left, new_right_right);
+    _FOLD_SUB(&new_left,  new_left_left,  new_left_right);
+    _FOLD_POW(&new_right, new_right_left, new_right_right);
 
-    _L  = new_left;
-    _R = new_right;
+    _FOLD_DIV(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffPow(Node_t** node)
+static TreeErr HandleDiffPow(Diff_t* d, const Node_t* node, Node_t** diff)
 {
     assert(node);
-    assert(*node);
+    assert(diff);
     assert(_L);
     assert(_R);
-    assert((*node)->type == NodeArgType::operation);
-    assert((*node)->data.oper == Operation::power);
+    assert(node->type == NodeArgType::operation);
+    assert(node->data.oper == Operation::power);
 
     TreeErr err = {};
-    RETURN_IF_FALSE(*node, err);
+    RETURN_IF_FALSE(node, err);
 
-    if (IsNodeConst(_R))
+    if (IsNodeConst(d, _R))
     {
         Node_t* new_left  = {}; // *
         Node_t* new_right = {}; // (x)'
@@ -271,27 +528,56 @@ static TreeErr HandleDiffPow(Node_t** node)
         Node_t* new_left_right_right_right = {}; // 1
     
 
-        Node_t* number = _R;
-
-        new_left_right_right_left = number;
+        TREE_ASSERT(DiffCopy(d, &new_left_right_right_left, _R));
         _NUM(&new_left_right_right_right, 1);
 
-        new_left_right_left = _L;
-        _SUB(&new_left_right_right, new_left_right_right_left, new_left_right_right_right);
+        TREE_ASSERT(DiffCopy(d, &new_left_right_left, _L));
+        _FOLD_SUB(&new_left_right_right, new_left_right_right_left, new_left_right_right_right);
 
 
-        TREE_ASSERT(NodeCopy(&new_left_left, number));
-        _POW(&new_left_right, new_left_right_left, new_left_right_right);
+        TREE_ASSERT(DiffCopy(d, &new_left_left, _R));
+        _FOLD_POW(&new_left_right, new_left_right_left, new_left_right_right);
 
 
-        TREE_ASSERT(NodeCopy(&new_right, _L));
-        TREE_ASSERT(DiffNode(&new_right));
-        _MUL(&new_left, new_left_left, new_left_right);
+        _DIFF(DiffNode(d, _L, &new_right));
+        _FOLD_MUL(&new_left, new_left_left, new_left_right);
 
 
-        _SET_MUL(*node, new_left, new_right);
+        _FOLD_MUL(diff, new_left, new_right);
 
-        return NODE_VERIF(*node, err);
+        return NODE_VERIF(*diff, err);
+    }
+
+    if (IsNodeConst(d, _L))
+    {
+        Node_t* new_left  = {}; // *
+        Node_t* new_right = {}; // (g)'
+
+        Node_t* new_left_left  = {}; // ^ c g
+        Node_t* new_left_right = {}; // Ln c
+
+        Node_t* new_left_left_left  = {}; // c
+        Node_t* new_left_left_right = {}; // g
+
+        Node_t* new_left_right_left = {}; // c
+
+
+        TREE_ASSERT(DiffCopy(d, &new_left_left_left,  _L));
+        TREE_ASSERT(DiffCopy(d, &new_left_left_right, _R));
+
+        TREE_ASSERT(DiffCopy(d, &new_left_right_left, _L));
+
+        _FOLD_POW(&new_left_left, new_left_left_left, new_left_left_right);
+        _FOLD_FUNC(&new_left_right, Function::Ln, new_left_right_left);
+
+
+        _DIFF(DiffNode(d, _R, &new_right));
+        _FOLD_MUL(&new_left, new_left_left, new_left_right);
+
+
+        _FOLD_MUL(diff, new_left, new_right);
+
+        return NODE_VERIF(*diff, err);
     }
 
     Node_t* new_left  = {}; // ^ f g
@@ -315,97 +601,96 @@ static TreeErr HandleDiffPow(Node_t** node)
     Node_t* new_right_right_right_right = {}; // f
 
 
-    TREE_ASSERT(NodeCopy(&new_right_right_right_left,  _R));
-    TREE_ASSERT(NodeCopy(&new_right_right_right_right, _L));
+    TREE_ASSERT(DiffCopy(d, &new_right_right_right_left,  _R));
+    TREE_ASSERT(DiffCopy(d, &new_right_right_right_right, _L));
 
-    TREE_ASSERT(NodeCopy(&new_right_left_right_left, _L));
+    TREE_ASSERT(DiffCopy(d, &new_right_left_right_left, _L));
 
-    TREE_ASSERT(NodeCopy(&new_right_left_left, _R));
-    TREE_ASSERT(DiffNode(&new_right_left_left));
-    _FUNC(&new_right_left_right, Function::Ln, new_right_left_right_left);
+    _DIFF(DiffNode(d, _R, &new_right_left_left));
+    _FOLD_FUNC(&new_right_left_right, Function::Ln, new_right_left_right_left);
 
-    TREE_ASSERT(NodeCopy(&new_right_right_left, _L));
-    TREE_ASSERT(DiffNode(&new_right_right_left));
-    _DIV(&new_right_right_right, new_right_right_right_left, new_right_right_right_right);
+    _DIFF(DiffNode(d, _L, &new_right_right_left));
+    _FOLD_DIV(&new_right_right_right, new_right_right_right_left, new_right_right_right_right);
 
-    new_left_left  = _L;
-    new_left_right = _R;
+    TREE_ASSERT(DiffCopy(d, &new_left_left,  _L));
+    TREE_ASSERT(DiffCopy(d, &new_left_right, _R));
 
-    _MUL(&new_right_left,  new_right_left_left,  new_right_left_right);
-    _MUL(&new_right_right, new_right_right_left, new_right_right_right);
+    _FOLD_MUL(&new_right_left,  new_right_left_left,  new_right_left_right);
+    _FOLD_MUL(&new_right_right, new_right_right_left, new_right_right_right);
 
-    _POW(&new_left,  new_left_left,  new_left_right);
-    _ADD(&new_right, new_right_left, new_right_right);
+    _FOLD_POW(&new_left,  new_left_left,  new_left_right);
+    _FOLD_ADD(&new_right, new_right_left, new_right_right);
 
-    _SET_MUL(*node,  new_left,        new_right);
+    _FOLD_MUL(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffFunction(Node_t** node)
+static TreeErr HandleDiffFunction(Diff_t* d, const Node_t* node, Node_t** diff)
 {
     assert(node);
-    assert(*node);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
+    NODE_RETURN_IF_ERR(node, err);
 
     Node_t* new_left  = {};
     Node_t* new_right = {};
 
-    TREE_ASSERT(NodeCopy(&new_left, *node));
-    TREE_ASSERT(HandleDiffFunctionHelper(&new_left));
-    TREE_ASSERT(DiffNode(&_L));
-    new_right = _L;
+    _DIFF(HandleDiffFunctionHelper(d, node, &new_left));
+    _DIFF(DiffNode(d, _L, &new_right));
 
-    _SET_MUL(*node, new_left, new_right);
+    _FOLD_MUL(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffFunctionHelper(Node_t** node)
+static TreeErr HandleDiffFunctionHelper(Diff_t* d, const Node_t* node, Node_t** diff)
 {
     assert(node);
-    assert(*node);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
+    NODE_RETURN_IF_ERR(node, err);
 
-    Function function = (*node)->data.func;
+    Function function = node->data.func;
+
+    Node_t* arg = {};
+    TREE_ASSERT(DiffCopy(d, &arg, _L));
 
     switch (function)
     {
-        case Function::Sqrt:     TREE_ASSERT(HandleDiffSqrt  (node));                                break;
-        case Function::Ln:       TREE_ASSERT(HandleDiffLn    (node));                                break;
-        case Function::Sin:      TREE_ASSERT(HandleDiffSin   (node));                                break;
-        case Function::Cos:      TREE_ASSERT(HandleDiffCos   (node));                                break;
-        case Function::Tg:       TREE_ASSERT(HandleDiffTg    (node));                                break;
-        case Function::Ctg:      TREE_ASSERT(HandleDiffCtg   (node));                                break;
-        case Function::Sh:       TREE_ASSERT(HandleDiffSh    (node));                                break;
-        case Function::Ch:       TREE_ASSERT(HandleDiffCh    (node));                                break;
-        case Function::Th:       TREE_ASSERT(HandleDiffTh    (node));                                break;
-        case Function::Cth:      TREE_ASSERT(HandleDiffCth   (node));                                break;
-        case Function::Arcsin:   TREE_ASSERT(HandleDiffArcsin(node));                                break;
-        case Function::Arccos:   TREE_ASSERT(HandleDiffArccos(node));                                break;
-        case Function::Arctg:    TREE_ASSERT(HandleDiffArctg (node));                                break;
-        case Function::Arcctg:   TREE_ASSERT(HandleDiffArcctg(node));                                break;
+        case Function::Sqrt:     _DIFF(HandleDiffSqrt  (arg, diff));                           break;
+        case Function::Ln:       _DIFF(HandleDiffLn    (arg, diff));                           break;
+        case Function::Sin:      _DIFF(HandleDiffSin   (arg, diff));                           break;
+        case Function::Cos:      _DIFF(HandleDiffCos   (arg, diff));                           break;
+        case Function::Tg:       _DIFF(HandleDiffTg    (arg, diff));                           break;
+        case Function::Ctg:      _DIFF(HandleDiffCtg   (arg, diff));                           break;
+        case Function::Sh:       _DIFF(HandleDiffSh    (arg, diff));                           break;
+        case Function::Ch:       _DIFF(HandleDiffCh    (arg, diff));                           break;
+        case Function::Th:       _DIFF(HandleDiffTh    (arg, diff));                           break;
+        case Function::Cth:      _DIFF(HandleDiffCth   (arg, diff));                           break;
+        case Function::Arcsin:   _DIFF(HandleDiffArcsin(arg, diff));                           break;
+        case Function::Arccos:   _DIFF(HandleDiffArccos(arg, diff));                           break;
+        case Function::Arctg:    _DIFF(HandleDiffArctg (arg, diff));                           break;
+        case Function::Arcctg:   _DIFF(HandleDiffArcctg(arg, diff));                           break;
         case Function::undefined_function: err.err = UNDEFINED_FUNCTION_TYPE;                        break;
         default: assert(0 && "You forgpt about some function.\n");                                   break;
     }
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffLn(Node_t** node)
+static TreeErr HandleDiffLn(Node_t* arg, Node_t** diff)
 {
-    assert(node);
-    assert(*node);
+    assert(arg);
+    assert(diff);
 
     TreeErr err = {};
 
@@ -413,19 +698,19 @@ static TreeErr HandleDiffLn(Node_t** node)
     Node_t* new_right = {};
 
     _NUM(&new_left, 1);
-    new_right = _L;
+    new_right = arg;
 
-    _SET_DIV(*node, new_left, new_right);
+    _FOLD_DIV(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffSqrt(Node_t** node)
+static TreeErr HandleDiffSqrt(Node_t* arg, Node_t** diff)
 {
-    assert(node);
-    assert(*node);
+    assert(arg);
+    assert(diff);
 
     TreeErr err = {};
 
@@ -438,42 +723,41 @@ static TreeErr HandleDiffSqrt(Node_t** node)
     Node_t* new_right_right_left  = {}; // x
 
 
-    new_right_right_left = _L;
+    new_right_right_left = arg;
 
-    _NUM  (&new_right_left,  2);
-    _FUNC (&new_right_right, Function::Sqrt, new_right_right_left);
+    _NUM      (&new_right_left,  2);
+    _FOLD_FUNC(&new_right_right, Function::Sqrt, new_right_right_left);
 
     _NUM(&new_left, 1);
-    _MUL(&new_right, new_right_left, new_right_right);
+    _FOLD_MUL(&new_right, new_right_left, new_right_right);
 
-    _SET_DIV(*node, new_left, new_right);
+    _FOLD_DIV(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffSin(Node_t** node)
+static TreeErr HandleDiffSin(Node_t* arg, Node_t** diff)
 {
-    assert(node);
-    assert(*node);
+    assert(arg);
+    assert(diff);
 
     TreeErr err = {};
 
-    _SET_FUNC_ONLY(*node, Function::Cos);
+    _FOLD_FUNC(diff, Function::Cos, arg);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffCos(Node_t** node)
+static TreeErr HandleDiffCos(Node_t* arg, Node_t** diff)
 {
-    assert(node);
-    assert(*node);
+    assert(arg);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
 
     Node_t* new_left  = {};
     Node_t* new_right = {};
@@ -482,24 +766,23 @@ static TreeErr HandleDiffCos(Node_t** node)
 
     Node_t* new_left_left  = {};
 
-    new_left_left  = _L;
+    new_left_left  = arg;
 
-    _FUNC(&new_left, Function::Sin, new_left_left);
+    _FOLD_FUNC(&new_left, Function::Sin, new_left_left);
 
-    _SET_SUB(*node, new_left, new_right);
+    _FOLD_SUB(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffTg(Node_t** node)
+static TreeErr HandleDiffTg(Node_t* arg, Node_t** diff)
 {
-    assert(node);
-    assert(*node);
+    assert(arg);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
 
     Node_t* new_left  = {};
     Node_t* new_right = {};
@@ -509,28 +792,27 @@ static TreeErr HandleDiffTg(Node_t** node)
 
     Node_t* new_right_left_left  = {};
 
-    new_right_left_left = _L;
+    new_right_left_left = arg;
 
-    _FUNC(&new_right_left, Function::Cos, new_right_left_left);
+    _FOLD_FUNC(&new_right_left, Function::Cos, new_right_left_left);
     _NUM(&new_right_right, 2);
 
     _NUM(&new_left, 1);
-    _POW(&new_right, new_right_left, new_right_right);
+    _FOLD_POW(&new_right, new_right_left, new_right_right);
 
-    _SET_DIV(*node, new_left, new_right);
+    _FOLD_DIV(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffCtg(Node_t** node)
+static TreeErr HandleDiffCtg(Node_t* arg, Node_t** diff)
 {
-    assert(node);
-    assert(*node);
+    assert(arg);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
 
     Node_t* new_left  = {};
     Node_t* new_right = {};
@@ -544,55 +826,54 @@ static TreeErr HandleDiffCtg(Node_t** node)
 
     _NUM(&new_left_left_left, 1);
 
-    new_right_left_left = _L;
-    _FUNC(&new_right_left, Function::Sin, new_right_left_left);
+    new_right_left_left = arg;
+    _FOLD_FUNC(&new_right_left, Function::Sin, new_right_left_left);
     _NUM(&new_right_right, 2);
 
-    _SUB(&new_left,  new_left_left_left, nullptr);
-    _POW(&new_right, new_right_left,     new_right_right);
+    _FOLD_SUB(&new_left,  new_left_left_left, nullptr);
+    _FOLD_POW(&new_right, new_right_left,     new_right_right);
 
-    _SET_DIV(*node, new_left, new_right);
+    _FOLD_DIV(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffSh(Node_t** node)
+static TreeErr HandleDiffSh(Node_t* arg, Node_t** diff)
 {
-    assert(node);
-    assert(*node);
+    assert(arg);
+    assert(diff);
 
     TreeErr err = {};
 
-    _SET_FUNC_ONLY(*node, Function::Ch);
+    _FOLD_FUNC(diff, Function::Ch, arg);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffCh(Node_t** node)
+static TreeErr HandleDiffCh(Node_t* arg, Node_t** diff)
 {
-    assert(node);
-    assert(*node);
+    assert(arg);
+    assert(diff);
 
     TreeErr err = {};
 
-    _SET_FUNC_ONLY(*node, Function::Sh);
+    _FOLD_FUNC(diff, Function::Sh, arg);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffTh(Node_t** node)
+static TreeErr HandleDiffTh(Node_t* arg, Node_t** diff)
 {
-    assert(node);
-    assert(*node);
+    assert(arg);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
 
     Node_t* new_left  = {};
     Node_t* new_right = {};
@@ -602,28 +883,27 @@ static TreeErr HandleDiffTh(Node_t** node)
 
     Node_t* new_right_left_left  = {};
 
-    new_right_left_left = _L;
+    new_right_left_left = arg;
 
-    _FUNC(&new_right_left, Function::Ch, new_right_left_left);
+    _FOLD_FUNC(&new_right_left, Function::Ch, new_right_left_left);
     _NUM(&new_right_right, 2);
 
     _NUM(&new_left, 1);
-    _POW(&new_right, new_right_left, new_right_right);
+    _FOLD_POW(&new_right, new_right_left, new_right_right);
 
-    _SET_DIV(*node, new_left, new_right);
+    _FOLD_DIV(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffCth(Node_t** node)
+static TreeErr HandleDiffCth(Node_t* arg, Node_t** diff)
 {
-    assert(node);
-    assert(*node);
+    assert(arg);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
 
     Node_t* new_left  = {};
     Node_t* new_right = {};
@@ -633,28 +913,27 @@ static TreeErr HandleDiffCth(Node_t** node)
 
     Node_t* new_right_left_left  = {};
 
-    new_right_left_left = _L;
+    new_right_left_left = arg;
 
-    _FUNC(&new_right_left, Function::Sh, new_right_left_left);
+    _FOLD_FUNC(&new_right_left, Function::Sh, new_right_left_left);
     _NUM(&new_right_right, 2);
 
     _NUM(&new_left, 1);
-    _POW(&new_right, new_right_left, new_right_right);
+    _FOLD_POW(&new_right, new_right_left, new_right_right);
 
-    _SET_DIV(*node, new_left, new_right);
+    _FOLD_DIV(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffArcsin(Node_t** node)
+static TreeErr HandleDiffArcsin(Node_t* arg, Node_t** diff)
 {
-    assert(node);
-    assert(*node);
+    assert(arg);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
 
     Node_t* new_left  = {}; // 1
     Node_t* new_right = {}; // Sqrt (  - )
@@ -668,31 +947,30 @@ static TreeErr HandleDiffArcsin(Node_t** node)
     Node_t* new_right_left_right_right = {}; // 2
 
 
-    new_right_left_right_left = _L;
+    new_right_left_right_left = arg;
     _NUM(&new_right_left_right_right, 2);
 
     _NUM(&new_right_left_left, 1);
-    _POW(&new_right_left_right, new_right_left_right_left, new_right_left_right_right);
+    _FOLD_POW(&new_right_left_right, new_right_left_right_left, new_right_left_right_right);
 
-    _SUB(&new_right_left, new_right_left_left, new_right_left_right);
+    _FOLD_SUB(&new_right_left, new_right_left_left, new_right_left_right);
 
     _NUM(&new_left, 1);
-    _FUNC(&new_right, Function::Sqrt, new_right_left);
+    _FOLD_FUNC(&new_right, Function::Sqrt, new_right_left);
 
-    _SET_DIV(*node, new_left, new_right);
+    _FOLD_DIV(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffArccos(Node_t** node)
+static TreeErr HandleDiffArccos(Node_t* arg, Node_t** diff)
 {
-    assert(node);
-    assert(*node);
+    assert(arg);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
 
     Node_t* new_left  = {}; // - ( 1 )
     Node_t* new_right = {}; // Sqrt (  - )
@@ -708,32 +986,31 @@ static TreeErr HandleDiffArccos(Node_t** node)
     Node_t* new_right_left_right_right = {}; // 2
 
 
-    new_right_left_right_left = _L;
+    new_right_left_right_left = arg;
     _NUM(&new_right_left_right_right, 2);
 
     _NUM(&new_right_left_left, 1);
-    _POW(&new_right_left_right, new_right_left_right_left, new_right_left_right_right);
+    _FOLD_POW(&new_right_left_right, new_right_left_right_left, new_right_left_right_right);
 
     _NUM(&new_left_left, 1);
-    _SUB(&new_right_left, new_right_left_left, new_right_left_right);
+    _FOLD_SUB(&new_right_left, new_right_left_left, new_right_left_right);
 
-    _SUB(&new_left, new_left_left, nullptr);
-    _FUNC(&new_right, Function::Sqrt, new_right_left);
+    _FOLD_SUB(&new_left, new_left_left, nullptr);
+    _FOLD_FUNC(&new_right, Function::Sqrt, new_right_left);
 
-    _SET_DIV(*node, new_left, new_right);
+    _FOLD_DIV(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffArctg(Node_t** node)
+static TreeErr HandleDiffArctg(Node_t* arg, Node_t** diff)
 {
-    assert(node);
-    assert(*node);
+    assert(arg);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
 
     Node_t* new_left  = {}; // 1
     Node_t* new_right = {}; // +
@@ -745,29 +1022,28 @@ static TreeErr HandleDiffArctg(Node_t** node)
     Node_t* new_right_right_right = {}; // 2
 
 
-    new_right_right_left = _L;
+    new_right_right_left = arg;
     _NUM(&new_right_right_right, 2);
 
     _NUM(&new_right_left, 1);
-    _POW(&new_right_right, new_right_right_left, new_right_right_right);
+    _FOLD_POW(&new_right_right, new_right_right_left, new_right_right_right);
 
     _NUM(&new_left, 1);
-    _ADD(&new_right, new_right_left, new_right_right);
+    _FOLD_ADD(&new_right, new_right_left, new_right_right);
 
-    _SET_DIV(*node, new_left, new_right);
+    _FOLD_DIV(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr HandleDiffArcctg(Node_t** node)
+static TreeErr HandleDiffArcctg(Node_t* arg, Node_t** diff)
 {
-    assert(node);
-    assert(*node);
+    assert(arg);
+    assert(diff);
 
     TreeErr err = {};
-    NODE_RETURN_IF_ERR(*node, err);
 
     Node_t* new_left  = {}; // - ( 1 )
     Node_t* new_right = {}; // +
@@ -781,43 +1057,33 @@ static TreeErr HandleDiffArcctg(Node_t** node)
     Node_t* new_right_right_right = {}; // 2
 
 
-    new_right_right_left = _L;
+    new_right_right_left = arg;
     _NUM(&new_right_right_right, 2);
 
     _NUM(&new_left_left, 1);
 
     _NUM(&new_right_left, 1);
-    _POW(&new_right_right, new_right_right_left, new_right_right_right);
+    _FOLD_POW(&new_right_right, new_right_right_left, new_right_right_right);
 
-    _SUB(&new_left, new_left_left, nullptr);
-    _ADD(&new_right, new_right_left, new_right_right);
+    _FOLD_SUB(&new_left, new_left_left, nullptr);
+    _FOLD_ADD(&new_right, new_right_left, new_right_right);
 
-    _SET_DIV(*node, new_left, new_right);
+    _FOLD_DIV(diff, new_left, new_right);
 
-    return NODE_VERIF(*node, err);
+    return NODE_VERIF(*diff, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------
 
-static bool IsNodeConst(const Node_t* node)
+static bool IsNodeConst(const Diff_t* d, const Node_t* node)
 {
+    assert(d);
     assert(node);
 
-    if (node->type == NodeArgType::variable) return false;
-
-    if (node->left)
-    {
-        RETURN_IF_FALSE(IsNodeConst(node->left), false);
-    }
-
-    if (node->right)
-    {
-        RETURN_IF_FALSE(IsNodeConst(node->right), false);
-    }
-
-    return true;
+    return (node->varMask & d->varMask) == 0;
 }
 
 
 #undef _L
 #undef _R
+#undef _DIFF
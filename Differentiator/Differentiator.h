@@ -4,5 +4,6 @@
 #include "../Tree/Tree.h" 
 
 TreeErr Diff(Tree_t* tree);
+TreeErr Diff(const Tree_t* in, Tree_t* out, Variable var);
 
 #endif
@@ -0,0 +1,1200 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <time.h>
+#include "EGraph.h"
+#include "SimplifyTree.h"
+#include "MathFunctions.h"
+#include "../Tree/Tree.h"
+#include "../Tree/NodeTable.h"
+#include "../Common/GlobalInclude.h"
+
+
+typedef uint32_t EClassId_t;
+
+static const EClassId_t EClassNull = UINT32_MAX;
+
+// node of e-graph: children are classes of equal subtrees, not nodes.
+// enode i is created together with class i, so class of enode i is EGraphFind(i)
+struct ENode_t
+{
+    NodeArgType type;
+    NodeData_t  data;
+    EClassId_t  left;
+    EClassId_t  right;
+};
+
+struct EUnion_t
+{
+    EClassId_t first;
+    EClassId_t second;
+};
+
+struct EGraph_t
+{
+    ENode_t*    nodes;
+    EClassId_t* parent;         // union-find over classes
+    bool*       isConst;        // class has number in it, is valid only for root of class
+    Number*     value;
+    size_t      size;
+    size_t      capacity;
+
+    EClassId_t* table;          // hashcons: enode with canonical children -> its id
+    size_t      tableSize;
+    size_t      tableCapacity;
+
+    size_t*     memberStart;    // classes at start of iteration: enodes of class c are members[memberStart[c] .. memberStart[c + 1])
+    EClassId_t* members;
+    size_t      snapshotSize;
+
+    EUnion_t*   unions;         // unions, that rules find, are made after iteration, so classes don't change while matching
+    size_t      unionsSize;
+    size_t      unionsCapacity;
+};
+
+const EGraphBudget_t EGraphDefaultBudget = {10000, 30, 0.5, EGraphCostModel::node_count};
+
+
+static TreeErr    EGraphCtor          (EGraph_t* g);
+static TreeErr    EGraphDtor          (EGraph_t* g);
+static TreeErr    EGraphReserve       (EGraph_t* g, size_t capacity);
+static TreeErr    EGraphLoad          (EGraph_t* g, const Node_t* node, EClassId_t* cls);
+static TreeErr    EGraphAdd           (EGraph_t* g, NodeArgType type, NodeData_t data, EClassId_t left, EClassId_t right, EClassId_t* cls);
+static EClassId_t EGraphFind          (EGraph_t* g, EClassId_t cls);
+static bool       EGraphUnion         (EGraph_t* g, EClassId_t first, EClassId_t second);
+static TreeErr    EGraphEqual         (EGraph_t* g, EClassId_t first, EClassId_t second);
+static TreeErr    EGraphRebuild       (EGraph_t* g, bool* changed);
+static TreeErr    EGraphSnapshot      (EGraph_t* g);
+static TreeErr    EGraphExtract       (EGraph_t* g, EClassId_t root, EGraphCostModel model, bool shared, Node_t** node);
+static TreeErr    EGraphBuild         (EGraph_t* g, const EClassId_t* best, Node_t** built, EClassId_t cls, Node_t** node);
+static double     ENodeCost           (const ENode_t* enode, EGraphCostModel model);
+
+static TreeErr    EGraphTableRehash   (EGraph_t* g, size_t capacity);
+static TreeErr    EGraphTableInsert   (EGraph_t* g, EClassId_t id);
+static EClassId_t EGraphTableFind     (const EGraph_t* g, NodeArgType type, NodeData_t data, EClassId_t left, EClassId_t right);
+static size_t     ENodeHash           (NodeArgType type, NodeData_t data, EClassId_t left, EClassId_t right);
+
+static TreeErr    EGraphApplyRules    (EGraph_t* g, EClassId_t id);
+static TreeErr    EGraphFold          (EGraph_t* g, const ENode_t* enode, EClassId_t cls);
+static TreeErr    EGraphRulesPlus     (EGraph_t* g, EClassId_t cls, EClassId_t left, EClassId_t right);
+static TreeErr    EGraphRulesMinus    (EGraph_t* g, EClassId_t cls, EClassId_t left, EClassId_t right);
+static TreeErr    EGraphRulesNeg      (EGraph_t* g, EClassId_t cls, EClassId_t arg);
+static TreeErr    EGraphRulesMul      (EGraph_t* g, EClassId_t cls, EClassId_t left, EClassId_t right);
+static TreeErr    EGraphRulesDiv      (EGraph_t* g, EClassId_t cls, EClassId_t left, EClassId_t right);
+static TreeErr    EGraphRulesPow      (EGraph_t* g, EClassId_t cls, EClassId_t left, EClassId_t right);
+
+static TreeErr    EGraphAddNum        (EGraph_t* g, Number num, EClassId_t* cls);
+static TreeErr    EGraphAddOper       (EGraph_t* g, Operation oper, EClassId_t left, EClassId_t right, EClassId_t* cls);
+static TreeErr    EGraphAddFunc       (EGraph_t* g, Function func, EClassId_t arg, EClassId_t* cls);
+static TreeErr    EGraphEqualNum      (EGraph_t* g, EClassId_t cls, Number num);
+static TreeErr    EGraphEqualOper     (EGraph_t* g, EClassId_t cls, Operation oper, EClassId_t left, EClassId_t right);
+
+static const EClassId_t* EGraphMembers(EGraph_t* g, EClassId_t cls, size_t* count);
+static bool       IsClassNum          (EGraph_t* g, EClassId_t cls, Number num);
+static bool       IsENodeOper         (const ENode_t* enode, Operation oper);
+static bool       IsENodeNeg          (const ENode_t* enode);
+static EClassId_t FuncArgOf           (EGraph_t* g, EClassId_t cls, Function func);
+static EClassId_t SquareArgOf         (EGraph_t* g, EClassId_t cls, Function func);
+
+static const Number eps = 0.0000000001;
+
+#define _ADD_OPER(cls, oper, left, right) TREE_ASSERT(EGraphAddOper(g, Operation::oper, left, right, cls))
+#define _ADD_NUM( cls, num              ) TREE_ASSERT(EGraphAddNum (g, num, cls))
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// tree is loaded to e-graph, rules add equal forms of every class until nothing new appears or budget ends,
+// then the cheapest tree is taken from class of root. Rules of SimplifyTree are part of rules here.
+TreeErr EGraphSimplify(Tree_t* tree, const EGraphBudget_t* budget)
+{
+    assert(tree);
+    assert(tree->root);
+
+    TreeErr err = {};
+
+    if (!budget) budget = &EGraphDefaultBudget;
+
+    EGraph_t g = {};
+    TREE_ASSERT(EGraphCtor(&g));
+
+    EClassId_t root = EClassNull;
+    TREE_ASSERT(EGraphLoad(&g, tree->root, &root));
+
+    bool changed = false;
+    TREE_ASSERT(EGraphRebuild(&g, &changed));
+
+    clock_t start = clock();
+
+    for (size_t iteration = 0; iteration < budget->maxIterations; iteration++)
+    {
+        size_t before = g.size;
+
+        for (size_t i = 0; i < before && g.size < budget->maxNodes; i++)
+        {
+            TREE_ASSERT(EGraphApplyRules(&g, (EClassId_t) i));
+        }
+
+        changed = false;
+        TREE_ASSERT(EGraphRebuild(&g, &changed));
+
+        if (!changed && g.size == before)                                          break;
+        if (g.size >= budget->maxNodes)                                            break;
+        if ((double) (clock() - start) / CLOCKS_PER_SEC > budget->maxSeconds)      break;
+    }
+
+    NodeArena_t* oldArena = NodeArenaSwitch(&tree->arena);
+
+    Node_t* simple = nullptr;
+    TREE_ASSERT(EGraphExtract(&g, root, budget->cost, tree->arena.unique != nullptr, &simple));
+    TREE_ASSERT(NodeAndUnderTreeDtor(tree->root));
+    tree->root = simple;
+
+    NodeArenaSwitch(oldArena);
+
+    TREE_ASSERT(EGraphDtor(&g));
+
+    return TREE_VERIF(tree, err);
+}
+
+//============================== E-graph ===============================================================================================
+
+static TreeErr EGraphCtor(EGraph_t* g)
+{
+    assert(g);
+
+    TreeErr err = {};
+
+    *g = {};
+
+    TREE_ASSERT(EGraphReserve(g, 64));
+    TREE_ASSERT(EGraphTableRehash(g, 128));
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr EGraphDtor(EGraph_t* g)
+{
+    assert(g);
+
+    TreeErr err = {};
+
+    FREE(g->nodes);
+    FREE(g->parent);
+    FREE(g->isConst);
+    FREE(g->value);
+    FREE(g->table);
+    FREE(g->memberStart);
+    FREE(g->members);
+    FREE(g->unions);
+
+    *g = {};
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr EGraphReserve(EGraph_t* g, size_t capacity)
+{
+    assert(g);
+    assert(capacity >= g->size);
+    assert(capacity <  EClassNull);
+
+    TreeErr err = {};
+
+    ENode_t*    nodes   = (ENode_t*)    realloc(g->nodes,   capacity * sizeof(ENode_t));
+    if (nodes)   g->nodes   = nodes;
+
+    EClassId_t* parent  = (EClassId_t*) realloc(g->parent,  capacity * sizeof(EClassId_t));
+    if (parent)  g->parent  = parent;
+
+    bool*       isConst = (bool*)       realloc(g->isConst, capacity * sizeof(bool));
+    if (isConst) g->isConst = isConst;
+
+    Number*     value   = (Number*)     realloc(g->value,   capacity * sizeof(Number));
+    if (value)   g->value   = value;
+
+    RETURN_IF_FALSE(nodes && parent && isConst && value, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    g->capacity = capacity;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr EGraphLoad(EGraph_t* g, const Node_t* node, EClassId_t* cls)
+{
+    assert(g);
+    assert(node);
+    assert(cls);
+
+    TreeErr err = {};
+    NODE_RETURN_IF_ERR(node, err);
+
+    EClassId_t left  = EClassNull;
+    EClassId_t right = EClassNull;
+
+    if (node->left)
+    {
+        TREE_ASSERT(EGraphLoad(g, node->left, &left));
+    }
+
+    if (node->right)
+    {
+        TREE_ASSERT(EGraphLoad(g, node->right, &right));
+    }
+
+    return EGraphAdd(g, node->type, node->data, left, right, cls);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// enode, that already is in e-graph, isn't added twice: class of existing one is returned
+static TreeErr EGraphAdd(EGraph_t* g, NodeArgType type, NodeData_t data, EClassId_t left, EClassId_t right, EClassId_t* cls)
+{
+    assert(g);
+    assert(cls);
+
+    TreeErr err = {};
+
+    if (left  != EClassNull) left  = EGraphFind(g, left);
+    if (right != EClassNull) right = EGraphFind(g, right);
+
+    EClassId_t known = EGraphTableFind(g, type, data, left, right);
+    RETURN_IF_TRUE(known != EClassNull, err, *cls = EGraphFind(g, known));
+
+    if (g->size == g->capacity)
+    {
+        TREE_ASSERT(EGraphReserve(g, 2 * g->capacity));
+    }
+
+    EClassId_t id = (EClassId_t) g->size;
+
+    g->nodes  [id] = {type, data, left, right};
+    g->parent [id] = id;
+    g->isConst[id] = (type == NodeArgType::number);
+    g->value  [id] = (type == NodeArgType::number) ? data.num : 0;
+    g->size++;
+
+    TREE_ASSERT(EGraphTableInsert(g, id));
+
+    *cls = id;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static EClassId_t EGraphFind(EGraph_t* g, EClassId_t cls)
+{
+    assert(g);
+    assert(cls < g->size);
+
+    while (g->parent[cls] != cls)
+    {
+        g->parent[cls] = g->parent[g->parent[cls]];
+        cls            = g->parent[cls];
+    }
+
+    return cls;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool EGraphUnion(EGraph_t* g, EClassId_t first, EClassId_t second)
+{
+    assert(g);
+
+    first  = EGraphFind(g, first);
+    second = EGraphFind(g, second);
+
+    RETURN_IF_TRUE(first == second, false);
+
+    if (second < first)
+    {
+        EClassId_t temp = first;
+        first  = second;
+        second = temp;
+    }
+
+    g->parent[second] = first;
+
+    if (!g->isConst[first] && g->isConst[second])
+    {
+        g->isConst[first] = true;
+        g->value  [first] = g->value[second];
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// rule found, that classes are equal; union is made in EGraphRebuild
+static TreeErr EGraphEqual(EGraph_t* g, EClassId_t first, EClassId_t second)
+{
+    assert(g);
+
+    TreeErr err = {};
+
+    RETURN_IF_TRUE(EGraphFind(g, first) == EGraphFind(g, second), err);
+
+    if (g->unionsSize == g->unionsCapacity)
+    {
+        size_t    capacity = g->unionsCapacity ? 2 * g->unionsCapacity : 64;
+        EUnion_t* unions   = (EUnion_t*) realloc(g->unions, capacity * sizeof(EUnion_t));
+
+        RETURN_IF_FALSE(unions, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+        g->unions         = unions;
+        g->unionsCapacity = capacity;
+    }
+
+    g->unions[g->unionsSize++] = {first, second};
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// after unions enodes f(a) and f(b) with a == b become equal: hashcons is built again and such enodes
+// are united too, until there is nothing to unite (congruence closure)
+static TreeErr EGraphRebuild(EGraph_t* g, bool* changed)
+{
+    assert(g);
+    assert(changed);
+
+    TreeErr err = {};
+
+    for (size_t i = 0; i < g->unionsSize; i++)
+    {
+        if (EGraphUnion(g, g->unions[i].first, g->unions[i].second)) *changed = true;
+    }
+
+    g->unionsSize = 0;
+
+    bool again = true;
+
+    while (again)
+    {
+        again = false;
+
+        size_t capacity = g->tableCapacity;
+        while (capacity < 2 * g->size) capacity *= 2;
+
+        g->tableCapacity = capacity;
+        EClassId_t* table = (EClassId_t*) realloc(g->table, capacity * sizeof(EClassId_t));
+        RETURN_IF_FALSE(table, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+        g->table     = table;
+        g->tableSize = 0;
+        memset(g->table, 0xff, capacity * sizeof(EClassId_t));
+
+        for (size_t i = 0; i < g->size; i++)
+        {
+            ENode_t* enode = &g->nodes[i];
+
+            if (enode->left  != EClassNull) enode->left  = EGraphFind(g, enode->left);
+            if (enode->right != EClassNull) enode->right = EGraphFind(g, enode->right);
+
+            EClassId_t same = EGraphTableFind(g, enode->type, enode->data, enode->left, enode->right);
+
+            if (same == EClassNull)
+            {
+                TREE_ASSERT(EGraphTableInsert(g, (EClassId_t) i));
+            }
+
+            else if (EGraphUnion(g, same, (EClassId_t) i))
+            {
+                again    = true;
+                *changed = true;
+            }
+        }
+    }
+
+    return EGraphSnapshot(g);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// enodes are grouped by class with counting sort, rules read classes only from this snapshot
+static TreeErr EGraphSnapshot(EGraph_t* g)
+{
+    assert(g);
+
+    TreeErr err = {};
+
+    FREE(g->memberStart);
+    FREE(g->members);
+
+    g->memberStart  = (size_t*)     calloc(g->size + 1, sizeof(size_t));
+    g->members      = (EClassId_t*) calloc(g->size + 1, sizeof(EClassId_t));
+    size_t* fill    = (size_t*)     calloc(g->size + 1, sizeof(size_t));
+
+    if (!g->memberStart || !g->members || !fill)
+    {
+        FREE(fill);
+        err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    for (size_t i = 0; i < g->size; i++) g->memberStart[EGraphFind(g, (EClassId_t) i) + 1]++;
+    for (size_t i = 0; i < g->size; i++) g->memberStart[i + 1] += g->memberStart[i];
+
+    memcpy(fill, g->memberStart, (g->size + 1) * sizeof(size_t));
+
+    for (size_t i = 0; i < g->size; i++) g->members[fill[EGraphFind(g, (EClassId_t) i)]++] = (EClassId_t) i;
+
+    FREE(fill);
+
+    g->snapshotSize = g->size;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static const EClassId_t* EGraphMembers(EGraph_t* g, EClassId_t cls, size_t* count)
+{
+    assert(g);
+    assert(count);
+
+    cls = EGraphFind(g, cls);
+
+    if (cls >= g->snapshotSize)
+    {
+        *count = 0;
+        return g->members;
+    }
+
+    *count = g->memberStart[cls + 1] - g->memberStart[cls];
+    return g->members + g->memberStart[cls];
+}
+
+//============================== Hashcons ==============================================================================================
+
+static TreeErr EGraphTableRehash(EGraph_t* g, size_t capacity)
+{
+    assert(g);
+
+    TreeErr err = {};
+
+    EClassId_t* table = (EClassId_t*) realloc(g->table, capacity * sizeof(EClassId_t));
+    RETURN_IF_FALSE(table, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    g->table         = table;
+    g->tableCapacity = capacity;
+    g->tableSize     = 0;
+
+    memset(g->table, 0xff, capacity * sizeof(EClassId_t));
+
+    for (size_t i = 0; i < g->size; i++)
+    {
+        const ENode_t* enode = &g->nodes[i];
+        if (EGraphTableFind(g, enode->type, enode->data, enode->left, enode->right) != EClassNull) continue;
+
+        TREE_ASSERT(EGraphTableInsert(g, (EClassId_t) i));
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr EGraphTableInsert(EGraph_t* g, EClassId_t id)
+{
+    assert(g);
+    assert(id < g->size);
+
+    // rehash puts all enodes, 'id' too
+    RETURN_IF_TRUE(2 * (g->tableSize + 1) > g->tableCapacity, EGraphTableRehash(g, 2 * g->tableCapacity));
+
+    TreeErr err = {};
+
+    const ENode_t* enode = &g->nodes[id];
+
+    size_t mask = g->tableCapacity - 1;
+    size_t pos  = ENodeHash(enode->type, enode->data, enode->left, enode->right) & mask;
+
+    while (g->table[pos] != EClassNull) pos = (pos + 1) & mask;
+
+    g->table[pos] = id;
+    g->tableSize++;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static EClassId_t EGraphTableFind(const EGraph_t* g, NodeArgType type, NodeData_t data, EClassId_t left, EClassId_t right)
+{
+    assert(g);
+
+    size_t mask = g->tableCapacity - 1;
+    size_t pos  = ENodeHash(type, data, left, right) & mask;
+
+    while (g->table[pos] != EClassNull)
+    {
+        const ENode_t* enode = &g->nodes[g->table[pos]];
+
+        if (enode->type == type && enode->left == left && enode->right == right && NodeDataEqual(type, enode->data, data))
+        {
+            return g->table[pos];
+        }
+
+        pos = (pos + 1) & mask;
+    }
+
+    return EClassNull;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static size_t ENodeHash(NodeArgType type, NodeData_t data, EClassId_t left, EClassId_t right)
+{
+    size_t hash = NodeHash(type, data, nullptr, nullptr);
+
+    hash = (hash ^ left)  * 0x100000001b3ULL;
+    hash = (hash ^ right) * 0x100000001b3ULL;
+
+    return hash ^ (hash >> 29);
+}
+
+//============================== Rules =================================================================================================
+
+static TreeErr EGraphApplyRules(EGraph_t* g, EClassId_t id)
+{
+    assert(g);
+
+    TreeErr err = {};
+
+    // enode is copied: adding of new enodes can move array
+    ENode_t    enode = g->nodes[id];
+    EClassId_t cls   = EGraphFind(g, id);
+
+    RETURN_IF_TRUE(enode.type != NodeArgType::operation && enode.type != NodeArgType::function, err);
+
+    TREE_ASSERT(EGraphFold(g, &enode, cls));
+
+    RETURN_IF_TRUE(enode.type == NodeArgType::function, err);
+
+    EClassId_t left  = EGraphFind(g, enode.left);
+    EClassId_t right = (enode.right == EClassNull) ? EClassNull : EGraphFind(g, enode.right);
+
+    switch (enode.data.oper)
+    {
+        case Operation::plus:  TREE_ASSERT(EGraphRulesPlus(g, cls, left, right));                      break;
+        case Operation::minus:
+        {
+            if (right == EClassNull) TREE_ASSERT(EGraphRulesNeg  (g, cls, left));
+            else                     TREE_ASSERT(EGraphRulesMinus(g, cls, left, right));
+            break;
+        }
+        case Operation::mul:   TREE_ASSERT(EGraphRulesMul(g, cls, left, right));                       break;
+        case Operation::dive:  TREE_ASSERT(EGraphRulesDiv(g, cls, left, right));                       break;
+        case Operation::power: TREE_ASSERT(EGraphRulesPow(g, cls, left, right));                       break;
+        case Operation::undefined_operation: err.err = TreeErrorType::UNDEFINED_OPERATION_TYPE;        break;
+        default: assert(0 && "You forgot abour some operation.\n");                                    break;
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// operation or function, whose arguments are numbers, is number too
+static TreeErr EGraphFold(EGraph_t* g, const ENode_t* enode, EClassId_t cls)
+{
+    assert(g);
+    assert(enode);
+
+    TreeErr err = {};
+
+    EClassId_t left  = EGraphFind(g, enode->left);
+    EClassId_t right = (enode->right == EClassNull) ? EClassNull : EGraphFind(g, enode->right);
+
+    RETURN_IF_FALSE(g->isConst[left], err);
+    RETURN_IF_TRUE(right != EClassNull && !g->isConst[right], err);
+
+    Number result = 0;
+
+    if (enode->type == NodeArgType::function)
+    {
+        result = GetMathFunction(enode->data.func)(g->value[left]);
+    }
+
+    else if (right == EClassNull)
+    {
+        result = -g->value[left];
+    }
+
+    else
+    {
+        RETURN_IF_TRUE(enode->data.oper == Operation::dive && IsDoubleEqual(g->value[right], 0, eps), err);
+        result = MakeArithmeticOperation(g->value[left], g->value[right], enode->data.oper);
+    }
+
+    RETURN_IF_FALSE(isfinite(result), err);
+
+    return EGraphEqualNum(g, cls, result);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr EGraphRulesPlus(EGraph_t* g, EClassId_t cls, EClassId_t left, EClassId_t right)
+{
+    assert(g);
+
+    TreeErr err = {};
+
+    EClassId_t temp = EClassNull;
+    EClassId_t num  = EClassNull;
+
+    // a + 0 = a
+    if (IsClassNum(g, right, 0)) TREE_ASSERT(EGraphEqual(g, cls, left));
+
+    // a + b = b + a
+    TREE_ASSERT(EGraphEqualOper(g, cls, Operation::plus, right, left));
+
+    // a + a = 2 * a
+    if (left == right)
+    {
+        _ADD_NUM(&num, 2);
+        TREE_ASSERT(EGraphEqualOper(g, cls, Operation::mul, num, left));
+    }
+
+    size_t leftCount  = 0;
+    size_t rightCount = 0;
+
+    const EClassId_t* leftMembers  = EGraphMembers(g, left,  &leftCount);
+    const EClassId_t* rightMembers = EGraphMembers(g, right, &rightCount);
+
+    for (size_t i = 0; i < leftCount; i++)
+    {
+        ENode_t first = g->nodes[leftMembers[i]];
+
+        // (a + b) + c = a + (b + c)
+        if (IsENodeOper(&first, Operation::plus))
+        {
+            _ADD_OPER(&temp, plus, first.right, right);
+            TREE_ASSERT(EGraphEqualOper(g, cls, Operation::plus, first.left, temp));
+        }
+
+        if (!IsENodeOper(&first, Operation::mul)) continue;
+
+        // a * b + a * c = a * (b + c)
+        for (size_t j = 0; j < rightCount; j++)
+        {
+            ENode_t second = g->nodes[rightMembers[j]];
+
+            if (!IsENodeOper(&second, Operation::mul) || EGraphFind(g, first.left) != EGraphFind(g, second.left)) continue;
+
+            _ADD_OPER(&temp, plus, first.right, second.right);
+            TREE_ASSERT(EGraphEqualOper(g, cls, Operation::mul, first.left, temp));
+        }
+
+        // a * b + a = a * (b + 1)
+        if (EGraphFind(g, first.left) == right)
+        {
+            _ADD_NUM (&num, 1);
+            _ADD_OPER(&temp, plus, first.right, num);
+            TREE_ASSERT(EGraphEqualOper(g, cls, Operation::mul, right, temp));
+        }
+    }
+
+    // sin(u)^2 + cos(u)^2 = 1
+    EClassId_t arg = SquareArgOf(g, left, Function::Sin);
+
+    if (arg != EClassNull && arg == SquareArgOf(g, right, Function::Cos))
+    {
+        TREE_ASSERT(EGraphEqualNum(g, cls, 1));
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr EGraphRulesMinus(EGraph_t* g, EClassId_t cls, EClassId_t left, EClassId_t right)
+{
+    assert(g);
+
+    TreeErr err = {};
+
+    EClassId_t temp = EClassNull;
+    EClassId_t num  = EClassNull;
+
+    // a - a = 0, a - 0 = a, 0 - a = -a
+    if (left == right)              TREE_ASSERT(EGraphEqualNum (g, cls, 0));
+    if (IsClassNum(g, right, 0))    TREE_ASSERT(EGraphEqual    (g, cls, left));
+    if (IsClassNum(g, left,  0))    TREE_ASSERT(EGraphEqualOper(g, cls, Operation::minus, right, EClassNull));
+
+    // a - b = a + (-1) * b, so rules of sum work for difference too
+    _ADD_NUM (&num, -1);
+    _ADD_OPER(&temp, mul, num, right);
+    TREE_ASSERT(EGraphEqualOper(g, cls, Operation::plus, left, temp));
+
+    // ch(u)^2 - sh(u)^2 = 1
+    EClassId_t arg = SquareArgOf(g, left, Function::Ch);
+
+    if (arg != EClassNull && arg == SquareArgOf(g, right, Function::Sh))
+    {
+        TREE_ASSERT(EGraphEqualNum(g, cls, 1));
+    }
+
+    // 1 - sin(u)^2 = cos(u)^2, 1 - cos(u)^2 = sin(u)^2
+    if (IsClassNum(g, left, 1))
+    {
+        static const Function pairs[][2] = {{Function::Sin, Function::Cos}, {Function::Cos, Function::Sin}};
+
+        for (size_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++)
+        {
+            arg = SquareArgOf(g, right, pairs[i][0]);
+            if (arg == EClassNull) continue;
+
+            _ADD_NUM(&num, 2);
+            TREE_ASSERT(EGraphAddFunc(g, pairs[i][1], arg, &temp));
+            TREE_ASSERT(EGraphEqualOper(g, cls, Operation::power, temp, num));
+        }
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr EGraphRulesNeg(EGraph_t* g, EClassId_t cls, EClassId_t arg)
+{
+    assert(g);
+
+    TreeErr err = {};
+
+    EClassId_t num = EClassNull;
+
+    // -(-a) = a
+    size_t count = 0;
+    const EClassId_t* members = EGraphMembers(g, arg, &count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        ENode_t member = g->nodes[members[i]];
+        if (IsENodeNeg(&member)) TREE_ASSERT(EGraphEqual(g, cls, member.left));
+    }
+
+    // -a = (-1) * a
+    _ADD_NUM(&num, -1);
+    TREE_ASSERT(EGraphEqualOper(g, cls, Operation::mul, num, arg));
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr EGraphRulesMul(EGraph_t* g, EClassId_t cls, EClassId_t left, EClassId_t right)
+{
+    assert(g);
+
+    TreeErr err = {};
+
+    EClassId_t temp = EClassNull;
+    EClassId_t num  = EClassNull;
+
+    // a * 1 = a, a * 0 = 0, a * b = b * a
+    if (IsClassNum(g, right, 1)) TREE_ASSERT(EGraphEqual   (g, cls, left));
+    if (IsClassNum(g, right, 0)) TREE_ASSERT(EGraphEqualNum(g, cls, 0));
+
+    TREE_ASSERT(EGraphEqualOper(g, cls, Operation::mul, right, left));
+
+    // a * a = a ^ 2
+    if (left == right)
+    {
+        _ADD_NUM(&num, 2);
+        TREE_ASSERT(EGraphEqualOper(g, cls, Operation::power, left, num));
+    }
+
+    size_t leftCount  = 0;
+    size_t rightCount = 0;
+
+    const EClassId_t* leftMembers  = EGraphMembers(g, left,  &leftCount);
+    const EClassId_t* rightMembers = EGraphMembers(g, right, &rightCount);
+
+    for (size_t i = 0; i < leftCount; i++)
+    {
+        ENode_t first = g->nodes[leftMembers[i]];
+
+        // (a * b) * c = a * (b * c)
+        if (IsENodeOper(&first, Operation::mul))
+        {
+            _ADD_OPER(&temp, mul, first.right, right);
+            TREE_ASSERT(EGraphEqualOper(g, cls, Operation::mul, first.left, temp));
+        }
+
+        if (!IsENodeOper(&first, Operation::power) || !g->isConst[EGraphFind(g, first.right)]) continue;
+
+        EClassId_t base     = EGraphFind(g, first.left);
+        Number     exponent = g->value[EGraphFind(g, first.right)];
+
+        // a ^ p * a = a ^ (p + 1)
+        if (base == right)
+        {
+            _ADD_NUM(&num, exponent + 1);
+            TREE_ASSERT(EGraphEqualOper(g, cls, Operation::power, base, num));
+        }
+
+        // a ^ p * a ^ q = a ^ (p + q)
+        for (size_t j = 0; j < rightCount; j++)
+        {
+            ENode_t second = g->nodes[rightMembers[j]];
+
+            if (!IsENodeOper(&second, Operation::power) || EGraphFind(g, second.left) != base) continue;
+            if (!g->isConst[EGraphFind(g, second.right)])                                       continue;
+
+            _ADD_NUM(&num, exponent + g->value[EGraphFind(g, second.right)]);
+            TREE_ASSERT(EGraphEqualOper(g, cls, Operation::power, base, num));
+        }
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr EGraphRulesDiv(EGraph_t* g, EClassId_t cls, EClassId_t left, EClassId_t right)
+{
+    assert(g);
+
+    TreeErr err = {};
+
+    EClassId_t temp = EClassNull;
+    EClassId_t num  = EClassNull;
+
+    // a / 1 = a, a / a = 1, 0 / a = 0
+    if (IsClassNum(g, right, 1))                                TREE_ASSERT(EGraphEqual   (g, cls, left));
+    if (left == right)                                          TREE_ASSERT(EGraphEqualNum(g, cls, 1));
+    if (IsClassNum(g, left, 0) && !IsClassNum(g, right, 0))     TREE_ASSERT(EGraphEqualNum(g, cls, 0));
+
+    // a / b = a * b ^ (-1), so factors of numerator and denominator can cancel
+    _ADD_NUM (&num, -1);
+    _ADD_OPER(&temp, power, right, num);
+    TREE_ASSERT(EGraphEqualOper(g, cls, Operation::mul, left, temp));
+
+    // sin / cos = tg, cos / sin = ctg, sh / ch = th, ch / sh = cth
+    static const Function quotients[][3] = {{Function::Sin, Function::Cos, Function::Tg},
+                                            {Function::Cos, Function::Sin, Function::Ctg},
+                                            {Function::Sh,  Function::Ch,  Function::Th},
+                                            {Function::Ch,  Function::Sh,  Function::Cth}};
+
+    for (size_t i = 0; i < sizeof(quotients) / sizeof(quotients[0]); i++)
+    {
+        EClassId_t arg = FuncArgOf(g, left, quotients[i][0]);
+
+        if (arg == EClassNull || arg != FuncArgOf(g, right, quotients[i][1])) continue;
+
+        TREE_ASSERT(EGraphAddFunc(g, quotients[i][2], arg, &temp));
+        TREE_ASSERT(EGraphEqual(g, cls, temp));
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr EGraphRulesPow(EGraph_t* g, EClassId_t cls, EClassId_t left, EClassId_t right)
+{
+    assert(g);
+
+    TreeErr err = {};
+
+    EClassId_t num = EClassNull;
+
+    // a ^ 1 = a, a ^ 0 = 1, 1 ^ a = 1, a ^ (-1) = 1 / a
+    if (IsClassNum(g, right, 1))  TREE_ASSERT(EGraphEqual   (g, cls, left));
+    if (IsClassNum(g, right, 0))  TREE_ASSERT(EGraphEqualNum(g, cls, 1));
+    if (IsClassNum(g, left,  1))  TREE_ASSERT(EGraphEqualNum(g, cls, 1));
+
+    if (IsClassNum(g, right, -1))
+    {
+        _ADD_NUM(&num, 1);
+        TREE_ASSERT(EGraphEqualOper(g, cls, Operation::dive, num, left));
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//============================== Rule helpers ==========================================================================================
+
+static TreeErr EGraphAddNum(EGraph_t* g, Number num, EClassId_t* cls)
+{
+    NodeData_t data = {.num = num};
+    return EGraphAdd(g, NodeArgType::number, data, EClassNull, EClassNull, cls);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr EGraphAddOper(EGraph_t* g, Operation oper, EClassId_t left, EClassId_t right, EClassId_t* cls)
+{
+    NodeData_t data = {.oper = oper};
+    return EGraphAdd(g, NodeArgType::operation, data, left, right, cls);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr EGraphAddFunc(EGraph_t* g, Function func, EClassId_t arg, EClassId_t* cls)
+{
+    NodeData_t data = {.func = func};
+    return EGraphAdd(g, NodeArgType::function, data, arg, EClassNull, cls);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr EGraphEqualNum(EGraph_t* g, EClassId_t cls, Number num)
+{
+    EClassId_t other = EClassNull;
+    TREE_ASSERT(EGraphAddNum(g, num, &other));
+
+    return EGraphEqual(g, cls, other);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr EGraphEqualOper(EGraph_t* g, EClassId_t cls, Operation oper, EClassId_t left, EClassId_t right)
+{
+    EClassId_t other = EClassNull;
+    TREE_ASSERT(EGraphAddOper(g, oper, left, right, &other));
+
+    return EGraphEqual(g, cls, other);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsClassNum(EGraph_t* g, EClassId_t cls, Number num)
+{
+    assert(g);
+
+    cls = EGraphFind(g, cls);
+
+    return g->isConst[cls] && IsDoubleEqual(g->value[cls], num, eps);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsENodeOper(const ENode_t* enode, Operation oper)
+{
+    assert(enode);
+
+    return (enode->type == NodeArgType::operation) && (enode->data.oper == oper) && (enode->right != EClassNull);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsENodeNeg(const ENode_t* enode)
+{
+    assert(enode);
+
+    return (enode->type == NodeArgType::operation) && (enode->data.oper == Operation::minus) && (enode->right == EClassNull);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// u, if class has func(u)
+static EClassId_t FuncArgOf(EGraph_t* g, EClassId_t cls, Function func)
+{
+    assert(g);
+
+    size_t count = 0;
+    const EClassId_t* members = EGraphMembers(g, cls, &count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const ENode_t* member = &g->nodes[members[i]];
+
+        if (member->type == NodeArgType::function && member->data.func == func) return EGraphFind(g, member->left);
+    }
+
+    return EClassNull;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// u, if class has func(u) ^ 2
+static EClassId_t SquareArgOf(EGraph_t* g, EClassId_t cls, Function func)
+{
+    assert(g);
+
+    size_t count = 0;
+    const EClassId_t* members = EGraphMembers(g, cls, &count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const ENode_t* member = &g->nodes[members[i]];
+
+        if (!IsENodeOper(member, Operation::power) || !IsClassNum(g, member->right, 2)) continue;
+
+        EClassId_t arg = FuncArgOf(g, member->left, func);
+        if (arg != EClassNull) return arg;
+    }
+
+    return EClassNull;
+}
+
+//============================== Extraction ============================================================================================
+
+// cost of class is the least cost of its enodes; costs are relaxed until they don't change
+static TreeErr EGraphExtract(EGraph_t* g, EClassId_t root, EGraphCostModel model, bool shared, Node_t** node)
+{
+    assert(g);
+    assert(node);
+
+    TreeErr err = {};
+
+    double*     cost  = (double*)     calloc(g->size, sizeof(double));
+    EClassId_t* best  = (EClassId_t*) calloc(g->size, sizeof(EClassId_t));
+    Node_t**    built = shared ? (Node_t**) calloc(g->size, sizeof(Node_t*)) : nullptr;
+
+    if (!cost || !best || (shared && !built))
+    {
+        FREE(cost);
+        FREE(best);
+        FREE(built);
+        err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    for (size_t i = 0; i < g->size; i++)
+    {
+        cost[i] = HUGE_VAL;
+        best[i] = EClassNull;
+    }
+
+    bool changed = true;
+
+    while (changed)
+    {
+        changed = false;
+
+        for (size_t i = 0; i < g->size; i++)
+        {
+            const ENode_t* enode = &g->nodes[i];
+
+            double sum = ENodeCost(enode, model);
+            if (enode->left  != EClassNull) sum += cost[EGraphFind(g, enode->left)];
+            if (enode->right != EClassNull) sum += cost[EGraphFind(g, enode->right)];
+
+            EClassId_t cls = EGraphFind(g, (EClassId_t) i);
+
+            if (sum < cost[cls])
+            {
+                cost[cls] = sum;
+                best[cls] = (EClassId_t) i;
+                changed   = true;
+            }
+        }
+    }
+
+    TREE_ASSERT(EGraphBuild(g, best, built, root, node));
+
+    FREE(cost);
+    FREE(best);
+    FREE(built);
+
+    return NODE_VERIF(*node, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// in dag every class is built once, in tree shared class is built for every its use
+static TreeErr EGraphBuild(EGraph_t* g, const EClassId_t* best, Node_t** built, EClassId_t cls, Node_t** node)
+{
+    assert(g);
+    assert(best);
+    assert(node);
+
+    TreeErr err = {};
+
+    cls = EGraphFind(g, cls);
+
+    RETURN_IF_TRUE(built && built[cls], err, *node = built[cls]);
+
+    assert(best[cls] != EClassNull);
+    ENode_t enode = g->nodes[best[cls]];
+
+    Node_t* left  = nullptr;
+    Node_t* right = nullptr;
+
+    if (enode.left != EClassNull)
+    {
+        TREE_ASSERT(EGraphBuild(g, best, built, enode.left, &left));
+    }
+
+    if (enode.right != EClassNull)
+    {
+        TREE_ASSERT(EGraphBuild(g, best, built, enode.right, &right));
+    }
+
+    TREE_ASSERT(NodeCtor(node, enode.type, enode.data, left, right));
+
+    if (built) built[cls] = *node;
+
+    return NODE_VERIF(*node, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static double ENodeCost(const ENode_t* enode, EGraphCostModel model)
+{
+    assert(enode);
+
+    RETURN_IF_TRUE(model == EGraphCostModel::node_count, 1);
+
+    switch (enode->type)
+    {
+        case NodeArgType::number:
+        case NodeArgType::variable:  return 1;
+        case NodeArgType::function:  return 20;
+        case NodeArgType::operation:
+        {
+            switch (enode->data.oper)
+            {
+                case Operation::plus:
+                case Operation::minus: return 1;
+                case Operation::mul:   return 2;
+                case Operation::dive:  return 8;
+                case Operation::power: return 16;
+                case Operation::undefined_operation:
+                default: assert(0 && "undefined operation in cost.\n"); break;
+            }
+            break;
+        }
+        case NodeArgType::undefined:
+        default: assert(0 && "undefined node type in cost.\n"); break;
+    }
+
+    return 1;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+#undef _ADD_OPER
+#undef _ADD_NUM
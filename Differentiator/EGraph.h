@@ -0,0 +1,25 @@
+#ifndef E_GRAPH_H
+#define E_GRAPH_H
+
+#include "../Tree/Tree.h"
+
+enum EGraphCostModel
+{
+    node_count,      // smallest tree
+    evaluation_cost, // cheapest tree to evaluate: division, power and functions cost more than + and *
+};
+
+// saturation stops, when rules give nothing new or one of limits is reached
+struct EGraphBudget_t
+{
+    size_t          maxNodes;
+    size_t          maxIterations;
+    double          maxSeconds;
+    EGraphCostModel cost;
+};
+
+extern const EGraphBudget_t EGraphDefaultBudget;
+
+TreeErr EGraphSimplify(Tree_t* tree, const EGraphBudget_t* budget);
+
+#endif
@@ -0,0 +1,470 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "FlatDiff.h"
+#include "../Tree/Tree.h"
+#include "../Tree/FlatTree.h"
+#include "SimplifyTree.h"
+#include "../Common/GlobalInclude.h"
+
+
+// in flat tree children are before parent, so derivatives of all nodes are found in one pass from begin to end.
+// rules are the same as in Differentiator.cpp and fold the same way, so result has the same shape as Diff of pointer tree
+struct FlatDiff_t
+{
+    const FlatTree_t* in;
+    FlatTree_t*       out;
+    FlatIndex_t*      diff;     // diff[i]    - index in 'out' of derivative of 'in' node i
+    bool*             isConst;  // isConst[i] - there is no variable in subtree of 'in' node i
+};
+
+
+static TreeErr FlatDiffNode          (FlatDiff_t* d, FlatIndex_t node);
+static TreeErr FlatDiffOperation     (FlatDiff_t* d, FlatIndex_t node);
+static TreeErr FlatDiffMul           (FlatDiff_t* d, FlatIndex_t node);
+static TreeErr FlatDiffDiv           (FlatDiff_t* d, FlatIndex_t node);
+static TreeErr FlatDiffPow           (FlatDiff_t* d, FlatIndex_t node);
+static TreeErr FlatDiffFunction      (FlatDiff_t* d, FlatIndex_t node);
+static TreeErr FlatDiffFunctionOuter (FlatDiff_t* d, Function function, FlatIndex_t arg, FlatIndex_t* outer);
+static TreeErr FlatOneOverSquare     (FlatDiff_t* d, Function function, FlatIndex_t arg, bool negative, FlatIndex_t* outer);
+static TreeErr FlatOneOverUnitSquare (FlatDiff_t* d, Operation operation, FlatIndex_t arg, bool negative, FlatIndex_t* outer);
+
+
+#define _L d->in->left [node]
+#define _R d->in->right[node]
+
+#define _COPY(copy, node) TREE_ASSERT(FlatSubTreeCopy(d->out, d->in, node, copy))
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr FlatDiff(const FlatTree_t* in, FlatTree_t* out)
+{
+    assert(in);
+    assert(in->size);
+    assert(out);
+
+    TreeErr err = {};
+
+    TREE_ASSERT(FlatTreeCtor(out, 4 * in->size));
+
+    FlatDiff_t d = {};
+
+    d.in      = in;
+    d.out     = out;
+    d.diff    = (FlatIndex_t*) calloc(in->size, sizeof(FlatIndex_t));
+    d.isConst = (bool*)        calloc(in->size, sizeof(bool));
+
+    if (!d.diff || !d.isConst)
+    {
+        FREE(d.diff);
+        FREE(d.isConst);
+        err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    for (size_t i = 0; i < in->size; i++)
+    {
+        FlatIndex_t left  = in->left [i];
+        FlatIndex_t right = in->right[i];
+
+        d.isConst[i] = (in->type[i] != NodeArgType::variable)      &&
+                       (left  == FlatNull || d.isConst[left])      &&
+                       (right == FlatNull || d.isConst[right]);
+
+        TREE_ASSERT(FlatDiffNode(&d, (FlatIndex_t) i));
+    }
+
+    FREE(d.diff);
+    FREE(d.isConst);
+
+    // derivative of root was pushed last, derivatives of nodes that no rule used are dropped here
+    TREE_ASSERT(FlatTreeCompact(out));
+
+    return FLAT_TREE_VERIF(out, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr FlatDiffNode(FlatDiff_t* d, FlatIndex_t node)
+{
+    assert(d);
+
+    TreeErr err = {};
+
+    if (d->isConst[node])
+    {
+        _FLAT_NUM(d->out, &d->diff[node], 0);
+
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    NodeArgType type = d->in->type[node];
+
+    switch (type)
+    {
+        case NodeArgType::number:    _FLAT_NUM(d->out, &d->diff[node], 0);           break;
+        case NodeArgType::variable:  _FLAT_NUM(d->out, &d->diff[node], 1);           break;
+        case NodeArgType::operation: TREE_ASSERT(FlatDiffOperation(d, node));        break;
+        case NodeArgType::function:  TREE_ASSERT(FlatDiffFunction (d, node));        break;
+        case NodeArgType::undefined: err.err = UNDEFINED_NODE_TYPE;                  break;
+        default: assert(0 && "you forgot about some operation.\n");                  break;
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr FlatDiffOperation(FlatDiff_t* d, FlatIndex_t node)
+{
+    assert(d);
+
+    TreeErr err = {};
+
+    Operation operation = d->in->data[node].oper;
+
+    FlatIndex_t* result = &d->diff[node];
+
+    switch (operation)
+    {
+        case Operation::plus:   _FLAT_FOLD_ADD(d->out, result, d->diff[_L], d->diff[_R]);                                  break;
+        case Operation::minus:  _FLAT_FOLD_SUB(d->out, result, d->diff[_L], (_R == FlatNull) ? FlatNull : d->diff[_R]);   break;
+        case Operation::mul:    TREE_ASSERT(FlatDiffMul(d, node));                                                    break;
+        case Operation::dive:   TREE_ASSERT(FlatDiffDiv(d, node));                                                    break;
+        case Operation::power:  TREE_ASSERT(FlatDiffPow(d, node));                                                    break;
+        case Operation::undefined_operation: err.err = TreeErrorType::UNDEFINED_OPERATION_TYPE;                       break;
+        default: assert(0 && "You forgot abour some operation.\n");                                                   break;
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr FlatDiffMul(FlatDiff_t* d, FlatIndex_t node)
+{
+    assert(d);
+
+    TreeErr err = {};
+
+    FlatIndex_t copy_left  = FlatNull;
+    FlatIndex_t copy_right = FlatNull;
+
+    _COPY(&copy_left,  _L);
+    _COPY(&copy_right, _R);
+
+    FlatIndex_t new_left  = FlatNull;
+    FlatIndex_t new_right = FlatNull;
+
+    _FLAT_FOLD_MUL(d->out, &new_left,  d->diff[_L], copy_right);
+    _FLAT_FOLD_MUL(d->out, &new_right, copy_left,   d->diff[_R]);
+
+    _FLAT_FOLD_ADD(d->out, &d->diff[node], new_left, new_right);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr FlatDiffDiv(FlatDiff_t* d, FlatIndex_t node)
+{
+    assert(d);
+
+    TreeErr err = {};
+
+    FlatIndex_t copy_left  = FlatNull;
+    FlatIndex_t copy_right = FlatNull;
+
+    FlatIndex_t new_left  = FlatNull;
+    FlatIndex_t new_right = FlatNull;
+
+    FlatIndex_t new_left_left  = FlatNull;
+    FlatIndex_t new_left_right = FlatNull;
+
+    FlatIndex_t new_right_left  = FlatNull;
+    FlatIndex_t new_right_right = FlatNull;
+
+    _COPY(&copy_left,  _L);
+    _COPY(&copy_right, _R);
+
+    _COPY    (&new_right_left, _R);
+    _FLAT_NUM(d->out, &new_right_right, 2);
+
+    _FLAT_FOLD_MUL(d->out, &new_left_left,  d->diff[_L], copy_right);
+    _FLAT_FOLD_MUL(d->out, &new_left_right, copy_left,   d->diff[_R]);
+
+    _FLAT_FOLD_SUB(d->out, &new_left,  new_left_left,  new_left_right);
+    _FLAT_FOLD_POW(d->out, &new_right, new_right_left, new_right_right);
+
+    _FLAT_FOLD_DIV(d->out, &d->diff[node], new_left, new_right);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr FlatDiffPow(FlatDiff_t* d, FlatIndex_t node)
+{
+    assert(d);
+
+    TreeErr err = {};
+
+    if (d->isConst[_R])
+    {
+        FlatIndex_t new_left       = FlatNull; // c * (f ^ (c - 1))
+        FlatIndex_t new_left_left  = FlatNull; // c
+        FlatIndex_t new_left_right = FlatNull; // f ^ (c - 1)
+        FlatIndex_t base           = FlatNull; // f
+        FlatIndex_t degree         = FlatNull; // c - 1
+        FlatIndex_t degree_left    = FlatNull; // c
+        FlatIndex_t degree_right   = FlatNull; // 1
+
+        _COPY         (&degree_left, _R);
+        _FLAT_NUM     (d->out, &degree_right, 1);
+
+        _COPY         (&base, _L);
+        _FLAT_FOLD_SUB(d->out, &degree, degree_left, degree_right);
+
+        _COPY         (&new_left_left, _R);
+        _FLAT_FOLD_POW(d->out, &new_left_right, base, degree);
+
+        _FLAT_FOLD_MUL(d->out, &new_left, new_left_left, new_left_right);
+
+        _FLAT_FOLD_MUL(d->out, &d->diff[node], new_left, d->diff[_L]);
+
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    if (d->isConst[_L])
+    {
+        FlatIndex_t new_left            = FlatNull; // (c ^ g) * ln(c)
+        FlatIndex_t new_left_left       = FlatNull; // c ^ g
+        FlatIndex_t new_left_right      = FlatNull; // ln(c)
+        FlatIndex_t new_left_left_left  = FlatNull; // c
+        FlatIndex_t new_left_left_right = FlatNull; // g
+        FlatIndex_t new_left_right_left = FlatNull; // c
+
+        _COPY(&new_left_left_left,  _L);
+        _COPY(&new_left_left_right, _R);
+
+        _COPY(&new_left_right_left, _L);
+
+        _FLAT_FOLD_POW (d->out, &new_left_left,  new_left_left_left, new_left_left_right);
+        _FLAT_FOLD_FUNC(d->out, &new_left_right, Function::Ln,       new_left_right_left);
+
+        _FLAT_FOLD_MUL(d->out, &new_left, new_left_left, new_left_right);
+
+        _FLAT_FOLD_MUL(d->out, &d->diff[node], new_left, d->diff[_R]);
+
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    FlatIndex_t new_left              = FlatNull; // f ^ g
+    FlatIndex_t new_right             = FlatNull; // (g' * ln(f)) + (f' * (g / f))
+    FlatIndex_t new_left_left         = FlatNull; // f
+    FlatIndex_t new_left_right        = FlatNull; // g
+    FlatIndex_t new_right_left        = FlatNull; // g' * ln(f)
+    FlatIndex_t new_right_right       = FlatNull; // f' * (g / f)
+    FlatIndex_t new_right_left_right  = FlatNull; // ln(f)
+    FlatIndex_t ln_arg                = FlatNull; // f
+    FlatIndex_t new_right_right_right = FlatNull; // g / f
+    FlatIndex_t div_left              = FlatNull; // g
+    FlatIndex_t div_right             = FlatNull; // f
+
+    _COPY(&div_left,  _R);
+    _COPY(&div_right, _L);
+
+    _COPY(&ln_arg, _L);
+
+    _FLAT_FOLD_FUNC(d->out, &new_right_left_right, Function::Ln, ln_arg);
+    _FLAT_FOLD_DIV (d->out, &new_right_right_right, div_left, div_right);
+
+    _COPY(&new_left_left,  _L);
+    _COPY(&new_left_right, _R);
+
+    _FLAT_FOLD_MUL(d->out, &new_right_left,  d->diff[_R], new_right_left_right);
+    _FLAT_FOLD_MUL(d->out, &new_right_right, d->diff[_L], new_right_right_right);
+
+    _FLAT_FOLD_POW(d->out, &new_left,  new_left_left,  new_left_right);
+    _FLAT_FOLD_ADD(d->out, &new_right, new_right_left, new_right_right);
+
+    _FLAT_FOLD_MUL(d->out, &d->diff[node], new_left, new_right);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr FlatDiffFunction(FlatDiff_t* d, FlatIndex_t node)
+{
+    assert(d);
+
+    TreeErr err = {};
+
+    FlatIndex_t arg   = FlatNull;
+    FlatIndex_t outer = FlatNull;
+
+    _COPY(&arg, _L);
+    TREE_ASSERT(FlatDiffFunctionOuter(d, d->in->data[node].func, arg, &outer));
+
+    _FLAT_FOLD_MUL(d->out, &d->diff[node], outer, d->diff[_L]);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr FlatDiffFunctionOuter(FlatDiff_t* d, Function function, FlatIndex_t arg, FlatIndex_t* outer)
+{
+    assert(d);
+    assert(outer);
+
+    TreeErr err = {};
+
+    FlatTree_t* out = d->out;
+
+    FlatIndex_t one = FlatNull;
+    FlatIndex_t two = FlatNull;
+    FlatIndex_t tmp = FlatNull;
+
+    switch (function)
+    {
+        case Function::Ln:
+        {
+            _FLAT_NUM     (out, &one, 1);
+            _FLAT_FOLD_DIV(out, outer, one, arg);
+            break;
+        }
+        case Function::Sqrt:
+        {
+            FlatIndex_t sqrt_arg = FlatNull;
+
+            _FLAT_NUM      (out, &two, 2);
+            _FLAT_FOLD_FUNC(out, &sqrt_arg, Function::Sqrt, arg);
+            _FLAT_NUM      (out, &one, 1);
+            _FLAT_FOLD_MUL (out, &tmp, two, sqrt_arg);
+            _FLAT_FOLD_DIV (out, outer, one, tmp);
+            break;
+        }
+        case Function::Sin:    _FLAT_FOLD_FUNC(out, outer, Function::Cos, arg);                                                break;
+        case Function::Cos:    _FLAT_FOLD_FUNC(out, &tmp,  Function::Sin, arg); _FLAT_FOLD_SUB(out, outer, tmp, FlatNull);     break;
+        case Function::Sh:     _FLAT_FOLD_FUNC(out, outer, Function::Ch,  arg);                                                break;
+        case Function::Ch:     _FLAT_FOLD_FUNC(out, outer, Function::Sh,  arg);                                                break;
+        case Function::Tg:     TREE_ASSERT(FlatOneOverSquare    (d, Function::Cos,   arg, false, outer));            break;
+        case Function::Ctg:    TREE_ASSERT(FlatOneOverSquare    (d, Function::Sin,   arg, true,  outer));            break;
+        case Function::Th:     TREE_ASSERT(FlatOneOverSquare    (d, Function::Ch,    arg, false, outer));            break;
+        case Function::Cth:    TREE_ASSERT(FlatOneOverSquare    (d, Function::Sh,    arg, false, outer));            break;
+        case Function::Arcsin: TREE_ASSERT(FlatOneOverUnitSquare(d, Operation::minus, arg, false, outer));           break;
+        case Function::Arccos: TREE_ASSERT(FlatOneOverUnitSquare(d, Operation::minus, arg, true,  outer));           break;
+        case Function::Arctg:  TREE_ASSERT(FlatOneOverUnitSquare(d, Operation::plus,  arg, false, outer));           break;
+        case Function::Arcctg: TREE_ASSERT(FlatOneOverUnitSquare(d, Operation::plus,  arg, true,  outer));           break;
+        case Function::undefined_function: err.err = UNDEFINED_FUNCTION_TYPE;                                         break;
+        default: assert(0 && "You forgpt about some function.\n");                                                    break;
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// (+-1) / (function(arg) ^ 2)
+static TreeErr FlatOneOverSquare(FlatDiff_t* d, Function function, FlatIndex_t arg, bool negative, FlatIndex_t* outer)
+{
+    assert(d);
+    assert(outer);
+
+    TreeErr err = {};
+
+    FlatTree_t* out = d->out;
+
+    FlatIndex_t new_left        = FlatNull;
+    FlatIndex_t new_right       = FlatNull;
+    FlatIndex_t new_right_left  = FlatNull;
+    FlatIndex_t new_right_right = FlatNull;
+
+    if (negative)
+    {
+        FlatIndex_t one = FlatNull;
+        _FLAT_NUM     (out, &one, 1);
+        _FLAT_FOLD_SUB(out, &new_left, one, FlatNull);
+    }
+
+    _FLAT_FOLD_FUNC(out, &new_right_left, function, arg);
+    _FLAT_NUM      (out, &new_right_right, 2);
+
+    if (!negative) _FLAT_NUM(out, &new_left, 1);
+    _FLAT_FOLD_POW(out, &new_right, new_right_left, new_right_right);
+
+    _FLAT_FOLD_DIV(out, outer, new_left, new_right);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// arcsin, arccos: (+-1) / sqrt(1 - arg ^ 2); arctg, arcctg: (+-1) / (1 + arg ^ 2)
+static TreeErr FlatOneOverUnitSquare(FlatDiff_t* d, Operation operation, FlatIndex_t arg, bool negative, FlatIndex_t* outer)
+{
+    assert(d);
+    assert(outer);
+    assert(operation == Operation::minus || operation == Operation::plus);
+
+    TreeErr err = {};
+
+    FlatTree_t* out = d->out;
+
+    FlatIndex_t new_left   = FlatNull;
+    FlatIndex_t new_right  = FlatNull;
+    FlatIndex_t unit       = FlatNull;
+    FlatIndex_t two        = FlatNull;
+    FlatIndex_t square     = FlatNull;
+    FlatIndex_t unitSquare = FlatNull;
+
+    _FLAT_NUM     (out, &two, 2);
+    _FLAT_NUM     (out, &unit, 1);
+    _FLAT_FOLD_POW(out, &square, arg, two);
+
+    if (negative)
+    {
+        FlatIndex_t one = FlatNull;
+        _FLAT_NUM     (out, &one, 1);
+        _FLAT_FOLD_SUB(out, &new_left, one, FlatNull);
+    }
+    else
+    {
+        _FLAT_NUM(out, &new_left, 1);
+    }
+
+    if (operation == Operation::minus)
+    {
+        _FLAT_FOLD_SUB (out, &unitSquare, unit, square);
+        _FLAT_FOLD_FUNC(out, &new_right, Function::Sqrt, unitSquare);
+    }
+    else
+    {
+        _FLAT_FOLD_ADD(out, &new_right, unit, square);
+    }
+
+    _FLAT_FOLD_DIV(out, outer, new_left, new_right);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+#undef _L
+#undef _R
+#undef _COPY
@@ -0,0 +1,9 @@
+#ifndef FLAT_DIFF_H
+#define FLAT_DIFF_H
+
+#include "../Tree/Tree.h"
+#include "../Tree/FlatTree.h"
+
+TreeErr FlatDiff(const FlatTree_t* in, FlatTree_t* out);
+
+#endif
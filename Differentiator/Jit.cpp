@@ -0,0 +1,383 @@
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+#include <sys/mman.h>
+#include "Jit.h"
+#include "Bytecode.h"
+#include "SimplifyTree.h"
+#include "../Tree/Tree.h"
+#include "../Common/GlobalInclude.h"
+
+
+struct JitEmitter_t
+{
+    uint8_t* code;
+    size_t   size;
+    size_t   capacity;
+};
+
+static TreeErr JitEmitProgram     (JitEmitter_t* emitter, const Bytecode_t* bytecode);
+static TreeErr JitEmitInstruction (JitEmitter_t* emitter, const Instruction_t* instruction);
+static TreeErr JitEmitSse         (JitEmitter_t* emitter, uint8_t opcode, uint8_t xmm, uint32_t reg);
+static TreeErr JitEmitCall        (JitEmitter_t* emitter, uint64_t address);
+static TreeErr JitEmitBytes       (JitEmitter_t* emitter, const uint8_t* bytes, size_t size);
+static TreeErr JitMakeExecutable  (Jit_t* jit, const JitEmitter_t* emitter);
+static Number  TreeWalkEval       (const Node_t* node, Number x, Number y);
+
+// sse2 scalar opcodes: F2 0F <opcode> /r
+static const uint8_t SseLoad  = 0x10;
+static const uint8_t SseStore = 0x11;
+static const uint8_t SseSqrt  = 0x51;
+static const uint8_t SseAdd   = 0x58;
+static const uint8_t SseMul   = 0x59;
+static const uint8_t SseSub   = 0x5C;
+static const uint8_t SseDiv   = 0x5E;
+
+static const size_t JitMinCapacity = 256;
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr JitCompile(const Tree_t* tree, Jit_t* jit)
+{
+    assert(tree);
+    assert(jit);
+
+    TreeErr err = {};
+
+    *jit = {};
+
+    TREE_ASSERT(BytecodeCompile(tree, &jit->bytecode));
+
+#if defined(__x86_64__)
+    JitEmitter_t emitter = {};
+
+    TREE_ASSERT(JitEmitProgram(&emitter, &jit->bytecode));
+    TREE_ASSERT(JitMakeExecutable(jit, &emitter));
+
+    FREE(emitter.code);
+#endif
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr JitDtor(Jit_t* jit)
+{
+    assert(jit);
+
+    TreeErr err = {};
+
+    if (jit->buffer) munmap(jit->buffer, jit->bufferSize);
+
+    TREE_ASSERT(BytecodeDtor(&jit->bytecode));
+
+    *jit = {};
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+Number JitRun(Jit_t* jit, Number x, Number y)
+{
+    assert(jit);
+
+    RETURN_IF_FALSE(jit->code, BytecodeRun(&jit->bytecode, x, y));
+
+    Number* registers = jit->bytecode.registers;
+
+    registers[0] = x;
+    registers[1] = y;
+
+    jit->code(registers);
+
+    return registers[jit->bytecode.result];
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr JitBenchmark(const Tree_t* tree, size_t points, JitBenchmark_t* bench)
+{
+    assert(tree);
+    assert(tree->root);
+    assert(bench);
+
+    TreeErr err = {};
+
+    Jit_t jit = {};
+    TREE_ASSERT(JitCompile(tree, &jit));
+
+    // results go to volatile, so evaluations are not thrown away
+    volatile Number sink = 0;
+    double times[4] = {};
+
+    times[0] = GetWallTime();
+    for (size_t i = 0; i < points; i++) sink = TreeWalkEval(tree->root, (double) i / (double) points, 0);
+
+    times[1] = GetWallTime();
+    for (size_t i = 0; i < points; i++) sink = BytecodeRun(&jit.bytecode, (double) i / (double) points, 0);
+
+    times[2] = GetWallTime();
+    for (size_t i = 0; i < points; i++) sink = JitRun(&jit, (double) i / (double) points, 0);
+
+    times[3] = GetWallTime();
+
+    bench->points          = points;
+    bench->treeSeconds     = times[1] - times[0];
+    bench->bytecodeSeconds = times[2] - times[1];
+    bench->jitSeconds      = times[3] - times[2];
+
+    TREE_ASSERT(JitDtor(&jit));
+
+    (void) sink;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//============================== Code emission =========================================================================================
+
+// rbx holds address of register file: it is callee-saved, so libm calls don't break it.
+// after push rbx stack is aligned by 16, as calls need
+static TreeErr JitEmitProgram(JitEmitter_t* emitter, const Bytecode_t* bytecode)
+{
+    assert(emitter);
+    assert(bytecode);
+
+    TreeErr err = {};
+
+    static const uint8_t prologue[] = {0x53,                 // push rbx
+                                       0x48, 0x89, 0xFB};    // mov  rbx, rdi
+
+    static const uint8_t epilogue[] = {0x5B,                 // pop  rbx
+                                       0xC3};                // ret
+
+    TREE_ASSERT(JitEmitBytes(emitter, prologue, sizeof(prologue)));
+
+    for (size_t i = 0; i < bytecode->size; i++)
+    {
+        TREE_ASSERT(JitEmitInstruction(emitter, &bytecode->code[i]));
+    }
+
+    TREE_ASSERT(JitEmitBytes(emitter, epilogue, sizeof(epilogue)));
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// xmm0 = registers[left] op registers[right]; registers[dest] = xmm0
+static TreeErr JitEmitInstruction(JitEmitter_t* emitter, const Instruction_t* instruction)
+{
+    assert(emitter);
+    assert(instruction);
+
+    TreeErr err = {};
+
+    static const uint8_t negate[] = {0x66, 0x48, 0x0F, 0x7E, 0xC0,      // movq rax,  xmm0
+                                     0x48, 0x0F, 0xBA, 0xF8, 0x3F,      // btc  rax,  63
+                                     0x66, 0x48, 0x0F, 0x6E, 0xC0};     // movq xmm0, rax
+
+    BytecodeOp op = instruction->op;
+
+    switch (op)
+    {
+        case BytecodeOp::op_add:
+        case BytecodeOp::op_sub:
+        case BytecodeOp::op_mul:
+        case BytecodeOp::op_div:
+        {
+            uint8_t opcode = (op == BytecodeOp::op_add) ? SseAdd :
+                             (op == BytecodeOp::op_sub) ? SseSub :
+                             (op == BytecodeOp::op_mul) ? SseMul : SseDiv;
+
+            TREE_ASSERT(JitEmitSse(emitter, SseLoad, 0, instruction->left));
+            TREE_ASSERT(JitEmitSse(emitter, opcode,  0, instruction->right));
+            break;
+        }
+
+        case BytecodeOp::op_sqrt:
+        {
+            TREE_ASSERT(JitEmitSse(emitter, SseSqrt, 0, instruction->left));
+            break;
+        }
+
+        case BytecodeOp::op_neg:
+        {
+            TREE_ASSERT(JitEmitSse  (emitter, SseLoad, 0, instruction->left));
+            TREE_ASSERT(JitEmitBytes(emitter, negate, sizeof(negate)));
+            break;
+        }
+
+        case BytecodeOp::op_pow:
+        {
+            double (*power)(double, double) = pow;
+
+            TREE_ASSERT(JitEmitSse (emitter, SseLoad, 0, instruction->left));
+            TREE_ASSERT(JitEmitSse (emitter, SseLoad, 1, instruction->right));
+            TREE_ASSERT(JitEmitCall(emitter, (uint64_t) power));
+            break;
+        }
+
+        case BytecodeOp::op_ln:
+        case BytecodeOp::op_sin:
+        case BytecodeOp::op_cos:
+        case BytecodeOp::op_tg:
+        case BytecodeOp::op_ctg:
+        case BytecodeOp::op_sh:
+        case BytecodeOp::op_ch:
+        case BytecodeOp::op_th:
+        case BytecodeOp::op_cth:
+        case BytecodeOp::op_arcsin:
+        case BytecodeOp::op_arccos:
+        case BytecodeOp::op_arctg:
+        case BytecodeOp::op_arcctg:
+        {
+            TREE_ASSERT(JitEmitSse (emitter, SseLoad, 0, instruction->left));
+            TREE_ASSERT(JitEmitCall(emitter, (uint64_t) GetBytecodeFunction(op)));
+            break;
+        }
+
+        default: assert(0 && "undefined bytecode op in jit.\n"); break;
+    }
+
+    TREE_ASSERT(JitEmitSse(emitter, SseStore, 0, instruction->dest));
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// F2 0F opcode xmm, [rbx + 8 * reg]
+static TreeErr JitEmitSse(JitEmitter_t* emitter, uint8_t opcode, uint8_t xmm, uint32_t reg)
+{
+    assert(emitter);
+    assert(xmm < 8);
+    assert(reg < (UINT32_MAX >> 4));
+
+    uint32_t disp  = reg * (uint32_t) sizeof(Number);
+    uint8_t  modrm = (uint8_t) (0x83 | (xmm << 3));     // mod = 10 (disp32), rm = rbx
+
+    uint8_t bytes[] = {0xF2, 0x0F, opcode, modrm,
+                       (uint8_t) (disp), (uint8_t) (disp >> 8), (uint8_t) (disp >> 16), (uint8_t) (disp >> 24)};
+
+    return JitEmitBytes(emitter, bytes, sizeof(bytes));
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// mov rax, function; call rax
+static TreeErr JitEmitCall(JitEmitter_t* emitter, uint64_t address)
+{
+    assert(emitter);
+    assert(address);
+
+    uint8_t bytes[] = {0x48, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0,
+                       0xFF, 0xD0};
+
+    memcpy(bytes + 2, &address, sizeof(address));
+
+    return JitEmitBytes(emitter, bytes, sizeof(bytes));
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr JitEmitBytes(JitEmitter_t* emitter, const uint8_t* bytes, size_t size)
+{
+    assert(emitter);
+    assert(bytes);
+
+    TreeErr err = {};
+
+    if (emitter->size + size > emitter->capacity)
+    {
+        size_t capacity = emitter->capacity ? emitter->capacity : JitMinCapacity;
+        while (capacity < emitter->size + size) capacity *= 2;
+
+        uint8_t* code = (uint8_t*) realloc(emitter->code, capacity);
+        RETURN_IF_FALSE(code, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+        emitter->code     = code;
+        emitter->capacity = capacity;
+    }
+
+    memcpy(emitter->code + emitter->size, bytes, size);
+    emitter->size += size;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// memory is writable while code is copied, then only executable; if system forbids it, jit stays interpreter
+static TreeErr JitMakeExecutable(Jit_t* jit, const JitEmitter_t* emitter)
+{
+    assert(jit);
+    assert(emitter);
+
+    TreeErr err = {};
+
+    void* buffer = mmap(nullptr, emitter->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    RETURN_IF_TRUE(buffer == MAP_FAILED, err);
+
+    memcpy(buffer, emitter->code, emitter->size);
+
+    if (mprotect(buffer, emitter->size, PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(buffer, emitter->size);
+        return err;
+    }
+
+    jit->buffer     = (uint8_t*) buffer;
+    jit->bufferSize = emitter->size;
+
+    memcpy(&jit->code, &buffer, sizeof(jit->code));
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//============================== Benchmark =============================================================================================
+
+static Number TreeWalkEval(const Node_t* node, Number x, Number y)
+{
+    assert(node);
+
+    switch (node->type)
+    {
+        case NodeArgType::number:    return node->data.num;
+        case NodeArgType::variable:  return (node->data.var == Variable::x) ? x : y;
+        case NodeArgType::function:  return GetMathFunction(node->data.func)(TreeWalkEval(node->left, x, y));
+        case NodeArgType::operation:
+        {
+            Number left = TreeWalkEval(node->left, x, y);
+            RETURN_IF_FALSE(node->right, -left);
+
+            Number right = TreeWalkEval(node->right, x, y);
+
+            switch (node->data.oper)
+            {
+                case Operation::plus:  return left + right;
+                case Operation::minus: return left - right;
+                case Operation::mul:   return left * right;
+                case Operation::dive:  return left / right;
+                case Operation::power: return pow(left, right);
+                case Operation::undefined_operation:
+                default: assert(0 && "undefined operation in eval.\n"); break;
+            }
+            break;
+        }
+        case NodeArgType::undefined:
+        default: assert(0 && "undefined node type in eval.\n"); break;
+    }
+
+    return NAN;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,34 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <stdint.h>
+#include "Bytecode.h"
+
+// machine code works with register file of bytecode: registers[0] = x, registers[1] = y
+typedef void (*JitCode_t)(Number* registers);
+
+// if machine code can't be made (not x86-64 or no executable memory), code is nullptr and bytecode is interpreted
+struct Jit_t
+{
+    Bytecode_t bytecode;
+    uint8_t*   buffer;
+    size_t     bufferSize;
+    JitCode_t  code;
+};
+
+struct JitBenchmark_t
+{
+    size_t points;
+    double treeSeconds;
+    double bytecodeSeconds;
+    double jitSeconds;
+};
+
+TreeErr JitCompile   (const Tree_t* tree, Jit_t* jit);
+TreeErr JitDtor      (Jit_t* jit);
+Number  JitRun       (Jit_t* jit, Number x, Number y);
+
+// evaluates tree in 'points' points by tree walk, by bytecode interpreter and by jit
+TreeErr JitBenchmark (const Tree_t* tree, size_t points, JitBenchmark_t* bench);
+
+#endif
@@ -0,0 +1,178 @@
+#include <assert.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+#include "Polynomial.h"
+#include "../Common/GlobalInclude.h"
+
+
+#if defined(__x86_64__)
+static void PolynomialEvalAvx(const Polynomial_t* poly, const Number* x, Number* out, size_t count);
+static void PolynomialEvalSse(const Polynomial_t* poly, const Number* x, Number* out, size_t count);
+static bool IsAvx2Supported  ();
+#endif
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr PolynomialCtor(Polynomial_t* poly, size_t degree, Number centre)
+{
+    assert(poly);
+
+    TreeErr err = {};
+
+    poly->coeffs = (Number*) calloc(degree + 1, sizeof(Number));
+    poly->degree = degree;
+    poly->centre = centre;
+
+    if (!poly->coeffs) err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr PolynomialDtor(Polynomial_t* poly)
+{
+    assert(poly);
+
+    TreeErr err = {};
+
+    FREE(poly->coeffs);
+    poly->degree = 0;
+    poly->centre = 0;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+Number PolynomialEval(const Polynomial_t* poly, Number x)
+{
+    assert(poly);
+    assert(poly->coeffs);
+
+    Number t   = x - poly->centre;
+    Number sum = poly->coeffs[poly->degree];
+
+    for (size_t i = poly->degree; i > 0; i--) sum = poly->coeffs[i - 1] + t * sum;
+
+    return sum;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+void PolynomialEvalBatch(const Polynomial_t* poly, const Number* x, Number* out, size_t count)
+{
+    assert(poly);
+    assert(poly->coeffs);
+    assert(x);
+    assert(out);
+
+#if defined(__x86_64__)
+    if (IsAvx2Supported()) PolynomialEvalAvx(poly, x, out, count);
+    else                   PolynomialEvalSse(poly, x, out, count);
+#else
+    for (size_t lane = 0; lane < count; lane++) out[lane] = PolynomialEval(poly, x[lane]);
+#endif
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+#if defined(__x86_64__)
+
+// two independent horner chains of 4 lanes hide latency of mul and add; no fma, so result is the same as scalar one
+__attribute__((target("avx2")))
+static void PolynomialEvalAvx(const Polynomial_t* poly, const Number* x, Number* out, size_t count)
+{
+    assert(poly);
+    assert(x);
+    assert(out);
+
+    static const size_t Lanes = 8;
+
+    const Number* coeffs = poly->coeffs;
+    __m256d       centre = _mm256_set1_pd(poly->centre);
+
+    size_t lane = 0;
+
+    for (; lane + Lanes <= count; lane += Lanes)
+    {
+        __m256d t0 = _mm256_sub_pd(_mm256_loadu_pd(x + lane),     centre);
+        __m256d t1 = _mm256_sub_pd(_mm256_loadu_pd(x + lane + 4), centre);
+
+        __m256d sum0 = _mm256_set1_pd(coeffs[poly->degree]);
+        __m256d sum1 = sum0;
+
+        for (size_t i = poly->degree; i > 0; i--)
+        {
+            __m256d coeff = _mm256_set1_pd(coeffs[i - 1]);
+
+            sum0 = _mm256_add_pd(coeff, _mm256_mul_pd(t0, sum0));
+            sum1 = _mm256_add_pd(coeff, _mm256_mul_pd(t1, sum1));
+        }
+
+        _mm256_storeu_pd(out + lane,     sum0);
+        _mm256_storeu_pd(out + lane + 4, sum1);
+    }
+
+    PolynomialEvalSse(poly, x + lane, out + lane, count - lane);
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// sse2 is in every x86-64 cpu; two chains of 2 lanes, tail is scalar
+static void PolynomialEvalSse(const Polynomial_t* poly, const Number* x, Number* out, size_t count)
+{
+    assert(poly);
+    assert(x);
+    assert(out);
+
+    static const size_t Lanes = 4;
+
+    const Number* coeffs = poly->coeffs;
+    __m128d       centre = _mm_set1_pd(poly->centre);
+
+    size_t lane = 0;
+
+    for (; lane + Lanes <= count; lane += Lanes)
+    {
+        __m128d t0 = _mm_sub_pd(_mm_loadu_pd(x + lane),     centre);
+        __m128d t1 = _mm_sub_pd(_mm_loadu_pd(x + lane + 2), centre);
+
+        __m128d sum0 = _mm_set1_pd(coeffs[poly->degree]);
+        __m128d sum1 = sum0;
+
+        for (size_t i = poly->degree; i > 0; i--)
+        {
+            __m128d coeff = _mm_set1_pd(coeffs[i - 1]);
+
+            sum0 = _mm_add_pd(coeff, _mm_mul_pd(t0, sum0));
+            sum1 = _mm_add_pd(coeff, _mm_mul_pd(t1, sum1));
+        }
+
+        _mm_storeu_pd(out + lane,     sum0);
+        _mm_storeu_pd(out + lane + 2, sum1);
+    }
+
+    for (; lane < count; lane++) out[lane] = PolynomialEval(poly, x[lane]);
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsAvx2Supported()
+{
+    static const bool isSupported = __builtin_cpu_supports("avx2");
+    return isSupported;
+}
+
+#endif
+
+//--------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,21 @@
+#ifndef POLYNOMIAL_H
+#define POLYNOMIAL_H
+
+#include "../Tree/Tree.h"
+
+// dense polynomial p(x) = coeffs[0] + t (coeffs[1] + t (coeffs[2] + ...)), t = x - centre
+struct Polynomial_t
+{
+    Number* coeffs;
+    size_t  degree;
+    Number  centre;
+};
+
+TreeErr PolynomialCtor     (Polynomial_t* poly, size_t degree, Number centre);
+TreeErr PolynomialDtor     (Polynomial_t* poly);
+Number  PolynomialEval     (const Polynomial_t* poly, Number x);
+
+// out[i] = p(x[i]), avx2 or sse2 kernel is chosen at runtime
+void    PolynomialEvalBatch(const Polynomial_t* poly, const Number* x, Number* out, size_t count);
+
+#endif
@@ -0,0 +1,853 @@
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+#include "PowerSeries.h"
+#include "MathFunctions.h"
+#include "../Tree/Tree.h"
+#include "../Tree/LetTree.h"
+#include "Rational.h"
+#include "../Common/GlobalInclude.h"
+
+
+// series are arrays of n = order + 1 coefficients, every rule is O(n^2) recurrence
+struct SeriesCtx_t
+{
+    const LetTree_t* let;
+    Number**         bindings;  // series of every computed binding
+    Number           centre;
+    size_t           n;
+};
+
+// the same walk over exact rationals, only numbers, x, +, -, *, / and integer powers are allowed
+struct RationalCtx_t
+{
+    const LetTree_t* let;
+    Rational_t**     bindings;
+    Rational_t       centre;
+    size_t           n;
+};
+
+static TreeErr  SeriesNode       (SeriesCtx_t* ctx, const Node_t* node, size_t computed, Number* w);
+static TreeErr  SeriesOperation  (SeriesCtx_t* ctx, const Node_t* node, size_t computed, Number* w);
+static TreeErr  SeriesFunction   (Function func, const Number* u, Number* w, size_t n);
+static TreeErr  SeriesArcFunction(Function func, const Number* u, Number* w, size_t n);
+
+static void     SeriesMul        (const Number* u, const Number* v, Number* w, size_t n);
+static TreeErr  SeriesDiv        (const Number* u, const Number* v, Number* w, size_t n);
+static void     SeriesExp        (const Number* u, Number* w, size_t n);
+static TreeErr  SeriesLn         (const Number* u, Number* w, size_t n);
+static TreeErr  SeriesPowConst   (const Number* u, Number p, Number* w, size_t n);
+static void     SeriesSinCos     (const Number* u, Number* s, Number* c, size_t n, Number sign);
+static void     SeriesIntegrate  (const Number* u, const Number* g, Number w0, Number* w, size_t n);
+static bool     IsSeriesConst    (const Number* u, size_t n);
+static bool     IsSeriesFinite   (const Number* u, size_t n);
+static bool     IsZero           (Number num);
+
+static TreeErr  RationalNode     (RationalCtx_t* ctx, const Node_t* node, size_t computed, Rational_t* w);
+static TreeErr  RationalOperation(RationalCtx_t* ctx, const Node_t* node, size_t computed, Rational_t* w);
+static TreeErr  RationalSeriesMul(const Rational_t* u, const Rational_t* v, Rational_t* w, size_t n);
+static TreeErr  RationalSeriesDiv(const Rational_t* u, const Rational_t* v, Rational_t* w, size_t n);
+static TreeErr  RationalSeriesPow(const Rational_t* u, int64_t p, Rational_t* w, size_t n);
+static void     RationalClear    (Rational_t* w, size_t n);
+
+static const Number eps = 1e-12;
+
+#define _SERIES_ALLOC(series, n)   Number*     series = (Number*)     calloc(n, sizeof(Number));     RETURN_IF_FALSE(series, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__))
+// pair of buffers: if one of them is not allocated, other one is freed too
+#define _SERIES_ALLOC_PAIR(first, second, n)   Number*     first  = (Number*)     calloc(n, sizeof(Number));                                                           \
+                                               Number*     second = (Number*)     calloc(n, sizeof(Number));                                                           \
+                                               RETURN_IF_FALSE(first && second, err, free(first), free(second),                                                       \
+                                                               err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__))
+#define _RATIONAL_ALLOC_PAIR(first, second, n) Rational_t* first  = (Rational_t*) calloc(n, sizeof(Rational_t));                                                       \
+                                               Rational_t* second = (Rational_t*) calloc(n, sizeof(Rational_t));                                                       \
+                                               RETURN_IF_FALSE(first && second, err, free(first), free(second),                                                       \
+                                                               err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__))
+#define _RATIONAL(func)            do { err = func; RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err); } while (0)
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr PowerSeries(const Tree_t* tree, Number centre, size_t order, Number* coeffs)
+{
+    return PowerSeriesBatch(tree, &centre, 1, order, coeffs, nullptr);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// tree is walked in let-bound form, so series of common subtree is computed once.
+// let form and series of bindings are built once and are reused for every centre
+TreeErr PowerSeriesBatch(const Tree_t* tree, const Number* centres, size_t count, size_t order, Number* coeffs, TreeErr* errs)
+{
+    assert(tree);
+    assert(tree->root);
+    assert(centres);
+    assert(coeffs);
+
+    TreeErr err = {};
+
+    LetTree_t let = {};
+    TREE_ASSERT(LetTreeCtor(&let, tree));
+
+    SeriesCtx_t ctx = {&let, nullptr, 0, order + 1};
+
+    ctx.bindings = (Number**) calloc(let.size + 1, sizeof(Number*));
+    Number* pool = (Number*) calloc(let.size * ctx.n + 1, sizeof(Number));
+
+    if (!ctx.bindings || !pool)
+    {
+        FREE(ctx.bindings);
+        FREE(pool);
+        TREE_ASSERT(LetTreeDtor(&let));
+
+        err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    for (size_t i = 0; i < let.size; i++) ctx.bindings[i] = pool + i * ctx.n;
+
+    for (size_t centre_i = 0; centre_i < count; centre_i++)
+    {
+        ctx.centre = centres[centre_i];
+
+        Number* centreCoeffs = coeffs + centre_i * ctx.n;
+        TreeErr centreErr    = {};
+
+        for (size_t i = 0; i < let.size && centreErr.err == TreeErrorType::NO_ERR; i++)
+            centreErr = SeriesNode(&ctx, let.bindings[i], i, ctx.bindings[i]);
+
+        if (centreErr.err == TreeErrorType::NO_ERR) centreErr = SeriesNode(&ctx, let.result, let.size, centreCoeffs);
+
+        // pole, that is not exact 0 of divisor (tg at pi/2 in numbers), or overflow
+        if (centreErr.err == TreeErrorType::NO_ERR && !IsSeriesFinite(centreCoeffs, ctx.n))
+        {
+            centreErr.err = TreeErrorType::DIVISION_BY_0;
+            CodePlaceCtor(&centreErr.place, __FILE__, __LINE__, __func__);
+        }
+
+        if (centreErr.err != TreeErrorType::NO_ERR)
+        {
+            for (size_t k = 0; k < ctx.n; k++) centreCoeffs[k] = NAN;
+        }
+
+        if (errs) errs[centre_i] = centreErr;
+
+        else if (centreErr.err != TreeErrorType::NO_ERR)
+        {
+            err = centreErr;
+            break;
+        }
+    }
+
+    FREE(ctx.bindings);
+    FREE(pool);
+
+    TREE_ASSERT(LetTreeDtor(&let));
+
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// bindings with number < computed have their series already
+static TreeErr SeriesNode(SeriesCtx_t* ctx, const Node_t* node, size_t computed, Number* w)
+{
+    assert(ctx);
+    assert(node);
+    assert(w);
+
+    TreeErr err = {};
+
+    size_t n       = ctx->n;
+    size_t binding = LetTreeFind(ctx->let, node);
+
+    RETURN_IF_TRUE(binding < computed, err, memcpy(w, ctx->bindings[binding], n * sizeof(Number)));
+
+    memset(w, 0, n * sizeof(Number));
+
+    switch (node->type)
+    {
+        case NodeArgType::number:
+        {
+            w[0] = node->data.num;
+            break;
+        }
+
+        case NodeArgType::variable:
+        {
+            if (node->data.var != Variable::x) break;
+
+            w[0] = ctx->centre;
+            if (n > 1) w[1] = 1;
+            break;
+        }
+
+        case NodeArgType::function:
+        {
+            _SERIES_ALLOC(u, n);
+
+            err = SeriesNode(ctx, node->left, computed, u);
+            if (err.err == TreeErrorType::NO_ERR) err = SeriesFunction(node->data.func, u, w, n);
+
+            FREE(u);
+            break;
+        }
+
+        case NodeArgType::operation:
+        {
+            err = SeriesOperation(ctx, node, computed, w);
+            break;
+        }
+
+        case NodeArgType::undefined:
+        default: err.err = TreeErrorType::UNDEFINED_NODE_TYPE; break;
+    }
+
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr SeriesOperation(SeriesCtx_t* ctx, const Node_t* node, size_t computed, Number* w)
+{
+    assert(ctx);
+    assert(node);
+    assert(w);
+
+    TreeErr err = {};
+
+    size_t n = ctx->n;
+
+    _SERIES_ALLOC_PAIR(u, v, n);
+
+    err = SeriesNode(ctx, node->left, computed, u);
+    if (err.err == TreeErrorType::NO_ERR && node->right) err = SeriesNode(ctx, node->right, computed, v);
+
+    if (err.err == TreeErrorType::NO_ERR)
+    {
+        switch (node->right ? node->data.oper : Operation::undefined_operation)
+        {
+            case Operation::plus:  for (size_t k = 0; k < n; k++) w[k] = u[k] + v[k]; break;
+            case Operation::minus: for (size_t k = 0; k < n; k++) w[k] = u[k] - v[k]; break;
+            case Operation::mul:   SeriesMul(u, v, w, n);                              break;
+            case Operation::dive:  err = SeriesDiv(u, v, w, n);                        break;
+            case Operation::power:
+            {
+                if (IsSeriesConst(v, n))
+                {
+                    err = SeriesPowConst(u, v[0], w, n);
+                    break;
+                }
+
+                // u ^ v = exp(v * ln(u))
+                err = SeriesLn(u, w, n);
+                if (err.err != TreeErrorType::NO_ERR) break;
+
+                SeriesMul(v, w, u, n);
+                SeriesExp(u, w, n);
+                break;
+            }
+
+            // unary minus
+            case Operation::undefined_operation:
+            default: for (size_t k = 0; k < n; k++) w[k] = -u[k]; break;
+        }
+    }
+
+    FREE(u);
+    FREE(v);
+
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr SeriesFunction(Function func, const Number* u, Number* w, size_t n)
+{
+    assert(u);
+    assert(w);
+
+    TreeErr err = {};
+
+    _SERIES_ALLOC_PAIR(s, c, n);
+
+    switch (func)
+    {
+        case Function::Sqrt:  err = SeriesPowConst(u, 0.5, w, n);                                   break;
+        case Function::Ln:    err = SeriesLn(u, w, n);                                              break;
+        case Function::Sin:   SeriesSinCos(u, w, c, n, -1);                                         break;
+        case Function::Cos:   SeriesSinCos(u, s, w, n, -1);                                         break;
+        case Function::Tg:    SeriesSinCos(u, s, c, n, -1); err = SeriesDiv(s, c, w, n);            break;
+        case Function::Ctg:   SeriesSinCos(u, s, c, n, -1); err = SeriesDiv(c, s, w, n);            break;
+        case Function::Sh:    SeriesSinCos(u, w, c, n,  1);                                         break;
+        case Function::Ch:    SeriesSinCos(u, s, w, n,  1);                                         break;
+        case Function::Th:    SeriesSinCos(u, s, c, n,  1); err = SeriesDiv(s, c, w, n);            break;
+        case Function::Cth:   SeriesSinCos(u, s, c, n,  1); err = SeriesDiv(c, s, w, n);            break;
+        case Function::Arcsin:
+        case Function::Arccos:
+        case Function::Arctg:
+        case Function::Arcctg: err = SeriesArcFunction(func, u, w, n);                              break;
+        case Function::undefined_function:
+        default: err.err = TreeErrorType::UNDEFINED_FUNCTION_TYPE;                                  break;
+    }
+
+    FREE(s);
+    FREE(c);
+
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// w' = u' * g: g = +-1 / sqrt(1 - u^2) for arcsin and arccos, g = +-1 / (1 + u^2) for arctg and arcctg
+static TreeErr SeriesArcFunction(Function func, const Number* u, Number* w, size_t n)
+{
+    assert(u);
+    assert(w);
+
+    TreeErr err = {};
+
+    _SERIES_ALLOC_PAIR(q, g, n);
+
+    bool   isSin = (func == Function::Arcsin || func == Function::Arccos);
+    Number sign  = (func == Function::Arccos || func == Function::Arcctg) ? -1 : 1;
+
+    SeriesMul(u, u, q, n);
+
+    for (size_t k = 0; k < n; k++) q[k] = isSin ? -q[k] : q[k];
+    q[0] += 1;
+
+    err = SeriesPowConst(q, isSin ? -0.5 : -1, g, n);
+
+    if (err.err == TreeErrorType::NO_ERR)
+    {
+        for (size_t k = 0; k < n; k++) g[k] *= sign;
+
+        Number w0 = (func == Function::Arcsin) ? asin(u[0]) :
+                    (func == Function::Arccos) ? acos(u[0]) :
+                    (func == Function::Arctg)  ? atan(u[0]) : actg(u[0]);
+
+        SeriesIntegrate(u, g, w0, w, n);
+    }
+
+    FREE(q);
+    FREE(g);
+
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//============================== Series arithmetic =====================================================================================
+
+static void SeriesMul(const Number* u, const Number* v, Number* w, size_t n)
+{
+    assert(u);
+    assert(v);
+    assert(w);
+    assert(w != u && w != v);
+
+    for (size_t k = 0; k < n; k++)
+    {
+        Number sum = 0;
+        for (size_t j = 0; j <= k; j++) sum += u[j] * v[k - j];
+
+        w[k] = sum;
+    }
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// w * v = u: w_k = (u_k - sum(j = 1 .. k) v_j w_(k - j)) / v_0
+static TreeErr SeriesDiv(const Number* u, const Number* v, Number* w, size_t n)
+{
+    assert(u);
+    assert(v);
+    assert(w);
+    assert(w != u && w != v);
+
+    TreeErr err = {};
+
+    RETURN_IF_TRUE(IsZero(v[0]), err, err.err = TreeErrorType::DIVISION_BY_0, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    for (size_t k = 0; k < n; k++)
+    {
+        Number sum = u[k];
+        for (size_t j = 1; j <= k; j++) sum -= v[j] * w[k - j];
+
+        w[k] = sum / v[0];
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// w' = u' w
+static void SeriesExp(const Number* u, Number* w, size_t n)
+{
+    assert(u);
+    assert(w);
+    assert(w != u);
+
+    SeriesIntegrate(u, w, exp(u[0]), w, n);
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// u w' = u': w_k = (u_k - 1/k sum(j = 1 .. k - 1) j w_j u_(k - j)) / u_0
+static TreeErr SeriesLn(const Number* u, Number* w, size_t n)
+{
+    assert(u);
+    assert(w);
+    assert(w != u);
+
+    TreeErr err = {};
+
+    // ln(x) at 0 and at x < 0: centre is out of domain
+    RETURN_IF_TRUE(IsZero(u[0]) || u[0] < 0, err, err.err = TreeErrorType::DIVISION_BY_0, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    w[0] = log(u[0]);
+
+    for (size_t k = 1; k < n; k++)
+    {
+        Number sum = 0;
+        for (size_t j = 1; j < k; j++) sum += (Number) j * w[j] * u[k - j];
+
+        w[k] = (u[k] - sum / (Number) k) / u[0];
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// u = x^m r with r_0 != 0, then u^p = x^(mp) r^p and u r' p = ... gives
+// s_k = 1/(k r_0) sum(j = 1 .. k) (p j - (k - j)) r_j s_(k - j). If m > 0, p must be natural
+static TreeErr SeriesPowConst(const Number* u, Number p, Number* w, size_t n)
+{
+    assert(u);
+    assert(w);
+    assert(w != u);
+
+    TreeErr err = {};
+
+    memset(w, 0, n * sizeof(Number));
+
+    size_t m = 0;
+    while (m < n && IsZero(u[m])) m++;
+
+    bool isNatural = (p >= 0 && IsDoubleEqual(p, floor(p), eps));
+
+    if (m == n)
+    {
+        // 0 ^ p
+        RETURN_IF_FALSE(p >= 0, err, err.err = TreeErrorType::DIVISION_BY_0, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+        w[0] = IsZero(p) ? 1 : 0;
+
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    RETURN_IF_TRUE(m > 0 && !isNatural, err, err.err = TreeErrorType::DIVISION_BY_0, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    size_t shift = (m > 0) ? m * (size_t) round(p) : 0;
+    RETURN_IF_TRUE(m > 0 && shift >= n, err);
+
+    const Number* r    = u + m;
+    Number*       s    = w + shift;
+    size_t        size = n - shift;
+
+    // x^(1/2) at x < 0: real power of negative base is only whole one
+    RETURN_IF_TRUE(r[0] < 0 && !IsDoubleEqual(p, round(p), eps), err, err.err = TreeErrorType::DIVISION_BY_0,
+                                                                      CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    s[0] = pow(r[0], p);
+
+    for (size_t k = 1; k < size; k++)
+    {
+        Number sum = 0;
+        for (size_t j = 1; j <= k && j + m < n; j++) sum += (p * (Number) j - (Number) (k - j)) * r[j] * s[k - j];
+
+        s[k] = sum / ((Number) k * r[0]);
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// s' = u' c, c' = sign u' s: sign = -1 gives sin and cos, sign = 1 gives sh and ch
+static void SeriesSinCos(const Number* u, Number* s, Number* c, size_t n, Number sign)
+{
+    assert(u);
+    assert(s);
+    assert(c);
+
+    s[0] = (sign < 0) ? sin(u[0]) : sinh(u[0]);
+    c[0] = (sign < 0) ? cos(u[0]) : cosh(u[0]);
+
+    for (size_t k = 1; k < n; k++)
+    {
+        Number sumS = 0;
+        Number sumC = 0;
+
+        for (size_t j = 1; j <= k; j++)
+        {
+            sumS += (Number) j * u[j] * c[k - j];
+            sumC += (Number) j * u[j] * s[k - j];
+        }
+
+        s[k] = sumS / (Number) k;
+        c[k] = sign * sumC / (Number) k;
+    }
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// w' = u' g: w_k = 1/k sum(j = 1 .. k) j u_j g_(k - j); g can be w itself, its coefficients are ready in time
+static void SeriesIntegrate(const Number* u, const Number* g, Number w0, Number* w, size_t n)
+{
+    assert(u);
+    assert(g);
+    assert(w);
+
+    w[0] = w0;
+
+    for (size_t k = 1; k < n; k++)
+    {
+        Number sum = 0;
+        for (size_t j = 1; j <= k; j++) sum += (Number) j * u[j] * g[k - j];
+
+        w[k] = sum / (Number) k;
+    }
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsSeriesConst(const Number* u, size_t n)
+{
+    assert(u);
+
+    for (size_t k = 1; k < n; k++) RETURN_IF_FALSE(IsZero(u[k]), false);
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsSeriesFinite(const Number* u, size_t n)
+{
+    assert(u);
+
+    for (size_t k = 0; k < n; k++) RETURN_IF_FALSE(isfinite(u[k]), false);
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsZero(Number num)
+{
+    return fpclassify(num) == FP_ZERO;
+}
+
+//============================== Rational series =======================================================================================
+
+TreeErr PowerSeriesRational(const Tree_t* tree, Rational_t centre, size_t order, Rational_t* coeffs)
+{
+    assert(tree);
+    assert(tree->root);
+    assert(coeffs);
+
+    TreeErr err = {};
+
+    LetTree_t let = {};
+    TREE_ASSERT(LetTreeCtor(&let, tree));
+
+    RationalCtx_t ctx = {&let, nullptr, centre, order + 1};
+
+    ctx.bindings    = (Rational_t**) calloc(let.size + 1, sizeof(Rational_t*));
+    Rational_t* pool = (Rational_t*)  calloc(let.size * ctx.n + 1, sizeof(Rational_t));
+
+    if (!ctx.bindings || !pool)
+    {
+        FREE(ctx.bindings);
+        FREE(pool);
+        TREE_ASSERT(LetTreeDtor(&let));
+
+        err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    for (size_t i = 0; i < let.size; i++) ctx.bindings[i] = pool + i * ctx.n;
+
+    for (size_t i = 0; i < let.size && err.err == TreeErrorType::NO_ERR; i++)
+        err = RationalNode(&ctx, let.bindings[i], i, ctx.bindings[i]);
+
+    if (err.err == TreeErrorType::NO_ERR) err = RationalNode(&ctx, let.result, let.size, coeffs);
+
+    FREE(ctx.bindings);
+    FREE(pool);
+
+    TREE_ASSERT(LetTreeDtor(&let));
+
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr RationalNode(RationalCtx_t* ctx, const Node_t* node, size_t computed, Rational_t* w)
+{
+    assert(ctx);
+    assert(node);
+    assert(w);
+
+    TreeErr err = {};
+
+    size_t n       = ctx->n;
+    size_t binding = LetTreeFind(ctx->let, node);
+
+    RETURN_IF_TRUE(binding < computed, err, memcpy(w, ctx->bindings[binding], n * sizeof(Rational_t)));
+
+    RationalClear(w, n);
+
+    switch (node->type)
+    {
+        case NodeArgType::number:   err = RationalFromNumber(&w[0], node->data.num); break;
+        case NodeArgType::variable:
+        {
+            if (node->data.var != Variable::x) break;
+
+            w[0] = ctx->centre;
+            if (n > 1) w[1] = RationalOne;
+            break;
+        }
+
+        case NodeArgType::operation: err = RationalOperation(ctx, node, computed, w); break;
+        case NodeArgType::function:  err.err = TreeErrorType::NOT_RATIONAL_EXPRESSION; break;
+        case NodeArgType::undefined:
+        default: err.err = TreeErrorType::UNDEFINED_NODE_TYPE; break;
+    }
+
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr RationalOperation(RationalCtx_t* ctx, const Node_t* node, size_t computed, Rational_t* w)
+{
+    assert(ctx);
+    assert(node);
+    assert(w);
+
+    TreeErr err = {};
+
+    size_t n = ctx->n;
+
+    _RATIONAL_ALLOC_PAIR(u, v, n);
+
+    RationalClear(v, n);
+
+    err = RationalNode(ctx, node->left, computed, u);
+    if (err.err == TreeErrorType::NO_ERR && node->right) err = RationalNode(ctx, node->right, computed, v);
+
+    if (err.err == TreeErrorType::NO_ERR)
+    {
+        switch (node->right ? node->data.oper : Operation::undefined_operation)
+        {
+            case Operation::plus:  for (size_t k = 0; k < n && err.err == TreeErrorType::NO_ERR; k++) err = RationalAdd(u[k], v[k], &w[k]); break;
+            case Operation::minus: for (size_t k = 0; k < n && err.err == TreeErrorType::NO_ERR; k++) err = RationalSub(u[k], v[k], &w[k]); break;
+            case Operation::mul:   err = RationalSeriesMul(u, v, w, n); break;
+            case Operation::dive:  err = RationalSeriesDiv(u, v, w, n); break;
+            case Operation::power:
+            {
+                bool isConst = true;
+                for (size_t k = 1; k < n; k++) isConst = isConst && IsRationalZero(v[k]);
+
+                if (!isConst || v[0].den != 1) err.err = TreeErrorType::NOT_RATIONAL_EXPRESSION;
+                else                           err     = RationalSeriesPow(u, v[0].num, w, n);
+                break;
+            }
+
+            // unary minus
+            case Operation::undefined_operation:
+            default: for (size_t k = 0; k < n && err.err == TreeErrorType::NO_ERR; k++) err = RationalSub(RationalZero, u[k], &w[k]); break;
+        }
+    }
+
+    FREE(u);
+    FREE(v);
+
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr RationalSeriesMul(const Rational_t* u, const Rational_t* v, Rational_t* w, size_t n)
+{
+    assert(u);
+    assert(v);
+    assert(w);
+    assert(w != u && w != v);
+
+    TreeErr err = {};
+
+    for (size_t k = 0; k < n; k++)
+    {
+        Rational_t sum = RationalZero;
+
+        for (size_t j = 0; j <= k; j++)
+        {
+            if (IsRationalZero(u[j]) || IsRationalZero(v[k - j])) continue;
+
+            Rational_t term = {};
+            _RATIONAL(RationalMul(u[j], v[k - j], &term));
+            _RATIONAL(RationalAdd(sum, term, &sum));
+        }
+
+        w[k] = sum;
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr RationalSeriesDiv(const Rational_t* u, const Rational_t* v, Rational_t* w, size_t n)
+{
+    assert(u);
+    assert(v);
+    assert(w);
+    assert(w != u && w != v);
+
+    TreeErr err = {};
+
+    RETURN_IF_TRUE(IsRationalZero(v[0]), err, err.err = TreeErrorType::DIVISION_BY_0, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    for (size_t k = 0; k < n; k++)
+    {
+        Rational_t sum = u[k];
+
+        for (size_t j = 1; j <= k; j++)
+        {
+            if (IsRationalZero(v[j]) || IsRationalZero(w[k - j])) continue;
+
+            Rational_t term = {};
+            _RATIONAL(RationalMul(v[j], w[k - j], &term));
+            _RATIONAL(RationalSub(sum, term, &sum));
+        }
+
+        _RATIONAL(RationalDiv(sum, v[0], &w[k]));
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// binary powering, negative power is 1 / u^(-p)
+static TreeErr RationalSeriesPow(const Rational_t* u, int64_t p, Rational_t* w, size_t n)
+{
+    assert(u);
+    assert(w);
+    assert(w != u);
+
+    TreeErr err = {};
+
+    _RATIONAL_ALLOC_PAIR(base, temp, n);
+
+    memcpy(base, u, n * sizeof(Rational_t));
+
+    RationalClear(w, n);
+    w[0] = RationalOne;
+
+    uint64_t power = (p < 0) ? 0 - (uint64_t) p : (uint64_t) p;
+
+    while (power != 0 && err.err == TreeErrorType::NO_ERR)
+    {
+        if (power & 1)
+        {
+            err = RationalSeriesMul(w, base, temp, n);
+            memcpy(w, temp, n * sizeof(Rational_t));
+        }
+
+        power >>= 1;
+
+        if (power != 0 && err.err == TreeErrorType::NO_ERR)
+        {
+            err = RationalSeriesMul(base, base, temp, n);
+            memcpy(base, temp, n * sizeof(Rational_t));
+        }
+    }
+
+    if (p < 0 && err.err == TreeErrorType::NO_ERR)
+    {
+        RationalClear(base, n);
+        base[0] = RationalOne;
+
+        err = RationalSeriesDiv(base, w, temp, n);
+        memcpy(w, temp, n * sizeof(Rational_t));
+    }
+
+    FREE(base);
+    FREE(temp);
+
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static void RationalClear(Rational_t* w, size_t n)
+{
+    assert(w);
+
+    for (size_t k = 0; k < n; k++) w[k] = RationalZero;
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+#undef _SERIES_ALLOC
+#undef _SERIES_ALLOC_PAIR
+#undef _RATIONAL_ALLOC_PAIR
+#undef _RATIONAL
@@ -0,0 +1,18 @@
+#ifndef POWER_SERIES_H
+#define POWER_SERIES_H
+
+#include "../Tree/Tree.h"
+#include "Rational.h"
+
+// coeffs[k] = f^(k)(centre) / k!, k = 0 .. order. f is function of x, y is taken as 0, as in Taylor
+TreeErr PowerSeries     (const Tree_t* tree, Number centre, size_t order, Number* coeffs);
+
+// coeffs[i * (order + 1) + k] is coefficient k at centres[i]. Centre out of domain (pole, ln(x) at x <= 0, x^(1/2) at x < 0)
+// gives DIVISION_BY_0. errs[i] is error of centres[i], coefficients of failed centre are NAN, other centres go on.
+// errs can be nullptr, then error of first failed centre is returned
+TreeErr PowerSeriesBatch(const Tree_t* tree, const Number* centres, size_t count, size_t order, Number* coeffs, TreeErr* errs);
+
+// exact coefficients: only numbers, x, +, -, *, / and integer powers, else NOT_RATIONAL_EXPRESSION
+TreeErr PowerSeriesRational(const Tree_t* tree, Rational_t centre, size_t order, Rational_t* coeffs);
+
+#endif
@@ -0,0 +1,204 @@
+#include <assert.h>
+#include <math.h>
+#include "Rational.h"
+#include "../Common/GlobalInclude.h"
+
+
+static uint64_t Gcd(uint64_t first, uint64_t second);
+static uint64_t Abs(int64_t num);
+
+static const size_t MaxFractionSteps = 64;
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr RationalCtor(Rational_t* res, int64_t num, int64_t den)
+{
+    assert(res);
+
+    TreeErr err = {};
+
+    RETURN_IF_TRUE(den == 0,                            err, err.err = TreeErrorType::DIVISION_BY_0, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+    RETURN_IF_TRUE(num == INT64_MIN || den == INT64_MIN, err, err.err = TreeErrorType::RATIONAL_OVERFLOW, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    if (den < 0)
+    {
+        num = -num;
+        den = -den;
+    }
+
+    int64_t gcd = (int64_t) Gcd(Abs(num), Abs(den));
+
+    res->num = num / gcd;
+    res->den = den / gcd;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// continued fraction of num is cut at first convergent, that gives exactly num back, so 0.1 becomes 1/10
+TreeErr RationalFromNumber(Rational_t* res, Number num)
+{
+    assert(res);
+
+    TreeErr err = {};
+
+    RETURN_IF_FALSE(isfinite(num), err, err.err = TreeErrorType::NOT_RATIONAL_EXPRESSION, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    int64_t prevNum = 0, curNum = 1;
+    int64_t prevDen = 1, curDen = 0;
+
+    Number rest = num;
+
+    for (size_t step = 0; step < MaxFractionSteps; step++)
+    {
+        Number whole = floor(rest);
+        RETURN_IF_TRUE(fabs(whole) > (Number) (INT64_MAX / 2), err, err.err = TreeErrorType::RATIONAL_OVERFLOW, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+        int64_t part    = (int64_t) whole;
+        int64_t nextNum = 0;
+        int64_t nextDen = 0;
+
+        bool isOverflow = __builtin_mul_overflow(part, curNum, &nextNum) || __builtin_add_overflow(nextNum, prevNum, &nextNum) ||
+                          __builtin_mul_overflow(part, curDen, &nextDen) || __builtin_add_overflow(nextDen, prevDen, &nextDen);
+
+        RETURN_IF_TRUE(isOverflow, err, err.err = TreeErrorType::RATIONAL_OVERFLOW, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+        prevNum = curNum; curNum = nextNum;
+        prevDen = curDen; curDen = nextDen;
+
+        if (fpclassify((Number) curNum / (Number) curDen - num) == FP_ZERO) return RationalCtor(res, curNum, curDen);
+
+        Number frac = rest - whole;
+        RETURN_IF_TRUE(fpclassify(frac) == FP_ZERO, err, err.err = TreeErrorType::RATIONAL_OVERFLOW, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+        rest = 1 / frac;
+    }
+
+    err.err = TreeErrorType::RATIONAL_OVERFLOW;
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+Number RationalToNumber(Rational_t rational)
+{
+    return (Number) rational.num / (Number) rational.den;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+bool IsRationalZero(Rational_t rational)
+{
+    return rational.num == 0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// a/b + c/d = (a (d/g) + c (b/g)) / (b (d/g)), g = gcd(b, d)
+TreeErr RationalAdd(Rational_t first, Rational_t second, Rational_t* res)
+{
+    assert(res);
+
+    TreeErr err = {};
+
+    int64_t gcd         = (int64_t) Gcd((uint64_t) first.den, (uint64_t) second.den);
+    int64_t firstScale  = second.den / gcd;
+    int64_t secondScale = first.den  / gcd;
+
+    int64_t firstNum  = 0;
+    int64_t secondNum = 0;
+    int64_t num       = 0;
+    int64_t den       = 0;
+
+    bool isOverflow = __builtin_mul_overflow(first.num,  firstScale,  &firstNum)  ||
+                      __builtin_mul_overflow(second.num, secondScale, &secondNum) ||
+                      __builtin_add_overflow(firstNum,   secondNum,   &num)       ||
+                      __builtin_mul_overflow(first.den,  firstScale,  &den);
+
+    RETURN_IF_TRUE(isOverflow, err, err.err = TreeErrorType::RATIONAL_OVERFLOW, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    return RationalCtor(res, num, den);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr RationalSub(Rational_t first, Rational_t second, Rational_t* res)
+{
+    assert(res);
+
+    TreeErr err = {};
+
+    RETURN_IF_TRUE(second.num == INT64_MIN, err, err.err = TreeErrorType::RATIONAL_OVERFLOW, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    second.num = -second.num;
+
+    return RationalAdd(first, second, res);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+// cross gcds are cancelled before multiplication, so result is already reduced
+TreeErr RationalMul(Rational_t first, Rational_t second, Rational_t* res)
+{
+    assert(res);
+
+    TreeErr err = {};
+
+    int64_t firstGcd  = (int64_t) Gcd(Abs(first.num),  (uint64_t) second.den);
+    int64_t secondGcd = (int64_t) Gcd(Abs(second.num), (uint64_t) first.den);
+
+    int64_t num = 0;
+    int64_t den = 0;
+
+    bool isOverflow = __builtin_mul_overflow(first.num / firstGcd,  second.num / secondGcd, &num) ||
+                      __builtin_mul_overflow(first.den / secondGcd, second.den / firstGcd,  &den);
+
+    RETURN_IF_TRUE(isOverflow, err, err.err = TreeErrorType::RATIONAL_OVERFLOW, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    return RationalCtor(res, num, den);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr RationalDiv(Rational_t first, Rational_t second, Rational_t* res)
+{
+    assert(res);
+
+    TreeErr err = {};
+
+    RETURN_IF_TRUE(IsRationalZero(second), err, err.err = TreeErrorType::DIVISION_BY_0, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    Rational_t inverse = {};
+
+    err = RationalCtor(&inverse, second.den, second.num);
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    return RationalMul(first, inverse, res);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static uint64_t Gcd(uint64_t first, uint64_t second)
+{
+    while (second != 0)
+    {
+        uint64_t rest = first % second;
+
+        first  = second;
+        second = rest;
+    }
+
+    return (first == 0) ? 1 : first;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
+
+static uint64_t Abs(int64_t num)
+{
+    return (num < 0) ? 0 - (uint64_t) num : (uint64_t) num;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,27 @@
+#ifndef RATIONAL_H
+#define RATIONAL_H
+
+#include <stdint.h>
+#include "../Tree/Tree.h"
+
+// num / den, den > 0 and gcd(num, den) = 1; every operation reports RATIONAL_OVERFLOW instead of wrapping
+struct Rational_t
+{
+    int64_t num;
+    int64_t den;
+};
+
+static const Rational_t RationalZero = {0, 1};
+static const Rational_t RationalOne  = {1, 1};
+
+TreeErr RationalCtor      (Rational_t* res, int64_t num, int64_t den);
+TreeErr RationalFromNumber(Rational_t* res, Number num);
+Number  RationalToNumber  (Rational_t rational);
+bool    IsRationalZero    (Rational_t rational);
+
+TreeErr RationalAdd       (Rational_t first, Rational_t second, Rational_t* res);
+TreeErr RationalSub       (Rational_t first, Rational_t second, Rational_t* res);
+TreeErr RationalMul       (Rational_t first, Rational_t second, Rational_t* res);
+TreeErr RationalDiv       (Rational_t first, Rational_t second, Rational_t* res);
+
+#endif
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <string.h>
 #include <math.h>
@@ -6,9 +7,24 @@
 #include "../Tree/Tree.h"
 #include "../Tree/Tree.h"
 #include "../Tree/TreeDump.h"
+#include "../Tree/NodeTable.h"
 #include "MathFunctions.h"
+#include "CanonicalTree.h"
+#include "../Common/GlobalInclude.h"
 
-static TreeErr SimplifyTreeHelper                                  (Node_t* node);
+// nodes of tree in post-order: children of every node are before it
+struct SimplifyWorklist_t
+{
+    Node_t** nodes;
+    size_t   size;
+    size_t   capacity;
+};
+
+
+static TreeErr SimplifyWorklistFill                                (Node_t* node, SimplifyWorklist_t* list);
+static TreeErr SimplifyNode                                        (Node_t* node);
+static bool    IsNodeChanged                                       (const Node_t* old, const Node_t* node);
+static TreeErr SimplifyDagNode                                     (const Node_t* node, Node_t** simple, NodeMap_t* done);
 static TreeErr SimplifyOperation                                   (Node_t* node);
 
 static TreeErr SimplifyNodeTypeSubWith1ChildTypeNum                (Node_t* node);
@@ -34,7 +50,6 @@ static TreeErr SetNodeRightChild                                   (Node_t* node
 static TreeErr SimplifyFunction                                    (Node_t* node);
 static TreeErr SimplifyFunctionPattern                             (Node_t* node, Function function, bool* WasChange);
 
-static double (*GetMathFunction                                    (Function function)) (double);
 
 static bool    IsTypeNum                                           (const Node_t* node);
 static bool    IsTypeOperation                                     (const Node_t* node);
@@ -46,10 +61,22 @@ static bool    IsSomeToSimplifyInNodeTypeOperation                 (const Node_t
 static bool    IsNodeMinusWith1NumChild                            (const Node_t* node);
 static bool    HasNode1ChildTypeNumVal1                            (const Node_t* node);
 
-static Number  MakeArithmeticOperation             (Number firstOpearnd, Number secondOperand, Operation Operator);
+
+static TreeErr FlatSimplifyNode                                    (FlatTree_t* flat, FlatIndex_t node);
+static TreeErr FlatSimplifyOperation                               (FlatTree_t* flat, FlatIndex_t node);
+static TreeErr FlatSimplifyFunction                                (FlatTree_t* flat, FlatIndex_t node);
+static TreeErr FlatSimplifyChildVal0                               (FlatTree_t* flat, FlatIndex_t node);
+static TreeErr FlatSimplifyChildVal1                               (FlatTree_t* flat, FlatIndex_t node);
+static void    FlatSetNum                                          (FlatTree_t* flat, FlatIndex_t node, Number value);
+static void    FlatSetChild                                        (FlatTree_t* flat, FlatIndex_t node, FlatIndex_t child);
+static bool    IsFlatNum                                           (const FlatTree_t* flat, FlatIndex_t node);
+static bool    IsFlatNumVal                                        (const FlatTree_t* flat, FlatIndex_t node, Number value);
 
 static const Number eps = 0.0000000001;
 
+// rules can fail (e.g. on division by 0), error goes up to caller of SimplifyTree
+#define _SIMPLIFY(func) do { err = func; RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err); } while (0)
+
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
 TreeErr SimplifyTree(Tree_t* tree)
@@ -58,44 +85,175 @@ TreeErr SimplifyTree(Tree_t* tree)
 
     TreeErr err = {};
 
-    TREE_ASSERT(SimplifyTreeHelper(tree->root));
+    NodeArena_t* oldArena = NodeArenaSwitch(&tree->arena);
+
+    if (tree->arena.unique)
+    {
+        NodeMap_t done = {};
+        TREE_ASSERT(NodeMapCtor(&done, 0));
+        err = SimplifyDagNode(tree->root, &tree->root, &done);
+        TREE_ASSERT(NodeMapDtor(&done));
+    }
+    else
+    {
+        SimplifyWorklist_t list = {};
+        TREE_ASSERT(SimplifyWorklistFill(tree->root, &list));
+
+        for (size_t i = 0; i < list.size && err.err == TreeErrorType::NO_ERR; i++)
+        {
+            TREE_ASSERT(NodeUpdate(list.nodes[i]));
+            err = SimplifyNode(list.nodes[i]);
+        }
+
+        FREE(list.nodes);
+    }
+
+    NodeArenaSwitch(oldArena);
+
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    TREE_ASSERT(CanonicalTree(tree));
 
     return TREE_VERIF(tree, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr SimplifyTreeHelper(Node_t* node)
+static TreeErr SimplifyWorklistFill(Node_t* node, SimplifyWorklist_t* list)
 {
     assert(node);
+    assert(list);
 
     TreeErr err = {};
     NODE_RETURN_IF_ERR(node, err);
 
     if (node->left)
     {
-        TREE_ASSERT(SimplifyTreeHelper(node->left));
+        TREE_ASSERT(SimplifyWorklistFill(node->left, list));
     }
 
     if (node->right)
     {
-        TREE_ASSERT(SimplifyTreeHelper(node->right));
+        TREE_ASSERT(SimplifyWorklistFill(node->right, list));
     }
 
+    if (list->size == list->capacity)
+    {
+        size_t   capacity = list->capacity ? 2 * list->capacity : 64;
+        Node_t** nodes    = (Node_t**) realloc(list->nodes, capacity * sizeof(Node_t*));
+
+        RETURN_IF_FALSE(nodes, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+        list->nodes    = nodes;
+        list->capacity = capacity;
+    }
+
+    list->nodes[list->size++] = node;
+
+    return NODE_VERIF(node, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// rules are applied until node stops changing, because one rewrite can make another possible. Rules look only
+// at node and its children, so then only parent of node can become simplifiable, and parent is later in worklist.
+// Nodes, that rules free, are always under node, so they are already passed.
+static TreeErr SimplifyNode(Node_t* node)
+{
+    assert(node);
+
+    TreeErr err = {};
+
+    while (true)
+    {
+        Node_t old = *node;
+
+        NodeArgType type = node->type;
+
+        if (type == NodeArgType::operation)
+        {
+            _SIMPLIFY(SimplifyOperation(node));
+        }
+
+        else if (type == NodeArgType::function)
+        {
+            TREE_ASSERT(SimplifyFunction(node));
+        }
+
+        RETURN_IF_FALSE(IsNodeChanged(&old, node), NODE_VERIF(node, err));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsNodeChanged(const Node_t* old, const Node_t* node)
+{
+    assert(old);
+    assert(node);
+
+    RETURN_IF_FALSE(old->type  == node->type,  true);
+    RETURN_IF_FALSE(old->left  == node->left,  true);
+    RETURN_IF_FALSE(old->right == node->right, true);
+
+    return !NodeDataEqual(node->type, old->data, node->data);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// dag nodes are shared and can't be changed in place: rules work on scratch copy of node with already simplified
+// children, and result is interned again. Every shared node is simplified only once.
+static TreeErr SimplifyDagNode(const Node_t* node, Node_t** simple, NodeMap_t* done)
+{
+    assert(node);
+    assert(simple);
+    assert(done);
+
+    TreeErr err = {};
+    NODE_RETURN_IF_ERR(node, err);
+
+    Node_t* known = NodeMapFind(done, node);
+    RETURN_IF_TRUE(known, NODE_VERIF(known, err), *simple = known);
 
-    NodeArgType type = node->type;
+    Node_t* left  = nullptr;
+    Node_t* right = nullptr;
 
-    if (type == NodeArgType::operation)
+    if (node->left)
     {
-        TREE_ASSERT(SimplifyOperation(node));
+        _SIMPLIFY(SimplifyDagNode(node->left, &left, done));
     }
 
-    else if (type == NodeArgType::function)
+    if (node->right)
     {
-        TREE_ASSERT(SimplifyFunction(node));    
+        _SIMPLIFY(SimplifyDagNode(node->right, &right, done));
     }
 
-    return NODE_VERIF(node, err);
+    _SIMPLIFY(FoldNodeCtor(simple, node->type, node->data, left, right));
+    TREE_ASSERT(NodeMapInsert(done, node, *simple));
+
+    return NODE_VERIF(*simple, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// NodeCtor, that applies rules of SimplifyTree to new node: children must be already simplified, so unreduced
+// node is never created. Rules work on scratch node; children, that rule throws away, are freed (in dag - nothing).
+TreeErr FoldNodeCtor(Node_t** node, NodeArgType type, NodeData_t data, Node_t* left, Node_t* right)
+{
+    assert(node);
+
+    TreeErr err = {};
+
+    Node_t scratch = {};
+    scratch.type   = type;
+    scratch.data   = data;
+    scratch.left   = left;
+    scratch.right  = right;
+
+    _SIMPLIFY(SimplifyNode(&scratch));
+
+    TREE_ASSERT(NodeCtor(node, scratch.type, scratch.data, scratch.left, scratch.right));
+
+    return NODE_VERIF(*node, err);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -160,34 +318,6 @@ static TreeErr SimplifyFunctionPattern(Node_t* node, Function function, bool* Wa
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static double (*GetMathFunction(Function function)) (double)
-{
-    switch (function)
-    {
-        case Function::Sqrt:   return sqrt;
-        case Function::Ln:     return log;
-        case Function::Sin:    return sin;
-        case Function::Cos:    return cos;
-        case Function::Tg:     return tan;
-        case Function::Ctg:    return ctg;
-        case Function::Sh:     return sinh;
-        case Function::Ch:     return cosh;
-        case Function::Th:     return tanh;
-        case Function::Cth:    return ctgh;
-        case Function::Arcsin: return asin;
-        case Function::Arccos: return acos;
-        case Function::Arctg:  return atan;
-        case Function::Arcctg: return actg;
-        case Function::undefined_function:
-        default: assert(0 && "undefined function type"); break;
-    }
-
-    assert(0 && "we must be here");
-    return nullptr;
-}
-
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-
 static TreeErr SimplifyOperation(Node_t* node)
 {
     assert(node);
@@ -202,12 +332,12 @@ static TreeErr SimplifyOperation(Node_t* node)
 
     else if (HasNode2ChilrenTypesNum(node))
     {
-        TREE_ASSERT(SimplifyNodeTypeOpearationWith2ChildrenTypeNum(node));
+        _SIMPLIFY(SimplifyNodeTypeOpearationWith2ChildrenTypeNum(node));
     }
 
     else if (HasNodeChildTypeNumVal0(node))
     {
-        TREE_ASSERT(SimplifyNodeTypeOperationWithChildTypeNumVal0(node));
+        _SIMPLIFY(SimplifyNodeTypeOperationWithChildTypeNumVal0(node));
     }
 
     else if (HasNode1ChildTypeNumVal1(node))
@@ -266,6 +396,8 @@ static TreeErr SimplifyNodeTypeOpearationWith2ChildrenTypeNum(Node_t* node)
     Number    firstNum  = node->left->data.num;
     Number    secondNum = node->right->data.num;
 
+    RETURN_IF_TRUE(operation == Operation::dive && IsDoubleEqual(secondNum, 0, eps), err, err.err = TreeErrorType::DIVISION_BY_0, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
     Number    result    = MakeArithmeticOperation(firstNum, secondNum, operation);
 
     NodeDtor(node->left);
@@ -290,12 +422,12 @@ static TreeErr SimplifyNodeTypeOperationWithChildTypeNumVal0(Node_t* node)
 
     if (IsNodeTypeNumAndVal0(node->left))
     {
-        TREE_ASSERT(SimplifyLeftChildTypeNumVal0(node));
+        _SIMPLIFY(SimplifyLeftChildTypeNumVal0(node));
     }
 
     else if (IsNodeTypeNumAndVal0(node->right))
     {
-        TREE_ASSERT(SimplifyRightChildTypeNumVal0(node));
+        _SIMPLIFY(SimplifyRightChildTypeNumVal0(node));
     }
 
     return NODE_VERIF(node, err);    
@@ -444,7 +576,7 @@ static TreeErr SimplifyLeftChildTypeNumVal0(Node_t* node)
         case Operation::dive:
         case Operation::power: TREE_ASSERT(ReamakeNodeToTypeNumVal0(node));                         break;
         case Operation::plus:  TREE_ASSERT(SetNodeRightChild(node));                                break;
-        case Operation::minus: TREE_ASSERT(SwapNode(&node->left, &node->right)); FREE(node->right); break;
+        case Operation::minus: TREE_ASSERT(SwapNode(&node->left, &node->right)); TREE_ASSERT(NodeDtor(node->right)); node->right = nullptr; TREE_ASSERT(NodeUpdate(node)); break;
         case Operation::undefined_operation: err.err = UNDEFINED_OPERATION_TYPE;                    break;
         default: assert(0 && "You forgot about some operation.\n");                                 break;
     }
@@ -514,7 +646,7 @@ static TreeErr ReamakeNodeToTypeNumVal1(Node_t* node)
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static Number  MakeArithmeticOperation(Number firstOpearnd, Number secondOperand, Operation Operator)
+Number MakeArithmeticOperation(Number firstOpearnd, Number secondOperand, Operation Operator)
 {
     switch (Operator)
     {
@@ -665,3 +797,270 @@ static bool IsSomeToSimplifyInNodeTypeOperation(const Node_t* node)
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
+// the same rules as for pointer tree, but in one linear pass: children of node are already simplified, when it is reached.
+// node, that becomes its child, takes child's fields and child itself is dropped by compaction in the end
+TreeErr FlatSimplify(FlatTree_t* flat)
+{
+    assert(flat);
+
+    TreeErr err = {};
+
+    for (size_t i = 0; i < flat->size; i++)
+    {
+        _SIMPLIFY(FlatSimplifyNode(flat, (FlatIndex_t) i));
+    }
+
+    TREE_ASSERT(FlatTreeCompact(flat));
+
+    return FLAT_TREE_VERIF(flat, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// FlatNodePush, that simplifies pushed node at once. Children, that node throws away, stay unused until compaction
+TreeErr FlatFoldNodePush(FlatTree_t* flat, NodeArgType type, NodeData_t data, FlatIndex_t left, FlatIndex_t right, FlatIndex_t* index)
+{
+    assert(flat);
+    assert(index);
+
+    TreeErr err = {};
+
+    TREE_ASSERT(FlatNodePush(flat, type, data, left, right, index));
+    _SIMPLIFY(FlatSimplifyNode(flat, *index));
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// as SimplifyNode: rules are applied to node until it stops changing
+static TreeErr FlatSimplifyNode(FlatTree_t* flat, FlatIndex_t node)
+{
+    assert(flat);
+
+    TreeErr err = {};
+
+    while (true)
+    {
+        NodeArgType type  = flat->type [node];
+        NodeData_t  data  = flat->data [node];
+        FlatIndex_t left  = flat->left [node];
+        FlatIndex_t right = flat->right[node];
+
+        if (type == NodeArgType::operation)
+        {
+            _SIMPLIFY(FlatSimplifyOperation(flat, node));
+        }
+
+        else if (type == NodeArgType::function)
+        {
+            TREE_ASSERT(FlatSimplifyFunction(flat, node));
+        }
+
+        bool changed = (type  != flat->type [node]) ||
+                       (left  != flat->left [node]) ||
+                       (right != flat->right[node]) ||
+                       !NodeDataEqual(type, data, flat->data[node]);
+
+        RETURN_IF_FALSE(changed, err, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+    }
+}
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr FlatSimplifyFunction(FlatTree_t* flat, FlatIndex_t node)
+{
+    assert(flat);
+    assert(flat->type[node] == NodeArgType::function);
+
+    TreeErr err = {};
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+
+    FlatIndex_t arg = flat->left[node];
+
+    RETURN_IF_FALSE(IsFlatNum(flat, arg), err);
+
+    double (*mathFunction)(double) = GetMathFunction(flat->data[node].func);
+
+    FlatSetNum(flat, node, mathFunction(flat->data[arg].num));
+
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr FlatSimplifyOperation(FlatTree_t* flat, FlatIndex_t node)
+{
+    assert(flat);
+    assert(flat->type[node] == NodeArgType::operation);
+
+    TreeErr err = {};
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+
+    FlatIndex_t left  = flat->left [node];
+    FlatIndex_t right = flat->right[node];
+
+    Operation   oper  = flat->data[node].oper;
+
+    if (oper == Operation::minus && IsFlatNum(flat, left) && right == FlatNull)
+    {
+        FlatSetNum(flat, node, -flat->data[left].num);
+    }
+
+    else if (IsFlatNum(flat, left) && IsFlatNum(flat, right))
+    {
+        RETURN_IF_TRUE(oper == Operation::dive && IsFlatNumVal(flat, right, 0), err, err.err = TreeErrorType::DIVISION_BY_0);
+        FlatSetNum(flat, node, MakeArithmeticOperation(flat->data[left].num, flat->data[right].num, oper));
+    }
+
+    else if (IsFlatNumVal(flat, left, 0) || IsFlatNumVal(flat, right, 0))
+    {
+        _SIMPLIFY(FlatSimplifyChildVal0(flat, node));
+    }
+
+    else if (IsFlatNumVal(flat, left, 1) || IsFlatNumVal(flat, right, 1))
+    {
+        TREE_ASSERT(FlatSimplifyChildVal1(flat, node));
+    }
+
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr FlatSimplifyChildVal0(FlatTree_t* flat, FlatIndex_t node)
+{
+    assert(flat);
+
+    TreeErr err = {};
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+
+    FlatIndex_t left  = flat->left [node];
+    FlatIndex_t right = flat->right[node];
+
+    Operation   oper  = flat->data[node].oper;
+
+    if (IsFlatNumVal(flat, left, 0))
+    {
+        switch (oper)
+        {
+            case Operation::mul:
+            case Operation::dive:
+            case Operation::power: FlatSetNum(flat, node, 0);                                  break;
+            case Operation::plus:  FlatSetChild(flat, node, right);                            break;
+            case Operation::minus: flat->left[node] = right; flat->right[node] = FlatNull;     break;
+            case Operation::undefined_operation: err.err = UNDEFINED_OPERATION_TYPE;           break;
+            default: assert(0 && "You forgot about some operation.\n");                        break;
+        }
+
+        return err;
+    }
+
+    switch (oper)
+    {
+        case Operation::plus:
+        case Operation::minus: FlatSetChild(flat, node, left);                                 break;
+        case Operation::mul:   FlatSetNum(flat, node, 0);                                      break;
+        case Operation::power: FlatSetNum(flat, node, 1);                                      break;
+        case Operation::dive:  err.err = TreeErrorType::DIVISION_BY_0;                         break;
+        case Operation::undefined_operation: err.err = UNDEFINED_OPERATION_TYPE;               break;
+        default: assert(0 && "You forgot about some operation.\n");                            break;
+    }
+
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr FlatSimplifyChildVal1(FlatTree_t* flat, FlatIndex_t node)
+{
+    assert(flat);
+
+    TreeErr err = {};
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+
+    FlatIndex_t left  = flat->left [node];
+    FlatIndex_t right = flat->right[node];
+
+    Operation   oper  = flat->data[node].oper;
+
+    if (IsFlatNumVal(flat, left, 1))
+    {
+        switch (oper)
+        {
+            case Operation::plus:
+            case Operation::minus:
+            case Operation::dive:                                                      break;
+            case Operation::mul:    FlatSetChild(flat, node, right);                   break;
+            case Operation::power:  FlatSetNum(flat, node, 1);                         break;
+            case Operation::undefined_operation: err.err = UNDEFINED_OPERATION_TYPE;   break;
+            default: assert(0 && "You forgot about some operation.\n");                break;
+        }
+
+        return err;
+    }
+
+    switch (oper)
+    {
+        case Operation::plus:
+        case Operation::minus:                                                   break;
+        case Operation::mul:
+        case Operation::dive:
+        case Operation::power: FlatSetChild(flat, node, left);                   break;
+        case Operation::undefined_operation: err.err = UNDEFINED_OPERATION_TYPE; break;
+        default: assert(0 && "You forgot about some operation.\n");              break;
+    }
+
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static void FlatSetNum(FlatTree_t* flat, FlatIndex_t node, Number value)
+{
+    assert(flat);
+
+    flat->type [node]     = NodeArgType::number;
+    flat->data [node].num = value;
+    flat->left [node]     = FlatNull;
+    flat->right[node]     = FlatNull;
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static void FlatSetChild(FlatTree_t* flat, FlatIndex_t node, FlatIndex_t child)
+{
+    assert(flat);
+    assert(child < node);
+
+    flat->type [node] = flat->type [child];
+    flat->data [node] = flat->data [child];
+    flat->left [node] = flat->left [child];
+    flat->right[node] = flat->right[child];
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsFlatNum(const FlatTree_t* flat, FlatIndex_t node)
+{
+    assert(flat);
+
+    return (node != FlatNull) && (flat->type[node] == NodeArgType::number);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsFlatNumVal(const FlatTree_t* flat, FlatIndex_t node, Number value)
+{
+    assert(flat);
+
+    return IsFlatNum(flat, node) && IsDoubleEqual(flat->data[node].num, value, eps);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#undef _SIMPLIFY
@@ -2,7 +2,29 @@
 #define CLEAN_TREE_H
 
 #include "../Tree/Tree.h"
+#include "../Tree/FlatTree.h"
 
 TreeErr SimplifyTree    (Tree_t* tree);
+TreeErr FlatSimplify    (FlatTree_t* flat);
+TreeErr FoldNodeCtor    (Node_t** node, NodeArgType type, NodeData_t data, Node_t* left, Node_t* right);
+TreeErr FlatFoldNodePush(FlatTree_t* flat, NodeArgType type, NodeData_t data, FlatIndex_t left, FlatIndex_t right, FlatIndex_t* index);
+
+Number  MakeArithmeticOperation(Number firstOpearnd, Number secondOperand, Operation Operator);
+
+// like _MUL, _ADD... from Tree.h, but node is simplified by rules of SimplifyTree before it is created.
+// error of rules (e.g. division by 0) is returned from function, that uses them
+#define _FOLD_FUNC( node, val, left        ) do { NodeData_t data = {.func = val};                 TreeErr foldErr = FoldNodeCtor(node, NodeArgType::function,  data, left,  nullptr); RETURN_IF_TRUE(foldErr.err != TreeErrorType::NO_ERR, foldErr); } while(0)
+#define _FOLD_MUL(  node, left, right      ) do { NodeData_t data = {.oper = Operation::mul};      TreeErr foldErr = FoldNodeCtor(node, NodeArgType::operation, data, left,  right); RETURN_IF_TRUE(foldErr.err != TreeErrorType::NO_ERR, foldErr);   } while(0)
+#define _FOLD_DIV(  node, left, right      ) do { NodeData_t data = {.oper = Operation::dive};     TreeErr foldErr = FoldNodeCtor(node, NodeArgType::operation, data, left,  right); RETURN_IF_TRUE(foldErr.err != TreeErrorType::NO_ERR, foldErr);   } while(0)
+#define _FOLD_ADD(  node, left, right      ) do { NodeData_t data = {.oper = Operation::plus};     TreeErr foldErr = FoldNodeCtor(node, NodeArgType::operation, data, left,  right); RETURN_IF_TRUE(foldErr.err != TreeErrorType::NO_ERR, foldErr);   } while(0)
+#define _FOLD_SUB(  node, left, right      ) do { NodeData_t data = {.oper = Operation::minus};    TreeErr foldErr = FoldNodeCtor(node, NodeArgType::operation, data, left,  right); RETURN_IF_TRUE(foldErr.err != TreeErrorType::NO_ERR, foldErr);   } while(0)
+#define _FOLD_POW(  node, left, right      ) do { NodeData_t data = {.oper = Operation::power};    TreeErr foldErr = FoldNodeCtor(node, NodeArgType::operation, data, left,  right); RETURN_IF_TRUE(foldErr.err != TreeErrorType::NO_ERR, foldErr);   } while(0)
+
+#define _FLAT_FOLD_FUNC(flat, index, val, left    ) do { NodeData_t data = {.func = val};                 TREE_ASSERT(FlatFoldNodePush(flat, NodeArgType::function,  data, left, FlatNull, index)); } while(0)
+#define _FLAT_FOLD_MUL( flat, index, left, right  ) do { NodeData_t data = {.oper = Operation::mul};      TREE_ASSERT(FlatFoldNodePush(flat, NodeArgType::operation, data, left, right,    index)); } while(0)
+#define _FLAT_FOLD_DIV( flat, index, left, right  ) do { NodeData_t data = {.oper = Operation::dive};     TREE_ASSERT(FlatFoldNodePush(flat, NodeArgType::operation, data, left, right,    index)); } while(0)
+#define _FLAT_FOLD_ADD( flat, index, left, right  ) do { NodeData_t data = {.oper = Operation::plus};     TREE_ASSERT(FlatFoldNodePush(flat, NodeArgType::operation, data, left, right,    index)); } while(0)
+#define _FLAT_FOLD_SUB( flat, index, left, right  ) do { NodeData_t data = {.oper = Operation::minus};    TREE_ASSERT(FlatFoldNodePush(flat, NodeArgType::operation, data, left, right,    index)); } while(0)
+#define _FLAT_FOLD_POW( flat, index, left, right  ) do { NodeData_t data = {.oper = Operation::power};    TREE_ASSERT(FlatFoldNodePush(flat, NodeArgType::operation, data, left, right,    index)); } while(0)
 
 #endif
@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <math.h>
 #include "Differentiator.h"
 #include "Taylor.h"
 #include "../Tree/Tree.h"
@@ -6,128 +7,152 @@
 #include "SimplifyTree.h"
 #include "../Tree/TreeDump.h"
 #include "MathFunctions.h"
+#include "PowerSeries.h"
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr CreateNewNode       (const Tree_t* tree, Node_t** node, size_t degree);
-static Number  GetTaylorCoeff      (const Tree_t* tree);
-static TreeErr SetXnodes           (Node_t* node, Number valX);
+static TreeErr TaylorTreeCtor      (Tree_t* taylor, const Number* coeffs, size_t degree, Number centre);
+static TreeErr CreateNewNode       (Node_t** node, Number coeff, Number centre);
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-TreeErr Taylor(const Tree_t* tree, Tree_t* taylor, size_t degree)
+TreeErr Taylor(const Tree_t* tree, Tree_t* taylor, size_t degree, Number centre)
+{
+    return TaylorBatch(tree, taylor, &centre, 1, degree);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// coefficients are taken from truncated power series of tree, derivative trees are not built at all,
+// let form of tree is built once for all centres
+TreeErr TaylorBatch(const Tree_t* tree, Tree_t* taylors, const Number* centres, size_t count, size_t degree)
 {
     assert(tree);
     assert(tree->root);
-    assert(taylor);
+    assert(taylors);
+    assert(centres);
 
     TreeErr err = {};
 
-    Tree_t treeCopy = {};
-    TREE_ASSERT(NodeCopy(&treeCopy.root, tree->root));
-    Number coeff = GetTaylorCoeff(&treeCopy);
+    Number* coeffs = (Number*) calloc(count * (degree + 1), sizeof(Number));
+    RETURN_IF_FALSE(coeffs, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
 
-    _NUM(&taylor->root, coeff);
+    err = TaylorCoeffsBatch(tree, coeffs, centres, count, degree, nullptr);
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err, FREE(coeffs));
 
-    for (size_t degree_i = 1; degree_i <= degree; degree_i++)
-    {
-        TREE_ASSERT(Diff(&treeCopy));
-        TREE_ASSERT(SimplifyTree(&treeCopy));
+    for (size_t i = 0; i < count && err.err == TreeErrorType::NO_ERR; i++)
+        err = TaylorTreeCtor(&taylors[i], coeffs + i * (degree + 1), degree, centres[i]);
 
-        Node_t* node = {};
-        TREE_ASSERT(CreateNewNode(&treeCopy, &node, degree_i));
+    FREE(coeffs);
 
-        node->left = taylor->root;
-        TREE_ASSERT(SwapNode(&node, &taylor->root));
-    }
-
-    TREE_ASSERT(TreeDtor(&treeCopy));
-
-    return TREE_VERIF(taylor, err);
+    return err;
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr CreateNewNode(const Tree_t* tree, Node_t** node, size_t degree)
+TreeErr TaylorCoeffs(const Tree_t* tree, Number* coeffs, size_t degree, Number centre)
 {
-    assert(tree);
-    assert(tree->root);
-    assert(node);
-
-    TreeErr err = {};
-
-    Node_t* new_left  = {};
-    Node_t* new_right = {};
-
-    Node_t* new_right_left  = {};
-    Node_t* new_right_right = {};
-
-    Node_t* new_right_right_left  = {};
-    Node_t* new_right_right_right = {};
+    return PowerSeries(tree, centre, degree, coeffs);
+}
 
-    Node_t* new_right_left_left  = {};
-    Node_t* new_right_left_right = {};
+//-----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-    Number coeff = GetTaylorCoeff(tree);
-    Number fac   = factorial(degree);
+TreeErr TaylorCoeffsBatch(const Tree_t* tree, Number* coeffs, const Number* centres, size_t count, size_t degree, TreeErr* errs)
+{
+    return PowerSeriesBatch(tree, centres, count, degree, coeffs, errs);
+}
 
-    _VAR(&new_right_right_left,  Variable::x);
-    _NUM(&new_right_right_right, (Number) degree);
+//-----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-    _NUM(&new_right_left_left,  coeff);
-    _NUM(&new_right_left_right, fac);
+TreeErr TaylorRational(const Tree_t* tree, Rational_t* coeffs, size_t degree, Rational_t centre)
+{
+    return PowerSeriesRational(tree, centre, degree, coeffs);
+}
 
-    _DIV(&new_right_left,  new_right_left_left, new_right_left_right);
-    _POW(&new_right_right, new_right_right_left, new_right_right_right);   
+//-----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-    new_left = tree->root;
-    _MUL(&new_right, new_right_left, new_right_right);
+// coefficients go to dense polynomial as they are, no tree is built
+TreeErr TaylorPolynomial(const Tree_t* tree, Polynomial_t* poly, size_t degree, Number centre)
+{
+    assert(tree);
+    assert(tree->root);
+    assert(poly);
 
-    _ADD(node, new_left, new_right);
+    TreeErr err = PolynomialCtor(poly, degree, centre);
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
 
+    err = TaylorCoeffs(tree, poly->coeffs, degree, centre);
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err, PolynomialDtor(poly));
 
-    return NODE_VERIF(*node, err);
+    return err;
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static Number GetTaylorCoeff(const Tree_t* tree)
+// Horner form: c0 + t (c1 + t (c2 + ... + t cn)), t = x - centre, factorials are already in coefficients
+static TreeErr TaylorTreeCtor(Tree_t* taylor, const Number* coeffs, size_t degree, Number centre)
 {
-    assert(tree);
+    assert(taylor);
+    assert(coeffs);
+
+    TreeErr err = {};
 
-    Tree_t treeCopy = {};
-    TREE_ASSERT(NodeCopy(&treeCopy.root, tree->root));
+    NodeArena_t* oldArena = NodeArenaSwitch(&taylor->arena);
 
+    // errors are returned, not asserted, so arena of caller is restored on every way out
+    NodeData_t data = {.num = coeffs[degree]};
+    err = NodeCtor(&taylor->root, NodeArgType::number, data, nullptr, nullptr);
 
-    TREE_ASSERT(SetXnodes(treeCopy.root, 0));
-    TREE_ASSERT(SimplifyTree(&treeCopy));
+    for (size_t degree_i = degree; degree_i > 0 && err.err == TreeErrorType::NO_ERR; degree_i--)
+    {
+        err = CreateNewNode(&taylor->root, coeffs[degree_i - 1], centre);
+    }
 
-    Number coeff = treeCopy.root->data.num;
+    NodeArenaSwitch(oldArena);
 
-    TREE_ASSERT(TreeDtor(&treeCopy));
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
 
-    return coeff;
+    return TREE_VERIF(taylor, err);
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static TreeErr SetXnodes(Node_t* node, Number valX)
+// like _VAR, _NUM... from Tree.h, but error is returned to TaylorTreeCtor, that restores arena
+#define _TAYLOR_NODE(node, type, field, val, left, right) do { NodeData_t data = {.field = val};                                     \
+                                                               err = NodeCtor(node, NodeArgType::type, data, left, right);            \
+                                                               RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err); } while (0)
+
+// coeff + (x - centre) * node
+static TreeErr CreateNewNode(Node_t** node, Number coeff, Number centre)
 {
     assert(node);
 
     TreeErr err = {};
 
-    if (node->left)  TREE_ASSERT(SetXnodes(node->left,  valX));
-    if (node->right) TREE_ASSERT(SetXnodes(node->right, valX));
+    Node_t* new_left  = {};
+    Node_t* new_right = {};
+
+    Node_t* new_right_left = {};
 
-    NodeArgType type = node->type;
+    _TAYLOR_NODE(&new_right_left, variable, var, Variable::x, nullptr, nullptr);
 
-    if (type == NodeArgType::variable)
+    if (fpclassify(centre) != FP_ZERO)
     {
-        _SET_NUM(node, valX);
+        Node_t* x    = new_right_left;
+        Node_t* base = {};
+
+        _TAYLOR_NODE(&base,           number,    num,  centre,           nullptr, nullptr);
+        _TAYLOR_NODE(&new_right_left, operation, oper, Operation::minus, x,       base);
     }
 
-    return NODE_VERIF(node, err);
+    _TAYLOR_NODE(&new_left,  number,    num,  coeff,          nullptr,        nullptr);
+    _TAYLOR_NODE(&new_right, operation, oper, Operation::mul, new_right_left, *node);
+
+    _TAYLOR_NODE(node, operation, oper, Operation::plus, new_left, new_right);
+
+    return NODE_VERIF(*node, err);
 }
 
+#undef _TAYLOR_NODE
+
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -2,7 +2,25 @@
 #define TAYLOR_R
 
 #include "../Tree/Tree.h"
+#include "Polynomial.h"
+#include "Rational.h"
 
-TreeErr Taylor(const Tree_t* tree, Tree_t* taylor, size_t degree);
+// taylor is polynomial of (x - centre) in Horner form
+TreeErr Taylor     (const Tree_t* tree, Tree_t* taylor, size_t degree, Number centre);
+
+// taylors[i] is expansion at centres[i], derivative work is shared by all of them. Trees are built only if every centre is in domain
+TreeErr TaylorBatch(const Tree_t* tree, Tree_t* taylors, const Number* centres, size_t count, size_t degree);
+
+// coefficients only, no nodes are built: coeffs[k] is coefficient of (x - centre)^k, k = 0 .. degree
+TreeErr TaylorCoeffs     (const Tree_t* tree, Number* coeffs, size_t degree, Number centre);
+
+// coeffs[i * (degree + 1) + k] is coefficient k at centres[i], errs[i] is error of centres[i] (see PowerSeriesBatch)
+TreeErr TaylorCoeffsBatch(const Tree_t* tree, Number* coeffs, const Number* centres, size_t count, size_t degree, TreeErr* errs);
+
+// exact coefficients of rational expression: numbers, x, +, -, *, / and integer powers only
+TreeErr TaylorRational   (const Tree_t* tree, Rational_t* coeffs, size_t degree, Rational_t centre);
+
+// taylor polynomial for PolynomialEval and PolynomialEvalBatch
+TreeErr TaylorPolynomial(const Tree_t* tree, Polynomial_t* poly, size_t degree, Number centre);
 
 #endif
\ No newline at end of file
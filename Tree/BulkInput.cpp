@@ -0,0 +1,105 @@
+#include <assert.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "BulkInput.h"
+#include "Tree.h"
+#include "../Common/GlobalInclude.h"
+
+
+static const char* const BulkSeparators = "$\n";
+static const char* const BulkPassSymbols = "$\n ";
+
+//============================== Bulk input ================================================================================================================================
+
+TreeErr BulkInputCtor(BulkInput_t* bulk, const char* file)
+{
+    assert(bulk);
+    assert(file);
+
+    TreeErr err = {};
+
+    *bulk = {};
+
+    int fd = open(file, O_RDONLY);
+    RETURN_IF_TRUE(fd < 0, err, err.err = TreeErrorType::INPUT_FILE_READ_FAILED, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    struct stat fileStat = {};
+    RETURN_IF_TRUE(fstat(fd, &fileStat) != 0, err, close(fd), err.err = TreeErrorType::INPUT_FILE_READ_FAILED, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    size_t size       = (size_t) fileStat.st_size;
+    size_t pageSize   = (size_t) sysconf(_SC_PAGESIZE);
+    size_t mappedSize = (size / pageSize + 1) * pageSize;
+
+    // zeroed region is reserved first and file is mapped over its beginning,
+    // so byte after file is '\0' even if file size is multiple of page size
+    void* region = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    RETURN_IF_TRUE(region == MAP_FAILED, err, close(fd), err.err = TreeErrorType::INPUT_FILE_READ_FAILED, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    if (size > 0 && mmap(region, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        munmap(region, mappedSize);
+        close(fd);
+        err.err = TreeErrorType::INPUT_FILE_READ_FAILED;
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    close(fd);
+
+    if (size > 0) madvise(region, size, MADV_SEQUENTIAL);
+
+    bulk->data       = (char*) region;
+    bulk->size       = size;
+    bulk->mappedSize = mappedSize;
+    bulk->pos        = 0;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr BulkInputDtor(BulkInput_t* bulk)
+{
+    assert(bulk);
+
+    TreeErr err = {};
+
+    if (bulk->data) munmap(bulk->data, bulk->mappedSize);
+
+    *bulk = {};
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// data is '\0' terminated, so separators are found by strspn and strcspn
+bool BulkInputNext(BulkInput_t* bulk, BulkExpression_t* expression)
+{
+    assert(bulk);
+    assert(bulk->data);
+    assert(expression);
+
+    const char* data = bulk->data;
+
+    RETURN_IF_TRUE(bulk->pos >= bulk->size, false);
+
+    bulk->pos += strspn(data + bulk->pos, BulkPassSymbols);
+    RETURN_IF_TRUE(bulk->pos >= bulk->size, false);
+
+    size_t size = strcspn(data + bulk->pos, BulkSeparators);
+
+    expression->start = data + bulk->pos;
+    expression->size  = size;
+
+    bulk->pos += size + 1;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
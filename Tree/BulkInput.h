@@ -0,0 +1,39 @@
+#ifndef BULK_INPUT_H
+#define BULK_INPUT_H
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "Tree.h"
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// input file is mapped, not read: expressions are parsed right from mapped pages.
+// file is mapped into zeroed region one byte longer, so data[size] is always '\0'
+struct BulkInput_t
+{
+    char*       data;       // mapped read only
+    size_t      size;
+    size_t      mappedSize;
+    size_t      pos;        // next expression is searched from here
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// expression is start[0, size), it ends with '$', '\n' or end of file, separator itself is not included
+struct BulkExpression_t
+{
+    const char* start;
+    size_t      size;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr BulkInputCtor  (BulkInput_t* bulk, const char* file);
+TreeErr BulkInputDtor  (BulkInput_t* bulk);
+
+// returns false, when file is over; empty lines are skipped
+bool    BulkInputNext  (BulkInput_t* bulk, BulkExpression_t* expression);
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#endif
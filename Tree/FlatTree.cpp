@@ -0,0 +1,374 @@
+#include <assert.h>
+#include <string.h>
+#include "FlatTree.h"
+#include "Tree.h"
+#include "../Common/GlobalInclude.h"
+
+
+static TreeErr FlatTreeReserve    (FlatTree_t* flat, size_t capacity);
+static TreeErr TreeToFlatHelper   (const Node_t* node, FlatTree_t* flat, FlatIndex_t* index);
+static void    FlatNodeView       (const FlatTree_t* flat, FlatIndex_t node, Node_t* view);
+
+static const size_t FlatMinCapacity = 64;
+
+//============================== Flat tree functions =======================================================================================================================
+
+TreeErr FlatTreeCtor(FlatTree_t* flat, size_t capacity)
+{
+    assert(flat);
+
+    TreeErr err = {};
+
+    *flat = {};
+
+    TREE_ASSERT(FlatTreeReserve(flat, capacity < FlatMinCapacity ? FlatMinCapacity : capacity));
+
+    return FLAT_TREE_VERIF(flat, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr FlatTreeDtor(FlatTree_t* flat)
+{
+    assert(flat);
+
+    TreeErr err = {};
+
+    FREE(flat->type);
+    FREE(flat->data);
+    FREE(flat->left);
+    FREE(flat->right);
+
+    flat->size     = 0;
+    flat->capacity = 0;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr FlatNodePush(FlatTree_t* flat, NodeArgType type, NodeData_t data, FlatIndex_t left, FlatIndex_t right, FlatIndex_t* index)
+{
+    assert(flat);
+    assert(index);
+    assert(left  == FlatNull || left  < flat->size);
+    assert(right == FlatNull || right < flat->size);
+
+    TreeErr err = {};
+
+    if (flat->size == flat->capacity)
+    {
+        TREE_ASSERT(FlatTreeReserve(flat, 2 * flat->capacity));
+    }
+
+    size_t pos = flat->size;
+
+    flat->type [pos] = type;
+    flat->data [pos] = data;
+    flat->left [pos] = left;
+    flat->right[pos] = right;
+
+    flat->size++;
+
+    *index = (FlatIndex_t) pos;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// subtree is contiguous range, that starts in its leftmost leaf, so copy is one linear pass with shifted child indexes.
+// src must be compacted (or built only by pushes), src and flat may be the same tree
+TreeErr FlatSubTreeCopy(FlatTree_t* flat, const FlatTree_t* src, FlatIndex_t node, FlatIndex_t* copy)
+{
+    assert(flat);
+    assert(src);
+    assert(copy);
+    assert(node < src->size);
+
+    TreeErr err = {};
+
+    FlatIndex_t first = node;
+
+    while (true)
+    {
+        if      (src->left [first] != FlatNull) first = src->left [first];
+        else if (src->right[first] != FlatNull) first = src->right[first];
+        else break;
+    }
+
+    size_t count = (size_t) (node - first) + 1;
+
+    if (flat->size + count > flat->capacity)
+    {
+        size_t capacity = 2 * flat->capacity;
+        while (capacity < flat->size + count) capacity *= 2;
+
+        TREE_ASSERT(FlatTreeReserve(flat, capacity));
+    }
+
+    FlatIndex_t base = (FlatIndex_t) flat->size;
+
+    for (FlatIndex_t i = first; i <= node; i++)
+    {
+        size_t pos = flat->size;
+
+        FlatIndex_t left  = src->left [i];
+        FlatIndex_t right = src->right[i];
+
+        flat->type [pos] = src->type[i];
+        flat->data [pos] = src->data[i];
+        flat->left [pos] = (left  == FlatNull) ? FlatNull : left  - first + base;
+        flat->right[pos] = (right == FlatNull) ? FlatNull : right - first + base;
+
+        flat->size++;
+    }
+
+    *copy = (FlatIndex_t) (flat->size - 1);
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// drops nodes, that are unreachable from root (last node), keeping post-order of the rest
+TreeErr FlatTreeCompact(FlatTree_t* flat)
+{
+    assert(flat);
+
+    TreeErr err = {};
+
+    size_t size = flat->size;
+
+    RETURN_IF_TRUE(size == 0, FLAT_TREE_VERIF(flat, err));
+
+    FlatIndex_t* remap = (FlatIndex_t*) calloc(size, sizeof(FlatIndex_t));
+
+    if (!remap)
+    {
+        err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    remap[size - 1] = 1;
+
+    for (size_t i = size; i-- > 0; )
+    {
+        if (!remap[i]) continue;
+
+        if (flat->left [i] != FlatNull) remap[flat->left [i]] = 1;
+        if (flat->right[i] != FlatNull) remap[flat->right[i]] = 1;
+    }
+
+    size_t newSize = 0;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        if (!remap[i]) continue;
+
+        FlatIndex_t left  = flat->left [i];
+        FlatIndex_t right = flat->right[i];
+
+        flat->type [newSize] = flat->type[i];
+        flat->data [newSize] = flat->data[i];
+        flat->left [newSize] = (left  == FlatNull) ? FlatNull : remap[left];
+        flat->right[newSize] = (right == FlatNull) ? FlatNull : remap[right];
+
+        remap[i] = (FlatIndex_t) newSize;
+        newSize++;
+    }
+
+    flat->size = newSize;
+
+    FREE(remap);
+
+    return FLAT_TREE_VERIF(flat, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+FlatIndex_t FlatTreeRoot(const FlatTree_t* flat)
+{
+    assert(flat);
+    assert(flat->size);
+
+    return (FlatIndex_t) (flat->size - 1);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr FlatTreeReserve(FlatTree_t* flat, size_t capacity)
+{
+    assert(flat);
+    assert(capacity >= flat->size);
+    assert(capacity <= FlatNull);
+
+    TreeErr err = {};
+
+    NodeArgType* type  = (NodeArgType*) realloc(flat->type,  capacity * sizeof(NodeArgType));
+    if (type)  flat->type  = type;
+
+    NodeData_t*  data  = (NodeData_t*)  realloc(flat->data,  capacity * sizeof(NodeData_t));
+    if (data)  flat->data  = data;
+
+    FlatIndex_t* left  = (FlatIndex_t*) realloc(flat->left,  capacity * sizeof(FlatIndex_t));
+    if (left)  flat->left  = left;
+
+    FlatIndex_t* right = (FlatIndex_t*) realloc(flat->right, capacity * sizeof(FlatIndex_t));
+    if (right) flat->right = right;
+
+    if (!type || !data || !left || !right)
+    {
+        err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    flat->capacity = capacity;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//============================== Tree <-> flat tree ========================================================================================================================
+
+TreeErr TreeToFlat(const Tree_t* tree, FlatTree_t* flat)
+{
+    assert(tree);
+    assert(tree->root);
+    assert(flat);
+
+    TreeErr err = {};
+
+    TREE_ASSERT(FlatTreeCtor(flat, tree->size));
+
+    FlatIndex_t root = FlatNull;
+    TREE_ASSERT(TreeToFlatHelper(tree->root, flat, &root));
+
+    return FLAT_TREE_VERIF(flat, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr TreeToFlatHelper(const Node_t* node, FlatTree_t* flat, FlatIndex_t* index)
+{
+    assert(node);
+    assert(flat);
+    assert(index);
+
+    TreeErr err = {};
+    NODE_RETURN_IF_ERR(node, err);
+
+    FlatIndex_t left  = FlatNull;
+    FlatIndex_t right = FlatNull;
+
+    if (node->left)
+    {
+        TREE_ASSERT(TreeToFlatHelper(node->left, flat, &left));
+    }
+
+    if (node->right)
+    {
+        TREE_ASSERT(TreeToFlatHelper(node->right, flat, &right));
+    }
+
+    TREE_ASSERT(FlatNodePush(flat, node->type, node->data, left, right, index));
+
+    return NODE_VERIF(node, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// flat must be a tree (compacted, every node has one parent), nodes are created in tree's own arena
+TreeErr FlatToTree(const FlatTree_t* flat, Tree_t* tree)
+{
+    assert(flat);
+    assert(flat->size);
+    assert(tree);
+    assert(!tree->root);
+
+    TreeErr err = {};
+
+    Node_t** nodes = (Node_t**) calloc(flat->size, sizeof(Node_t*));
+
+    if (!nodes)
+    {
+        err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    NodeArena_t* oldArena = NodeArenaSwitch(&tree->arena);
+
+    for (size_t i = 0; i < flat->size; i++)
+    {
+        FlatIndex_t left  = flat->left [i];
+        FlatIndex_t right = flat->right[i];
+
+        TREE_ASSERT(NodeCtor(&nodes[i], flat->type[i], flat->data[i], (left  == FlatNull) ? nullptr : nodes[left],
+                                                                       (right == FlatNull) ? nullptr : nodes[right]));
+    }
+
+    NodeArenaSwitch(oldArena);
+
+    tree->root = nodes[flat->size - 1];
+    tree->size = flat->size;
+
+    FREE(nodes);
+
+    return TREE_VERIF(tree, err);
+}
+
+//============================== Verification ==============================================================================================================================
+
+TreeErr FlatTreeVerif(const FlatTree_t* flat, TreeErr* err, const char* file, const int line, const char* func)
+{
+    assert(flat);
+    assert(err);
+    assert(file);
+    assert(func);
+
+    CodePlaceCtor(&err->place, file, line, func);
+
+    RETURN_IF_TRUE(err->err != TreeErrorType::NO_ERR, *err);
+
+    for (size_t i = 0; i < flat->size; i++)
+    {
+        FlatIndex_t left  = flat->left [i];
+        FlatIndex_t right = flat->right[i];
+
+        RETURN_IF_FALSE(left  == FlatNull || left  < i, *err, err->err = TreeErrorType::FLAT_CHILD_INDEX_INCORRECT);
+        RETURN_IF_FALSE(right == FlatNull || right < i, *err, err->err = TreeErrorType::FLAT_CHILD_INDEX_INCORRECT);
+
+        Node_t view = {};
+        FlatNodeView(flat, (FlatIndex_t) i, &view);
+
+        NodeVerif(&view, err, file, line, func);
+        RETURN_IF_TRUE(err->err != TreeErrorType::NO_ERR, *err);
+    }
+
+    return *err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// NodeVerif checks only existence of children, so view points to itself instead of real child nodes
+static void FlatNodeView(const FlatTree_t* flat, FlatIndex_t node, Node_t* view)
+{
+    assert(flat);
+    assert(view);
+    assert(node < flat->size);
+
+    view->type  = flat->type[node];
+    view->data  = flat->data[node];
+    view->left  = (flat->left [node] == FlatNull) ? nullptr : view;
+    view->right = (flat->right[node] == FlatNull) ? nullptr : view;
+
+    return;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,59 @@
+#ifndef FLAT_TREE_H
+#define FLAT_TREE_H
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "Tree.h"
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+typedef uint32_t FlatIndex_t;
+
+static const FlatIndex_t FlatNull = UINT32_MAX;
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// tree in structure-of-arrays layout: node i is (type[i], data[i], left[i], right[i]), FlatNull is 'no child'.
+// nodes are stored in post-order, so children always have smaller index than parent and root is the last node.
+// every subtree is a contiguous range of indexes, that ends with its root
+struct FlatTree_t
+{
+    NodeArgType* type;
+    NodeData_t*  data;
+    FlatIndex_t* left;
+    FlatIndex_t* right;
+    size_t       size;
+    size_t       capacity;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr     FlatTreeCtor     (FlatTree_t* flat, size_t capacity);
+TreeErr     FlatTreeDtor     (FlatTree_t* flat);
+TreeErr     FlatNodePush     (FlatTree_t* flat, NodeArgType type, NodeData_t data, FlatIndex_t left, FlatIndex_t right, FlatIndex_t* index);
+TreeErr     FlatSubTreeCopy  (FlatTree_t* flat, const FlatTree_t* src, FlatIndex_t node, FlatIndex_t* copy);
+TreeErr     FlatTreeCompact  (FlatTree_t* flat);
+FlatIndex_t FlatTreeRoot     (const FlatTree_t* flat);
+
+TreeErr     TreeToFlat       (const Tree_t* tree, FlatTree_t* flat);
+TreeErr     FlatToTree       (const FlatTree_t* flat, Tree_t* tree);
+
+TreeErr     FlatTreeVerif    (const FlatTree_t* flat, TreeErr* err, const char* file, const int line, const char* func);
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#define FLAT_TREE_VERIF(FlatPtr, Err) FlatTreeVerif(FlatPtr, &Err, __FILE__, __LINE__, __func__)
+
+
+#define _FLAT_NUM( flat, index, val               ) do { NodeData_t data = {.num  = val};                 TREE_ASSERT(FlatNodePush(flat, NodeArgType::number,    data, FlatNull, FlatNull, index)); } while(0)
+#define _FLAT_FUNC(flat, index, val, left         ) do { NodeData_t data = {.func = val};                 TREE_ASSERT(FlatNodePush(flat, NodeArgType::function,  data, left,     FlatNull, index)); } while(0)
+#define _FLAT_MUL( flat, index, left, right       ) do { NodeData_t data = {.oper = Operation::mul};      TREE_ASSERT(FlatNodePush(flat, NodeArgType::operation, data, left,     right,    index)); } while(0)
+#define _FLAT_DIV( flat, index, left, right       ) do { NodeData_t data = {.oper = Operation::dive};     TREE_ASSERT(FlatNodePush(flat, NodeArgType::operation, data, left,     right,    index)); } while(0)
+#define _FLAT_ADD( flat, index, left, right       ) do { NodeData_t data = {.oper = Operation::plus};     TREE_ASSERT(FlatNodePush(flat, NodeArgType::operation, data, left,     right,    index)); } while(0)
+#define _FLAT_SUB( flat, index, left, right       ) do { NodeData_t data = {.oper = Operation::minus};    TREE_ASSERT(FlatNodePush(flat, NodeArgType::operation, data, left,     right,    index)); } while(0)
+#define _FLAT_POW( flat, index, left, right       ) do { NodeData_t data = {.oper = Operation::power};    TREE_ASSERT(FlatNodePush(flat, NodeArgType::operation, data, left,     right,    index)); } while(0)
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#endif
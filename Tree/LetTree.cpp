@@ -0,0 +1,389 @@
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+#include "LetTree.h"
+#include "Tree.h"
+#include "NodeTable.h"
+#include "../Common/GlobalInclude.h"
+
+
+static TreeErr    LetCopy              (const Node_t* node, NodeMap_t* copies, Node_t** copy);
+static TreeErr    LetCountUses         (const Node_t* node, LetIndex_t* uses);
+static TreeErr    LetBindShared        (LetTree_t* let, const Node_t* node, const LetIndex_t* uses, NodeMap_t* visited);
+static TreeErr    LetBindingPush       (LetTree_t* let, const Node_t* node);
+static Number     LetNodeEval          (const LetTree_t* let, const Node_t* node, size_t computed, Number x, Number y);
+
+static LetSlot_t* LetIndexSlot         (const LetIndex_t* index, const Node_t* node);
+
+static const size_t LetMinCapacity = 64;
+
+//============================== Let tree functions ========================================================================================================================
+
+// tree is copied to dag, where equal subtrees become one node, then node with many parents becomes binding.
+// bindings are taken in post-order, so every binding goes after bindings, that it uses
+TreeErr LetTreeCtor(LetTree_t* let, const Tree_t* tree)
+{
+    assert(let);
+    assert(tree);
+    assert(tree->root);
+
+    TreeErr err = {};
+
+    *let = {};
+
+    TREE_ASSERT(DagArenaCtor(&let->arena));
+    TREE_ASSERT(LetIndexCtor(&let->index, 0));
+
+    NodeMap_t copies = {};
+    TREE_ASSERT(NodeMapCtor(&copies, 0));
+
+    NodeArena_t* oldArena = NodeArenaSwitch(&let->arena);
+
+    Node_t* root = nullptr;
+    TREE_ASSERT(LetCopy(tree->root, &copies, &root));
+
+    NodeArenaSwitch(oldArena);
+
+    TREE_ASSERT(NodeMapDtor(&copies));
+
+    LetIndex_t uses = {};
+    TREE_ASSERT(LetIndexCtor(&uses, 0));
+    TREE_ASSERT(LetCountUses(root, &uses));
+
+    NodeMap_t visited = {};
+    TREE_ASSERT(NodeMapCtor(&visited, 0));
+    TREE_ASSERT(LetBindShared(let, root, &uses, &visited));
+    TREE_ASSERT(NodeMapDtor(&visited));
+
+    TREE_ASSERT(LetIndexDtor(&uses));
+
+    let->result = root;
+
+    let->values = (Number*) calloc(let->size + 1, sizeof(Number));
+    RETURN_IF_FALSE(let->values, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+    return NODE_VERIF(root, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr LetTreeDtor(LetTree_t* let)
+{
+    assert(let);
+
+    TreeErr err = {};
+
+    TREE_ASSERT(NodeArenaDtor(&let->arena));
+    TREE_ASSERT(LetIndexDtor(&let->index));
+
+    FREE(let->bindings);
+    FREE(let->values);
+
+    *let = {};
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// number of binding, that is computed in this node, or LetNull
+size_t LetTreeFind(const LetTree_t* let, const Node_t* node)
+{
+    assert(let);
+    assert(node);
+
+    return LetIndexFind(&let->index, node);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// every binding is computed once, then result uses their values
+Number LetTreeEval(LetTree_t* let, Number x, Number y)
+{
+    assert(let);
+    assert(let->result);
+
+    for (size_t i = 0; i < let->size; i++)
+    {
+        let->values[i] = LetNodeEval(let, let->bindings[i], i, x, y);
+    }
+
+    return LetNodeEval(let, let->result, let->size, x, y);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// subtree of source tree can be shared (if source is dag), so every its node is copied once
+static TreeErr LetCopy(const Node_t* node, NodeMap_t* copies, Node_t** copy)
+{
+    assert(node);
+    assert(copies);
+    assert(copy);
+
+    TreeErr err = {};
+
+    Node_t* known = NodeMapFind(copies, node);
+    RETURN_IF_TRUE(known, err, *copy = known);
+
+    Node_t* left  = nullptr;
+    Node_t* right = nullptr;
+
+    if (node->left)
+    {
+        TREE_ASSERT(LetCopy(node->left,  copies, &left));
+    }
+
+    if (node->right)
+    {
+        TREE_ASSERT(LetCopy(node->right, copies, &right));
+    }
+
+    TREE_ASSERT(NodeCtor(copy, node->type, node->data, left, right));
+    TREE_ASSERT(NodeMapInsert(copies, node, *copy));
+
+    return NODE_VERIF(*copy, err);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// uses of node is number of its parents in dag, node is walked only at its first use
+static TreeErr LetCountUses(const Node_t* node, LetIndex_t* uses)
+{
+    assert(node);
+    assert(uses);
+
+    TreeErr err = {};
+
+    const Node_t* children[] = {node->left, node->right};
+
+    for (size_t i = 0; i < sizeof(children) / sizeof(children[0]); i++)
+    {
+        const Node_t* child = children[i];
+        if (!child) continue;
+
+        LetSlot_t* slot = LetIndexSlot(uses, child);
+
+        if (slot->node)
+        {
+            slot->value++;
+            continue;
+        }
+
+        TREE_ASSERT(LetIndexInsert(uses, child, 1));
+        TREE_ASSERT(LetCountUses(child, uses));
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// numbers and variables are cheaper, than reference, so they are never bound
+static TreeErr LetBindShared(LetTree_t* let, const Node_t* node, const LetIndex_t* uses, NodeMap_t* visited)
+{
+    assert(let);
+    assert(node);
+    assert(uses);
+    assert(visited);
+
+    TreeErr err = {};
+
+    RETURN_IF_TRUE(NodeMapContains(visited, node), err);
+    TREE_ASSERT(NodeMapInsert(visited, node, nullptr));
+
+    if (node->left)
+    {
+        TREE_ASSERT(LetBindShared(let, node->left,  uses, visited));
+    }
+
+    if (node->right)
+    {
+        TREE_ASSERT(LetBindShared(let, node->right, uses, visited));
+    }
+
+    bool isLeaf = (node->type == NodeArgType::number || node->type == NodeArgType::variable);
+    size_t used = LetIndexFind(uses, node);
+
+    if (!isLeaf && used != LetNull && used > 1)
+    {
+        TREE_ASSERT(LetBindingPush(let, node));
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr LetBindingPush(LetTree_t* let, const Node_t* node)
+{
+    assert(let);
+    assert(node);
+
+    TreeErr err = {};
+
+    if (let->size == let->capacity)
+    {
+        size_t         capacity = let->capacity ? 2 * let->capacity : LetMinCapacity;
+        const Node_t** bindings = (const Node_t**) realloc(let->bindings, capacity * sizeof(Node_t*));
+
+        RETURN_IF_FALSE(bindings, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
+
+        let->bindings = bindings;
+        let->capacity = capacity;
+    }
+
+    TREE_ASSERT(LetIndexInsert(&let->index, node, let->size));
+
+    let->bindings[let->size++] = node;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// bindings with number < computed have values already
+static Number LetNodeEval(const LetTree_t* let, const Node_t* node, size_t computed, Number x, Number y)
+{
+    assert(let);
+    assert(node);
+
+    size_t binding = LetIndexFind(&let->index, node);
+    RETURN_IF_TRUE(binding < computed, let->values[binding]);
+
+    switch (node->type)
+    {
+        case NodeArgType::number:    return node->data.num;
+        case NodeArgType::variable:  return (node->data.var == Variable::x) ? x : y;
+        case NodeArgType::function:  return GetMathFunction(node->data.func)(LetNodeEval(let, node->left, computed, x, y));
+        case NodeArgType::operation:
+        {
+            Number left = LetNodeEval(let, node->left, computed, x, y);
+            RETURN_IF_FALSE(node->right, -left);
+
+            Number right = LetNodeEval(let, node->right, computed, x, y);
+
+            switch (node->data.oper)
+            {
+                case Operation::plus:  return left + right;
+                case Operation::minus: return left - right;
+                case Operation::mul:   return left * right;
+                case Operation::dive:  return left / right;
+                case Operation::power: return pow(left, right);
+                case Operation::undefined_operation:
+                default: assert(0 && "undefined operation in eval.\n"); break;
+            }
+            break;
+        }
+        case NodeArgType::undefined:
+        default: assert(0 && "undefined node type in eval.\n"); break;
+    }
+
+    return NAN;
+}
+
+//============================== Let index =================================================================================================================================
+
+TreeErr LetIndexCtor(LetIndex_t* index, size_t capacity)
+{
+    assert(index);
+
+    TreeErr err = {};
+
+    size_t realCapacity = LetMinCapacity;
+    while (realCapacity < capacity) realCapacity *= 2;
+
+    index->slots    = (LetSlot_t*) calloc(realCapacity, sizeof(LetSlot_t));
+    index->capacity = realCapacity;
+    index->size     = 0;
+
+    if (!index->slots) err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr LetIndexDtor(LetIndex_t* index)
+{
+    assert(index);
+
+    TreeErr err = {};
+
+    FREE(index->slots);
+    index->capacity = 0;
+    index->size     = 0;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// slot of node or empty slot, where it must be; node of dag is unique, so its structural hash is good key
+static LetSlot_t* LetIndexSlot(const LetIndex_t* index, const Node_t* node)
+{
+    assert(index);
+    assert(index->slots);
+    assert(node);
+
+    size_t mask = index->capacity - 1;
+    size_t pos  = node->hash & mask;
+
+    while (index->slots[pos].node && index->slots[pos].node != node) pos = (pos + 1) & mask;
+
+    return &index->slots[pos];
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr LetIndexInsert(LetIndex_t* index, const Node_t* node, size_t value)
+{
+    assert(index);
+    assert(node);
+
+    TreeErr err = {};
+
+    if (2 * (index->size + 1) > index->capacity)
+    {
+        LetIndex_t bigger = {};
+        TREE_ASSERT(LetIndexCtor(&bigger, 2 * index->capacity));
+
+        for (size_t i = 0; i < index->capacity; i++)
+        {
+            if (index->slots[i].node) *LetIndexSlot(&bigger, index->slots[i].node) = index->slots[i];
+        }
+
+        bigger.size = index->size;
+
+        TREE_ASSERT(LetIndexDtor(index));
+        *index = bigger;
+    }
+
+    LetSlot_t* slot = LetIndexSlot(index, node);
+
+    if (!slot->node) index->size++;
+
+    slot->node  = node;
+    slot->value = value;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+size_t LetIndexFind(const LetIndex_t* index, const Node_t* node)
+{
+    assert(index);
+
+    const LetSlot_t* slot = LetIndexSlot(index, node);
+
+    return slot->node ? slot->value : LetNull;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,62 @@
+#ifndef LET_TREE_H
+#define LET_TREE_H
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "Tree.h"
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static const size_t LetNull = SIZE_MAX;
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+struct LetSlot_t
+{
+    const Node_t* node;
+    size_t        value;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// node -> number map, nodes are keys of one hash-consed dag, so they are compared by address
+struct LetIndex_t
+{
+    LetSlot_t* slots;
+    size_t     capacity;
+    size_t     size;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// expression in let-bound form: t0 = ..., t1 = ..., result = ...
+// every subtree, that occurs in expression more than once, is computed only once as binding.
+// bindings and result are nodes of one hash-consed dag. While binding i is computed, node of binding j < i
+// is a reference to tj, not a subtree (result can reference all bindings), so binding uses only earlier ones
+struct LetTree_t
+{
+    NodeArena_t    arena;
+    const Node_t** bindings;
+    size_t         size;
+    size_t         capacity;
+    const Node_t*  result;
+    LetIndex_t     index;    // binding node -> its number
+    Number*        values;   // values of bindings for LetTreeEval
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr LetTreeCtor   (LetTree_t* let, const Tree_t* tree);
+TreeErr LetTreeDtor   (LetTree_t* let);
+size_t  LetTreeFind   (const LetTree_t* let, const Node_t* node);
+Number  LetTreeEval   (LetTree_t* let, Number x, Number y);
+
+TreeErr LetIndexCtor  (LetIndex_t* index, size_t capacity);
+TreeErr LetIndexDtor  (LetIndex_t* index);
+TreeErr LetIndexInsert(LetIndex_t* index, const Node_t* node, size_t value);
+size_t  LetIndexFind  (const LetIndex_t* index, const Node_t* node);
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#endif
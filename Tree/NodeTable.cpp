@@ -0,0 +1,381 @@
+#include <assert.h>
+#include <string.h>
+#include <stdint.h>
+#include "NodeTable.h"
+#include "Tree.h"
+#include "../Common/GlobalInclude.h"
+
+
+static size_t  NodeDataHash       (NodeArgType type, NodeData_t data);
+static size_t  PointerHash        (const void* pointer);
+static size_t  HashCombine        (size_t seed, size_t value);
+static bool    IsNodeKeyEqual     (const Node_t* node, NodeArgType type, NodeData_t data, const Node_t* left, const Node_t* right);
+
+static TreeErr NodeTableRehash    (NodeTable_t* table);
+static TreeErr NodeMapRehash      (NodeMap_t* map);
+static size_t  NodeMapKeyHash     (const NodeMap_t* map, const Node_t* key);
+static bool    IsNodeMapKeyEqual  (const NodeMap_t* map, const Node_t* first, const Node_t* second);
+
+static const size_t TableMinCapacity = 64;
+
+//============================== Unique table ==============================================================================================================================
+
+TreeErr NodeTableCtor(NodeTable_t* table, size_t capacity)
+{
+    assert(table);
+
+    TreeErr err = {};
+
+    size_t realCapacity = TableMinCapacity;
+    while (realCapacity < capacity) realCapacity *= 2;
+
+    table->nodes    = (Node_t**) calloc(realCapacity, sizeof(Node_t*));
+    table->capacity = realCapacity;
+    table->size     = 0;
+
+    if (!table->nodes) err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr NodeTableDtor(NodeTable_t* table)
+{
+    assert(table);
+
+    TreeErr err = {};
+
+    FREE(table->nodes);
+    table->capacity = 0;
+    table->size     = 0;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+Node_t* NodeTableFind(const NodeTable_t* table, NodeArgType type, NodeData_t data, const Node_t* left, const Node_t* right)
+{
+    assert(table);
+    assert(table->nodes);
+
+    size_t mask = table->capacity - 1;
+    size_t pos  = NodeHash(type, data, left, right) & mask;
+
+    while (table->nodes[pos])
+    {
+        Node_t* node = table->nodes[pos];
+        RETURN_IF_TRUE(IsNodeKeyEqual(node, type, data, left, right), node);
+        pos = (pos + 1) & mask;
+    }
+
+    return nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr NodeTableInsert(NodeTable_t* table, Node_t* node)
+{
+    assert(table);
+    assert(node);
+
+    TreeErr err = {};
+
+    if (2 * (table->size + 1) > table->capacity)
+    {
+        err = NodeTableRehash(table);
+        RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+    }
+
+    size_t mask = table->capacity - 1;
+    size_t pos  = node->hash & mask;
+
+    while (table->nodes[pos]) pos = (pos + 1) & mask;
+
+    table->nodes[pos] = node;
+    table->size++;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr NodeTableRehash(NodeTable_t* table)
+{
+    assert(table);
+
+    TreeErr err = {};
+
+    Node_t** oldNodes    = table->nodes;
+    size_t   oldCapacity = table->capacity;
+
+    err = NodeTableCtor(table, 2 * oldCapacity);
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err, table->nodes = oldNodes, table->capacity = oldCapacity);
+
+    for (size_t i = 0; i < oldCapacity; i++)
+    {
+        if (oldNodes[i]) TREE_ASSERT(NodeTableInsert(table, oldNodes[i]));
+    }
+
+    FREE(oldNodes);
+
+    return err;
+}
+
+//============================== Node map ==================================================================================================================================
+
+TreeErr NodeMapCtor(NodeMap_t* map, size_t capacity)
+{
+    assert(map);
+
+    TreeErr err = {};
+
+    size_t realCapacity = TableMinCapacity;
+    while (realCapacity < capacity) realCapacity *= 2;
+
+    map->items      = (NodeMapItem_t*) calloc(realCapacity, sizeof(NodeMapItem_t));
+    map->capacity   = realCapacity;
+    map->size       = 0;
+    map->structural = false;
+
+    if (!map->items) err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr NodeCacheCtor(NodeMap_t* map, size_t capacity)
+{
+    assert(map);
+
+    TreeErr err = NodeMapCtor(map, capacity);
+
+    map->structural = true;
+
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr NodeMapDtor(NodeMap_t* map)
+{
+    assert(map);
+
+    TreeErr err = {};
+
+    FREE(map->items);
+    map->capacity = 0;
+    map->size     = 0;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+Node_t* NodeMapFind(const NodeMap_t* map, const Node_t* key)
+{
+    assert(map);
+    assert(map->items);
+    assert(key);
+
+    size_t mask = map->capacity - 1;
+    size_t pos  = NodeMapKeyHash(map, key) & mask;
+
+    while (map->items[pos].key)
+    {
+        RETURN_IF_TRUE(IsNodeMapKeyEqual(map, map->items[pos].key, key), map->items[pos].value);
+        pos = (pos + 1) & mask;
+    }
+
+    return nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+bool NodeMapContains(const NodeMap_t* map, const Node_t* key)
+{
+    assert(map);
+    assert(map->items);
+    assert(key);
+
+    size_t mask = map->capacity - 1;
+    size_t pos  = NodeMapKeyHash(map, key) & mask;
+
+    while (map->items[pos].key)
+    {
+        RETURN_IF_TRUE(IsNodeMapKeyEqual(map, map->items[pos].key, key), true);
+        pos = (pos + 1) & mask;
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr NodeMapInsert(NodeMap_t* map, const Node_t* key, Node_t* value)
+{
+    assert(map);
+    assert(key);
+
+    TreeErr err = {};
+
+    if (2 * (map->size + 1) > map->capacity)
+    {
+        err = NodeMapRehash(map);
+        RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+    }
+
+    size_t mask = map->capacity - 1;
+    size_t pos  = NodeMapKeyHash(map, key) & mask;
+
+    while (map->items[pos].key && !IsNodeMapKeyEqual(map, map->items[pos].key, key)) pos = (pos + 1) & mask;
+
+    if (!map->items[pos].key) map->size++;
+
+    map->items[pos].key   = key;
+    map->items[pos].value = value;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr NodeMapRehash(NodeMap_t* map)
+{
+    assert(map);
+
+    TreeErr err = {};
+
+    NodeMapItem_t* oldItems    = map->items;
+    size_t         oldCapacity = map->capacity;
+    bool           structural  = map->structural;
+
+    err = NodeMapCtor(map, 2 * oldCapacity);
+    map->structural = structural;
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err, map->items = oldItems, map->capacity = oldCapacity);
+
+    for (size_t i = 0; i < oldCapacity; i++)
+    {
+        if (oldItems[i].key) TREE_ASSERT(NodeMapInsert(map, oldItems[i].key, oldItems[i].value));
+    }
+
+    FREE(oldItems);
+
+    return err;
+}
+
+//============================== Hash helpers ==============================================================================================================================
+
+static size_t NodeMapKeyHash(const NodeMap_t* map, const Node_t* key)
+{
+    assert(map);
+    assert(key);
+
+    return map->structural ? key->hash : PointerHash(key);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsNodeMapKeyEqual(const NodeMap_t* map, const Node_t* first, const Node_t* second)
+{
+    assert(map);
+
+    return map->structural ? TreeEqual(first, second) : (first == second);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// children give their cached hashes, so hash of node is O(1) and equal subtrees have equal hashes
+size_t NodeHash(NodeArgType type, NodeData_t data, const Node_t* left, const Node_t* right)
+{
+    size_t hash = NodeDataHash(type, data);
+
+    hash = HashCombine(hash, left  ? left->hash  : 0);
+    hash = HashCombine(hash, right ? right->hash : 0);
+
+    return hash;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static size_t NodeDataHash(NodeArgType type, NodeData_t data)
+{
+    size_t hash = (size_t) type;
+
+    switch (type)
+    {
+        case NodeArgType::number:
+        {
+            uint64_t bits = 0;
+            memcpy(&bits, &data.num, sizeof(bits));
+            return HashCombine(hash, bits);
+        }
+        case NodeArgType::operation: return HashCombine(hash, (size_t) data.oper);
+        case NodeArgType::function:  return HashCombine(hash, (size_t) data.func);
+        case NodeArgType::variable:  return HashCombine(hash, (size_t) data.var);
+        case NodeArgType::undefined:
+        default: assert(0 && "undefined node type in hash.\n"); break;
+    }
+
+    return hash;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static size_t PointerHash(const void* pointer)
+{
+    size_t hash = (size_t) pointer;
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static size_t HashCombine(size_t seed, size_t value)
+{
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsNodeKeyEqual(const Node_t* node, NodeArgType type, NodeData_t data, const Node_t* left, const Node_t* right)
+{
+    assert(node);
+
+    RETURN_IF_FALSE(node->type  == type,  false);
+    RETURN_IF_FALSE(node->left  == left,  false);
+    RETURN_IF_FALSE(node->right == right, false);
+
+    return NodeDataEqual(type, node->data, data);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+bool NodeDataEqual(NodeArgType type, NodeData_t first, NodeData_t second)
+{
+    switch (type)
+    {
+        case NodeArgType::number:    return memcmp(&first.num, &second.num, sizeof(Number)) == 0;
+        case NodeArgType::operation: return first.oper == second.oper;
+        case NodeArgType::function:  return first.func == second.func;
+        case NodeArgType::variable:  return first.var  == second.var;
+        case NodeArgType::undefined:
+        default: assert(0 && "undefined node type in compare.\n"); break;
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
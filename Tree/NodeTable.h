@@ -0,0 +1,57 @@
+#ifndef NODE_TABLE_H
+#define NODE_TABLE_H
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "Tree.h"
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// unique table of hash-consed tree: every (type, data, left, right) is stored only once, key is structural hash of node
+struct NodeTable_t
+{
+    Node_t** nodes;
+    size_t   capacity;
+    size_t   size;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+struct NodeMapItem_t
+{
+    const Node_t* key;
+    Node_t*       value;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// node -> node map, is used to not walk shared subtrees of dag many times.
+// structural map (NodeCacheCtor) matches keys by TreeEqual instead of by address
+struct NodeMap_t
+{
+    NodeMapItem_t* items;
+    size_t         capacity;
+    size_t         size;
+    bool           structural;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr NodeTableCtor    (NodeTable_t* table, size_t capacity);
+TreeErr NodeTableDtor    (NodeTable_t* table);
+Node_t* NodeTableFind    (const NodeTable_t* table, NodeArgType type, NodeData_t data, const Node_t* left, const Node_t* right);
+TreeErr NodeTableInsert  (NodeTable_t* table, Node_t* node);
+
+size_t  NodeHash         (NodeArgType type, NodeData_t data, const Node_t* left, const Node_t* right);
+bool    NodeDataEqual    (NodeArgType type, NodeData_t first, NodeData_t second);
+
+TreeErr NodeMapCtor      (NodeMap_t* map, size_t capacity);
+TreeErr NodeCacheCtor    (NodeMap_t* map, size_t capacity);
+TreeErr NodeMapDtor      (NodeMap_t* map);
+Node_t* NodeMapFind      (const NodeMap_t* map, const Node_t* key);
+bool    NodeMapContains  (const NodeMap_t* map, const Node_t* key);
+TreeErr NodeMapInsert    (NodeMap_t* map, const Node_t* key, Node_t* value);
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#endif
@@ -2,6 +2,7 @@
 #include <assert.h>
 #include <string.h>
 #include <limits.h>
+#include <stdint.h>
 #include <sys/stat.h>
 #include "ReadTree.h"
 #include "../Common/GlobalInclude.h"
@@ -14,22 +15,38 @@
 struct Pointers
 {
     size_t ip; // input pointer
-    size_t tp; // token pointer
+    size_t tp; // token pointer (quant of read tokens)
     size_t lp; // line pointer (line in input file)
     size_t sp; // str pointer (pos in line)
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
+// tokens are read on demand, parser sees only current one, so token array is not needed
+struct Lexer_t
+{
+    const char* input;
+    size_t      inputSize;  // end of buffer is end of expression, as '$' is
+    Pointers    pointer;
+    Token_t     token;      // current token
+    Token_t     prevToken;  // is needed to find operation before unary minus
+    SyntaxErr_t syntaxErr;  // is filled, when input is rejected
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr LexerCtor     (Lexer_t* lexer, const char* input, size_t inputSize);
+static TreeErr LexerNext     (Lexer_t* lexer);
 static void TokenCtor        (Token_t* token, TokenType type, void* value, size_t fileLine, size_t linePos);
 
-static void HandleNumber       (const char* input, Token_t* tokenArr, Pointers* pointer);
-static void HandleOperation    (const char* input, Token_t* tokenArr, Pointers* pointer);
-static void HandleLetter       (const char* input, Token_t* tokenArr, Pointers* pointer);
-static void HandleBracket      (const char* input, Token_t* tokenArr, Pointers* pointer);
-static void HandleEndSymbol    (const char* input, Token_t* tokenArr, Pointers* pointer);
-static void HandleVariable     (                   Token_t* tokenArr, Variable  variable, Pointers* pointer, size_t olp_sp);
-static void HandleFunction     (                   Token_t* tokenArr, Function  function, Pointers* pointer, size_t old_sp);
+static bool HandleNumber       (const char* input, Token_t* token, Pointers* pointer);
+static void HandleOperation    (const char* input, Token_t* token, Pointers* pointer);
+static bool HandleLetter       (const char* input, Token_t* token, Pointers* pointer);
+static void HandleBracket      (const char* input, Token_t* token, Pointers* pointer);
+static void HandleEndSymbol    (const char* input, Token_t* token, Pointers* pointer);
+static void HandleBufferEnd    (                   Token_t* token, Pointers* pointer);
+static void HandleVariable     (                   Token_t* token, Variable  variable, Pointers* pointer, size_t olp_sp);
+static void HandleFunction     (                   Token_t* token, Function  function, Pointers* pointer, size_t old_sp);
 
 
 static bool IsPassSymbol       (char c, Pointers* pointer);
@@ -44,51 +61,203 @@ static bool IsLetterSymbol     (const char* input, size_t pointer);
 static bool IsBracketSymbol    (const char* input, size_t pointer);
 
 
-static Number    UpdateNumber      (Number number, const char* input, Pointers* pointer);
+static bool      UpdateNumber     (Number* number, const char* input, Pointers* pointer);
 
-static Number    GetNumber        (const char* input,     Pointers* pointer);
+static bool      GetNumber        (const char* input,     Pointers* pointer, Number* number);
 static Operation GetOperation     (const char* operation, Pointers* pointer, size_t* operationSize);
 static Function  GetFunction      (const char* word, size_t wordSize);
 static Variable  GetVariable      (const char* word, size_t wordSize);
 
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// function and variable names are found by perfect hash, that is built at compile time from DefaultFunctions and DefaultVariables.
+// seed is picked so that every name has its own slot, so lookup is one hash of word and one compare, whatever quant of names
+template <size_t Size>
+struct KeywordTable_t
+{
+    uint32_t seed;
+    size_t   slots[Size]; // index of name + 1, 0 is empty slot
+};
+
+static const uint32_t KeywordMaxSeed = 1 << 16;
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static constexpr size_t KeywordSize(const char* name)
+{
+    size_t size = 0;
+    while (name[size] != '\0') size++;
+
+    return size;
+}
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static constexpr uint32_t KeywordHash(const char* word, size_t wordSize, uint32_t seed)
+{
+    uint32_t hash = 2166136261u ^ (seed * 0x9e3779b9u);
+
+    for (size_t i = 0; i < wordSize; i++)
+    {
+        hash ^= (unsigned char) word[i];
+        hash *= 16777619u;
+    }
+
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+
+    return hash;
+}
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// 4 slots per name, so good seed is found after a few tries
+static constexpr size_t KeywordTableSize(size_t quant)
+{
+    size_t size = 1;
+    while (size < 4 * quant) size *= 2;
+
+    return size;
+}
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <size_t Size, typename Keyword, size_t Quant>
+static constexpr KeywordTable_t<Size> KeywordTableCtor(const Keyword (&keywords)[Quant])
+{
+    for (uint32_t seed = 0; seed < KeywordMaxSeed; seed++)
+    {
+        KeywordTable_t<Size> table = {};
+        table.seed = seed;
+
+        bool isPerfect = true;
+
+        for (size_t i = 0; i < Quant && isPerfect; i++)
+        {
+            const char* name = keywords[i].name;
+            size_t      slot = KeywordHash(name, KeywordSize(name), seed) & (Size - 1);
+
+            if (table.slots[slot] != 0) isPerfect = false;
+            else                        table.slots[slot] = i + 1;
+        }
+
+        if (isPerfect) return table;
+    }
+
+    return KeywordTable_t<Size>{KeywordMaxSeed, {}};
+}
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <size_t Size, typename Keyword, size_t Quant>
+static const Keyword* KeywordFind(const KeywordTable_t<Size>* table, const Keyword (&keywords)[Quant], const char* word, size_t wordSize)
+{
+    assert(table);
+    assert(word);
+
+    size_t slot = table->slots[KeywordHash(word, wordSize, table->seed) & (Size - 1)];
+    RETURN_IF_TRUE(slot == 0, nullptr);
+
+    const Keyword* keyword = &keywords[slot - 1];
+
+    RETURN_IF_FALSE(strncmp(word, keyword->name, wordSize) == 0 && keyword->name[wordSize] == '\0', nullptr);
+
+    return keyword;
+}
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static constexpr size_t FunctionsTableSize = KeywordTableSize(DefaultFunctionsQuant);
+static constexpr size_t VariablesTableSize = KeywordTableSize(DefaultVariablesQuant);
+
+static constexpr KeywordTable_t<FunctionsTableSize> FunctionsTable = KeywordTableCtor<FunctionsTableSize>(DefaultFunctions);
+static constexpr KeywordTable_t<VariablesTableSize> VariablesTable = KeywordTableCtor<VariablesTableSize>(DefaultVariables);
+
+static_assert(FunctionsTable.seed != KeywordMaxSeed, "no perfect hash for DefaultFunctions, increase KeywordMaxSeed.");
+static_assert(VariablesTable.seed != KeywordMaxSeed, "no perfect hash for DefaultVariables, increase KeywordMaxSeed.");
+
+
 //=============================== Tokens (Read Tree) End =================tt======================================================================================================================================================================
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-//=============================== Syntax Err =================================================================================================================================================================================================================
-
-static Node_t* GetNumber            (const Token_t* token, size_t* tp, const char* input);
-static Node_t* GetVariable          (const Token_t* token, size_t* tp, const char* input);
-static Node_t* GetAddSub            (const Token_t* token, size_t* tp, const char* input);
-static Node_t* GetMulDiv            (const Token_t* token, size_t* tp, const char* input);
-static Node_t* GetBracket           (const Token_t* token, size_t* tp, const char* input);
-static Node_t* GetPow               (const Token_t* token, size_t* tp, const char* input);
-
-static Node_t* GetFunction          (const Token_t* token, size_t* tp, const char* input);
-static Node_t* GetMinus             (const Token_t* token, size_t* tp, const char* input);
-
-
-static Number    GetTokenNumber     (const Token_t* token, const size_t* tp);
-static Variable  GetTokenVariable   (const Token_t* token, const size_t* tp);
-static Operation GetTokenOperation  (const Token_t* token, const size_t* tp);
-static Function  GetTokenFunction   (const Token_t* token, const size_t* tp);
-
-static bool IsTokenEnd              (const Token_t* token, const size_t* tp);
-static bool IsTokenNum              (const Token_t* token, const size_t* tp);
-static bool IsTokenVariable         (const Token_t* token, const size_t* tp);
-static bool IsTokenOperation        (const Token_t* token, const size_t* tp);
-static bool IsTokenFunction         (const Token_t* token, const size_t* tp);
-
-static bool IsAddSub                (const Token_t* token, const size_t* tp);
-static bool IsMulDiv                (const Token_t* token, const size_t* tp);
-static bool IsPow                   (const Token_t* token, const size_t* tp);
-static bool IsTokenLeftBracket      (const Token_t* token, const size_t* tp);
-static bool IsTokenRightBracket     (const Token_t* token, const size_t* tp);
-static bool IsOperationBeforeMinus  (const Token_t* token, const size_t* tp);
-static bool IsTokenMinus            (const Token_t* token, const size_t* tp);
-static bool IsOperationToken        (const Token_t* token,       size_t  tp);
-
-//=============================== Recursive Descent (Build Tree) End =======================================================================================================================================================================
+//=============================== Token Checks (Build Tree) =======================================================================================================================================================================================================
+
+static Number    GetTokenNumber     (const Lexer_t* lexer);
+static Variable  GetTokenVariable   (const Lexer_t* lexer);
+static Operation GetTokenOperation  (const Lexer_t* lexer);
+static Function  GetTokenFunction   (const Lexer_t* lexer);
+
+static bool IsTokenEnd              (const Lexer_t* lexer);
+static bool IsTokenNum              (const Lexer_t* lexer);
+static bool IsTokenVariable         (const Lexer_t* lexer);
+static bool IsTokenOperation        (const Lexer_t* lexer);
+static bool IsTokenFunction         (const Lexer_t* lexer);
+
+static bool IsTokenLeftBracket      (const Lexer_t* lexer);
+static bool IsTokenRightBracket     (const Lexer_t* lexer);
+static bool IsOperationBeforeMinus  (const Lexer_t* lexer);
+static bool IsTokenMinus            (const Lexer_t* lexer);
+
+//=============================== Token Checks (Build Tree) End =======================================================================================================================================================================
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//=============================== Operator Precedence (Build Tree) =========================================================================================================================================================================
+
+enum ParseItemType
+{
+    binary_item,
+    unary_minus_item,
+    bracket_item,
+    function_item,
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+struct ParseItem_t
+{
+    ParseItemType type;
+    Operation     operation;
+    Function      function;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// operations and open brackets wait in items, built subtrees wait in nodes.
+// both stacks are on heap, so depth of nesting is limited only by memory, not by call stack
+struct Parser_t
+{
+    ParseItem_t* items;
+    size_t       itemsSize;
+    size_t       itemsCapacity;
+
+    Node_t**     nodes;
+    size_t       nodesSize;
+    size_t       nodesCapacity;
+
+    size_t       openBrackets;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static TreeErr ParserCtor           (Parser_t* parser);
+static void    ParserDtor           (Parser_t* parser);
+static TreeErr PushItem             (Parser_t* parser, ParseItemType type, Operation operation, Function function);
+static TreeErr PushNode             (Parser_t* parser, Node_t* node);
+static Node_t* PopNode              (Parser_t* parser);
+
+static TreeErr ParseTokens          (Lexer_t* lexer, Parser_t* parser);
+static TreeErr ParseOperand         (Lexer_t* lexer, Parser_t* parser, bool* isOperandExpected);
+static TreeErr ParseOperator        (Lexer_t* lexer, Parser_t* parser, bool* isOperandExpected);
+static TreeErr ReduceItems          (Parser_t* parser, size_t priority);
+static TreeErr ReduceItem           (Parser_t* parser);
+
+static size_t  GetOperationPriority (Operation operation);
+
+//=============================== Operator Precedence (Build Tree) End =====================================================================================================================================================================
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -99,25 +268,43 @@ static void        strnprintf       (const char* str, size_t n);
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-#define SYNTAX_ERR_FOR_TOKEN(token,               input, msg) SyntaxError((token).place.line, (token).place.placeInLine, input, msg, __FILE__, __LINE__, __func__)
-#define SYNTAX_ERR(          errLine, errLinePos, input, msg) SyntaxError(errLine,            errLinePos,                input, msg, __FILE__, __LINE__, __func__)
+#define SYNTAX_ERR_FOR_TOKEN(lexer, msg) SyntaxError(lexer, (lexer)->token.place,                                                             msg, __FILE__, __LINE__, __func__)
+#define SYNTAX_ERR(          lexer, msg) SyntaxError(lexer, {(lexer)->pointer.lp, (lexer)->pointer.sp, (lexer)->pointer.ip}, msg, __FILE__, __LINE__, __func__)
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static void SyntaxError(size_t errLine, size_t errLinePos, const char* input, const char* msg, const char* file, const int line, const char* func)
+static TreeErr SyntaxError(Lexer_t* lexer, FilePlace place, const char* msg, const char* file, const int line, const char* func)
 {
-    assert(input);
+    assert(lexer);
     assert(msg);
     assert(file);
     assert(func);
 
-    COLOR_PRINT(RED, "\nSyntaxErr detected in:\n");
-    PrintPlace(file, line, func);
+    assert(place.line >= 1);
+    assert(place.placeInLine >= 1);
+
+    lexer->syntaxErr = {place, msg};
+
+    TreeErr err = {};
+
+    err.err = TreeErrorType::INPUT_SYNTAX_ERROR;
+    CodePlaceCtor(&err.place, file, line, func);
+
+    return err;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
+void SyntaxErrPrint(const char* input, const SyntaxErr_t* syntaxErr)
+{
+    assert(input);
+    assert(syntaxErr);
+    assert(syntaxErr->msg);
 
-    assert(errLine >= 1);
-    assert(errLinePos >= 1);
+    size_t errLine    = syntaxErr->place.line;
+    size_t errLinePos = syntaxErr->place.placeInLine;
 
+    COLOR_PRINT(RED, "\nSyntaxErr detected in:\n");
 
     size_t lineSize = 0;
     const char* LineWithErr = FindNline(input, errLine, &lineSize);
@@ -130,11 +317,7 @@ static void SyntaxError(size_t errLine, size_t errLinePos, const char* input, co
 
     COLOR_PRINT(RED, "^");
     COLOR_PRINT(WHITE, "\nIn line::%lu::%lu", errLine, errLinePos);
-    COLOR_PRINT(WHITE, " %s\n", msg);
-
-
-    COLOR_PRINT(VIOLET, "\nabort() in 3, 2, 1...\n");
-    exit(0);
+    COLOR_PRINT(WHITE, " %s\n", syntaxErr->msg);
 
     return;
 }
@@ -192,52 +375,53 @@ static void strnprintf(const char* str, size_t n)
 //=============================== Tokens (Read Tree) =======================================================================================================================================================================================
 
 
-Token_t* ReadInputStr(const char* input, size_t* tokenArrSize)
+static TreeErr LexerCtor(Lexer_t* lexer, const char* input, size_t inputSize)
 {
+    assert(lexer);
     assert(input);
-    assert(tokenArrSize);
 
+    *lexer = {};
 
-    size_t inputLen = strlen(input);
+    lexer->input     = input;
+    lexer->inputSize = inputSize;
+    lexer->pointer   = {0, 0, 1, 1};
 
-    Token_t* tokenArr = (Token_t*) calloc(inputLen, sizeof(*tokenArr));
+    return LexerNext(lexer);
+}
 
-    Pointers pointer = {0, 0, 1, 1};
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-    while (pointer.ip < inputLen)
-    {
-        while (IsPassSymbol(input[pointer.ip], &pointer));
-
-        if      (IsNumSymbol       (input, pointer.ip))    HandleNumber    (input, tokenArr, &pointer);
-        else if (IsOperationSymbol (input, pointer.ip))    HandleOperation (input, tokenArr, &pointer);
-        else if (IsLetterSymbol    (input, pointer.ip))    HandleLetter    (input, tokenArr, &pointer);
-        else if (IsBracketSymbol   (input, pointer.ip))    HandleBracket   (input, tokenArr, &pointer);
-        else if (IsEndSymbol       (input, pointer.ip))    HandleEndSymbol (input, tokenArr, &pointer);
-        else    SYNTAX_ERR(pointer.lp, pointer.sp, input, "undefined word in input.");
-    }
+static TreeErr LexerNext(Lexer_t* lexer)
+{
+    assert(lexer);
 
-    *tokenArrSize = pointer.tp;
+    TreeErr err = {};
 
-    assert(*tokenArrSize > 0);
-    assert(tokenArr); 
-  
-    tokenArr = (Token_t*) realloc(tokenArr, *tokenArrSize * sizeof(Token_t));
-  
-    assert(tokenArr);
+    const char* input   = lexer->input;
+    Pointers*   pointer = &lexer->pointer;
+    Token_t*    token   = &lexer->token;
 
-    return tokenArr;
-}
+    lexer->prevToken = lexer->token;
 
+    while (pointer->ip < lexer->inputSize && IsPassSymbol(input[pointer->ip], pointer));
 
-//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+    size_t offset = pointer->ip;
 
-void TokenDtor(Token_t* tokenArr)
-{
-    assert(tokenArr);
+    if      (pointer->ip >= lexer->inputSize)           HandleBufferEnd (token, pointer);
+    else if (input[pointer->ip] == '\0')                return SYNTAX_ERR(lexer, "expected '$' before end of input.");
+    else if (IsNumSymbol       (input, pointer->ip))  { RETURN_IF_FALSE(HandleNumber(input, token, pointer), SYNTAX_ERR(lexer, "Integer overflow")); }
+    else if (IsOperationSymbol (input, pointer->ip))    HandleOperation (input, token, pointer);
+    else if (IsLetterSymbol    (input, pointer->ip))  { RETURN_IF_FALSE(HandleLetter(input, token, pointer), SYNTAX_ERR(lexer, "undefined name in input.")); }
+    else if (IsBracketSymbol   (input, pointer->ip))    HandleBracket   (input, token, pointer);
+    else if (IsEndSymbol       (input, pointer->ip))    HandleEndSymbol (input, token, pointer);
+    else    return SYNTAX_ERR(lexer, "undefined word in input.");
 
-    FREE(tokenArr);
+    token->place.offset = offset;
 
-    return;
+    pointer->tp++;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -268,29 +452,29 @@ static void TokenCtor(Token_t* token, TokenType type, void* value, size_t fileLi
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static void HandleNumber(const char* input, Token_t* tokenArr, Pointers* pointer)
+// returns false, if number doesn't fit in int
+static bool HandleNumber(const char* input, Token_t* token, Pointers* pointer)
 {
-    assert(tokenArr);
+    assert(token);
     assert(pointer);
 
     size_t old_sp = pointer->sp;
-    Number number = GetNumber(input, pointer);
-    TokenCtor(&tokenArr[pointer->tp], TokenType::Number_t, &number, pointer->lp, old_sp);
-    pointer->tp++;
-    return;
+    Number number = 0;
+    RETURN_IF_FALSE(GetNumber(input, pointer, &number), false);
+    TokenCtor(token, TokenType::Number_t, &number, pointer->lp, old_sp);
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static void HandleOperation(const char* input, Token_t* tokenArr, Pointers* pointer)
+static void HandleOperation(const char* input, Token_t* token, Pointers* pointer)
 {
-    assert(tokenArr);
+    assert(token);
     assert(pointer);
 
     size_t operationSize = 0;
     Operation operation = GetOperation(input, pointer, &operationSize);
-    TokenCtor(&tokenArr[pointer->tp], TokenType::Operation_t, &operation, pointer->lp, pointer->sp);
-    pointer->tp++;
+    TokenCtor(token, TokenType::Operation_t, &operation, pointer->lp, pointer->sp);
     pointer->ip++;
     pointer->sp += operationSize;
     return;
@@ -298,9 +482,10 @@ static void HandleOperation(const char* input, Token_t* tokenArr, Pointers* poin
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static void HandleLetter(const char* input, Token_t* tokenArr, Pointers* pointer)
+// returns false, if word is not a function or variable name
+static bool HandleLetter(const char* input, Token_t* token, Pointers* pointer)
 {
-    assert(tokenArr);
+    assert(token);
     assert(pointer);
 
     size_t old_ip = pointer->ip;
@@ -318,36 +503,36 @@ static void HandleLetter(const char* input, Token_t* tokenArr, Pointers* pointer
 
     if (function != Function::undefined_function)
     {
-        HandleFunction(tokenArr, function, pointer, wordSize);
-        return;
+        HandleFunction(token, function, pointer, wordSize);
+        return true;
     }
 
     Variable variable = GetVariable(word, wordSize);
 
     if (variable != Variable::undefined_variable)
     {
-        HandleVariable(tokenArr, variable, pointer, wordSize);
-        return;
+        HandleVariable(token, variable, pointer, wordSize);
+        return true;
     }
 
-    SYNTAX_ERR(pointer->lp, pointer->sp, input, "undefined name in input.");
-    return;
+    pointer->ip = old_ip; // error points to start of word
+
+    return false;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static void HandleBracket(const char* input, Token_t* tokenArr, Pointers* pointer)
+static void HandleBracket(const char* input, Token_t* token, Pointers* pointer)
 {
-    assert(tokenArr);
+    assert(token);
     assert(pointer);
     assert(IsBracketSymbol(input, pointer->ip));
 
     Bracket bracket = (Bracket) input[pointer->ip];
     pointer->ip++;
 
-    TokenCtor(&tokenArr[pointer->tp], TokenType::Bracket_t, &bracket, pointer->lp, pointer->sp);
+    TokenCtor(token, TokenType::Bracket_t, &bracket, pointer->lp, pointer->sp);
     
-    pointer->tp++;
     pointer->sp++;
 
     return;
@@ -355,32 +540,44 @@ static void HandleBracket(const char* input, Token_t* tokenArr, Pointers* pointe
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static void HandleEndSymbol(const char* input, Token_t* tokenArr, Pointers* pointer)
+static void HandleEndSymbol(const char* input, Token_t* token, Pointers* pointer)
 {
-    assert(tokenArr);
+    assert(token);
     assert(pointer);
     assert(IsEndSymbol(input, pointer->ip));
 
     EndSymbol end = (EndSymbol) input[pointer->ip];
     pointer->ip++;
 
-    TokenCtor(&tokenArr[pointer->tp], TokenType::EndSymbol_t, &end, pointer->lp, pointer->sp);
-    pointer->tp++;
+    TokenCtor(token, TokenType::EndSymbol_t, &end, pointer->lp, pointer->sp);
     pointer->sp++;
 
     return;
 }
 
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static void HandleBufferEnd(Token_t* token, Pointers* pointer)
+{
+    assert(token);
+    assert(pointer);
+
+    EndSymbol end = EndSymbol::end;
+
+    TokenCtor(token, TokenType::EndSymbol_t, &end, pointer->lp, pointer->sp);
+
+    return;
+}
+
 //---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static void HandleVariable(Token_t* tokenArr, Variable variable, Pointers* pointer, size_t wordSize)
+static void HandleVariable(Token_t* token, Variable variable, Pointers* pointer, size_t wordSize)
 {
-    assert(tokenArr);
+    assert(token);
     assert(pointer);
 
-    TokenCtor(&tokenArr[pointer->tp], TokenType::Variable_t, &variable, pointer->lp, pointer->sp);
+    TokenCtor(token, TokenType::Variable_t, &variable, pointer->lp, pointer->sp);
 
-    pointer->tp++;
     pointer->sp += wordSize;
 
     return;
@@ -388,14 +585,13 @@ static void HandleVariable(Token_t* tokenArr, Variable variable, Pointers* point
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static void HandleFunction(Token_t* tokenArr, Function function, Pointers* pointer, size_t wordSize)
+static void HandleFunction(Token_t* token, Function function, Pointers* pointer, size_t wordSize)
 {
-    assert(tokenArr);
+    assert(token);
     assert(pointer);
 
-    TokenCtor(&tokenArr[pointer->tp], TokenType::Function_t, &function, pointer->lp, pointer->sp);
+    TokenCtor(token, TokenType::Function_t, &function, pointer->lp, pointer->sp);
 
-    pointer->tp++;
     pointer->sp += wordSize;
 
     return;
@@ -403,26 +599,29 @@ static void HandleFunction(Token_t* tokenArr, Function function, Pointers* point
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static Number GetNumber(const char* input, Pointers* pointer)
+static bool GetNumber(const char* input, Pointers* pointer, Number* number)
 {
     assert(pointer);
+    assert(number);
     assert(IsNumSymbol(input, pointer->ip));
 
-    Number number = 0;
+    *number = 0;
 
     do
     {
-        number = UpdateNumber(number, input, pointer);
+        RETURN_IF_FALSE(UpdateNumber(number, input, pointer), false);
     } 
     while (IsNumSymbol(input, pointer->ip));
 
-    return number;    
+    return true;    
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static Number UpdateNumber(Number number, const char* input, Pointers* pointer)
+// pointer stays on digit, that doesn't fit
+static bool UpdateNumber(Number* number, const char* input, Pointers* pointer)
 {
+    assert(number);
     assert(input);
     assert(pointer);
 
@@ -437,15 +636,14 @@ static Number UpdateNumber(Number number, const char* input, Pointers* pointer)
     assert(9 >= new_digit);
 
 
-    if ((INT_MAX - new_digit) / 10 < number)
-    {
-        SYNTAX_ERR(pointer->lp, pointer->sp, input, "Integer overflow");
-    }
+    RETURN_IF_TRUE((INT_MAX - new_digit) / 10 < *number, false);
 
     pointer->ip++;
     pointer->sp++;
     
-    return 10 * number + new_digit;
+    *number = 10 * *number + new_digit;
+
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -547,542 +745,561 @@ static Operation GetOperation(const char* operation, Pointers* pointer, size_t*
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-#define STRNCMP(function) (strncmp(word, function, wordSize) == 0)
-
 static Function GetFunction(const char* word, size_t wordSize)
 {
     assert(word);
 
-    for (size_t function_i = 0; function_i < DefaultFunctionsQuant; function_i++)
-    {
-        const char* name = DefaultFunctions[function_i].name;
-        Function    func = DefaultFunctions[function_i].value;
-    
-        RETURN_IF_TRUE(STRNCMP(name), func);
-    }
+    const DefaultFunction* function = KeywordFind(&FunctionsTable, DefaultFunctions, word, wordSize);
 
-    return Function::undefined_function;
+    return function ? function->value : Function::undefined_function;
 }
 
-#undef STRNCMP
-
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-#define STRNCMP(variable) (strncmp(word, variable, wordSize) == 0)
-
 static Variable GetVariable(const char* word, size_t wordSize)
 {
     assert(word);
 
-    RETURN_IF_TRUE(STRNCMP("x"), Variable::x);
-    RETURN_IF_TRUE(STRNCMP("y"), Variable::y);
+    const DefaultVariable* variable = KeywordFind(&VariablesTable, DefaultVariables, word, wordSize);
 
-    return Variable::undefined_variable;
+    return variable ? variable->value : Variable::undefined_variable;
 }
 
-#undef STRNCMP    
-
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
 //=============================== Tokens (Read Tree) End ===================================================================================================================================================================================
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-//=============================== Recursive Descent (Build Tree) ==========================================================================================================================================================================================
+//=============================== Token Checks (Build Tree) ==========================================================================================================================================================================================
 
-Node_t* GetTree(const Token_t* tokens, const char* input)
-{
-    assert(tokens);
+static bool IsTokenEnd(const Lexer_t* lexer)
+{   
+    assert(lexer);
 
-    size_t tp = 0;
-    Node_t* node = GetAddSub(tokens, &tp, input);
+    TokenType type = lexer->token.type;
 
-    if (!IsTokenEnd(tokens, &tp))
-        SYNTAX_ERR_FOR_TOKEN(tokens[tp], input, "expected '$'");
+    return (type == TokenType::EndSymbol_t);
+}
 
-    tp++;
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-    TreeErr err = {};
+static bool IsTokenNum(const Lexer_t* lexer)
+{
+    assert(lexer);
 
-    TREE_ASSERT(NODE_VERIF(node, err));
+    TokenType type = lexer->token.type;
 
-    return node;
+    return (type == TokenType::Number_t);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static Node_t* GetNumber(const Token_t* token, size_t* tp, const char* input)
+static bool IsTokenVariable(const Lexer_t* lexer)
 {
-    assert(token);
-    assert(tp);
+    assert(lexer);
 
-    if (!IsTokenNum(token, tp))
-        SYNTAX_ERR_FOR_TOKEN(token[*tp], input, "expected math expressiion");
-    
-    Number val = GetTokenNumber(token, tp);
-    (*tp)++;  
-
-    Node_t* node = {};
-    _NUM(&node, val);
+    TokenType type = lexer->token.type;
 
-    return node;
+    return (type == TokenType::Variable_t);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static Node_t* GetVariable(const Token_t* token, size_t* tp, const char* input)
+static bool IsTokenOperation(const Lexer_t* lexer)
 {
-    assert(tp);
-    assert(token);
-    
-    if (!IsTokenVariable(token, tp))
-        SYNTAX_ERR_FOR_TOKEN(token[*tp], input, "expetcted variable name");
+    assert(lexer);
 
-    Variable variable = GetTokenVariable(token, tp);
-    (*tp)++;
+    TokenType type = lexer->token.type;
 
+    return (type == TokenType::Operation_t);
+}
 
-    Node_t* node = {};
-    _VAR(&node, variable);
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsTokenFunction(const Lexer_t* lexer)
+{   
+    assert(lexer);
 
-    return node;
+    TokenType type = lexer->token.type;
+
+    return (type == TokenType::Function_t);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static Node_t* GetAddSub(const Token_t* token, size_t* tp, const char* input)
+static bool IsTokenLeftBracket (const Lexer_t* lexer)
 {
-    assert(tp);
-    assert(token);
+    assert(lexer);
 
-    size_t old_tp = *tp;
+    TokenType type = lexer->token.type;
 
-    Node_t* node = GetMulDiv(token, tp, input);
+    RETURN_IF_FALSE(type == TokenType::Bracket_t, false);
 
-    if (old_tp == *tp)
-        SYNTAX_ERR_FOR_TOKEN(token[*tp], input, "expected math expression");
-    
-    while(IsAddSub(token, tp))
-    {
-        Operation operation = GetTokenOperation(token, tp);
-        (*tp)++;  
+    Bracket bracket = lexer->token.data.bracket;
 
-        Node_t* node2 = GetMulDiv(token, tp, input);
-        Node_t* new_node = {};
+    return (bracket == Bracket::left);
+}
 
-        if (operation == Operation::plus)
-        {
-            _ADD(&new_node, node, node2);
-        }
-    
-        else if (operation == Operation::minus)
-        {
-            _SUB(&new_node, node, node2);
-        }
-    
-        else
-        {
-            assert(0 && "incorrect operation type");
-        }
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-        TREE_ASSERT(SwapNode(&node, &new_node));
-    }
+static bool IsTokenMinus(const Lexer_t* lexer)
+{
+    assert(lexer);
+
+    TokenType type = lexer->token.type;
+
+    RETURN_IF_FALSE(type == TokenType::Operation_t, false);
+
+    Operation operation = lexer->token.data.operation;
 
-    return node;
+    return (operation == Operation::minus);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static Node_t* GetMulDiv(const Token_t* token, size_t* tp, const char* input)
+static bool IsTokenRightBracket(const Lexer_t* lexer)
 {
-    assert(tp);
-    assert(token);
+    assert(lexer);
 
-    size_t old_tp = *tp;
+    TokenType type = lexer->token.type;
 
-    Node_t* node = GetPow(token, tp, input);
+    RETURN_IF_FALSE(type == TokenType::Bracket_t, false);
 
-    if (old_tp == *tp)
-        SYNTAX_ERR_FOR_TOKEN(token[*tp], input, "expected math expression");
+    Bracket bracket = lexer->token.data.bracket;
 
-    while (IsMulDiv(token, tp))
-    {
-        Operation operation = GetTokenOperation(token, tp);
-        (*tp)++;  
+    return (bracket == Bracket::right);
+}
 
-        Node_t* node2 = GetPow(token, tp, input);
-        Node_t* new_node = {};
-    
-        if (operation == Operation::mul)
-        {
-            _MUL(&new_node, node, node2);
-        }
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-        else if (operation == Operation::dive)
-        {
-            _DIV(&new_node, node, node2);
-        }
+static bool IsOperationBeforeMinus(const Lexer_t* lexer)
+{
+    assert(lexer);
+    assert(IsTokenOperation(lexer));
+    assert(lexer->token.data.operation == Operation::minus);
 
-        else
-        {
-            assert(0 && "not a */ operation in get mul div");
-        }
+    return (lexer->pointer.tp >= 2 && lexer->prevToken.type == TokenType::Operation_t);
+}
 
-        TREE_ASSERT(SwapNode(&node, &new_node));
-    }
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static Number GetTokenNumber(const Lexer_t* lexer)
+{
+    assert(lexer);
+    assert(IsTokenNum(lexer));
 
-    return node;
+    Number number = lexer->token.data.number;
+    return number;
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static Node_t* GetBracket(const Token_t* token, size_t* tp, const char* input)
+static Variable GetTokenVariable(const Lexer_t* lexer)
 {
-    assert(tp);
-    assert(token);
+    assert(lexer);
+    assert(IsTokenVariable(lexer));
 
-    if (IsTokenLeftBracket(token, tp))
-    {
-        (*tp)++;  
-        Node_t* node = GetAddSub(token, tp, input);
-    
-        if (!IsTokenRightBracket(token, tp)) 
-            SYNTAX_ERR_FOR_TOKEN(token[*tp], input, "expected ')'");
+    Variable variable = lexer->token.data.variable;
 
-        (*tp)++;  
-        return node;
-    }
+    return variable;
+}
 
-    RETURN_IF_TRUE(IsTokenVariable(token, tp), GetVariable(token, tp, input));
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-    return GetNumber(token, tp, input);
+static Operation GetTokenOperation(const Lexer_t* lexer)
+{
+    assert(lexer);
+    assert(IsTokenOperation(lexer));
+
+    Operation operation = lexer->token.data.operation;
+    return operation;
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static Node_t* GetPow(const Token_t* token, size_t* tp, const char* input)
+static Function GetTokenFunction(const Lexer_t* lexer)
 {
-    assert(tp);
-    assert(token);
+    assert(lexer);
+    assert(IsTokenFunction(lexer));
 
-    Node_t* node = GetFunction(token, tp, input);
-    while(IsPow(token, tp))
-    {
-        (*tp)++;  
-        Node_t* node2 = GetFunction(token, tp, input);
+    Function function = lexer->token.data.function;
+    return function;
+}
 
-        Node_t* new_node = {};
-        _POW(&new_node, node, node2);
-        TREE_ASSERT(SwapNode(&node, &new_node));
-    }
+//=============================== Token Checks (Build Tree) End =================================================================================================================================
+
+//=============================== Operator Precedence (Build Tree) ===================================================================================================================================
+
+// shunting-yard over tokens from lexer, without recursion, so depth of nesting is limited only by memory.
+// unary minus takes MulDiv, so its priority is between '+' '-' and '*' '/'; all operations are left associative
+TreeErr GetTreeIterative(Node_t** root, const char* input, SyntaxErr_t* syntaxErr)
+{
+    assert(root);
+    assert(input);
+    assert(syntaxErr);
 
-    return node;
+    return GetTreeBuffer(root, input, SIZE_MAX, syntaxErr);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static Node_t* GetFunction(const Token_t* token, size_t* tp, const char* input)
+// nothing is printed and built subtrees are freed, when input is rejected
+TreeErr GetTreeBuffer(Node_t** root, const char* input, size_t inputSize, SyntaxErr_t* syntaxErr)
 {
-    assert(tp);
-    assert(token);
+    assert(root);
+    assert(input);
+    assert(syntaxErr);
 
-    TokenType type = token[*tp].type;
+    Lexer_t lexer = {};
 
-    if (IsTokenMinus(token, tp))
-    {
-        return GetMinus(token, tp, input);
-    }
+    Parser_t parser = {};
+    TreeErr  err    = ParserCtor(&parser);
+    RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err);
+
+    err = LexerCtor(&lexer, input, inputSize);
 
+    if (err.err == TreeErrorType::NO_ERR) err = ParseTokens(&lexer, &parser);
 
-    if (type != TokenType::Function_t)
+    if (err.err != TreeErrorType::NO_ERR)
     {
-        return GetBracket(token, tp, input);
+        *syntaxErr = lexer.syntaxErr;
+        ParserDtor(&parser);
+        return err;
     }
 
-    Function function = GetTokenFunction(token, tp);
+    assert(parser.itemsSize == 0);
+    assert(parser.nodesSize == 1);
 
-    (*tp)++;  
+    *root = PopNode(&parser);
 
-    if (!IsTokenLeftBracket(token, tp))
-        SYNTAX_ERR_FOR_TOKEN(token[*tp], input, "expected '('");
+    ParserDtor(&parser);
 
-    (*tp)++;  
+    return NODE_VERIF(*root, err);
+}
 
-    Node_t* node = GetAddSub(token, tp, input);
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#define _PARSE(func) do { err = func; RETURN_IF_TRUE(err.err != TreeErrorType::NO_ERR, err); } while (0)
 
-    if (!IsTokenRightBracket(token, tp))
-        SYNTAX_ERR_FOR_TOKEN(token[*tp], input, "expected ')'");
+static TreeErr ParseTokens(Lexer_t* lexer, Parser_t* parser)
+{
+    assert(lexer);
+    assert(parser);
 
-    (*tp)++;  
+    TreeErr err = {};
 
-    Node_t* funcNode = {};
+    bool isOperandExpected = true;
 
-    _FUNC(&funcNode, function, node);
+    while (isOperandExpected || !IsTokenEnd(lexer))
+    {
+        if (isOperandExpected) _PARSE(ParseOperand (lexer, parser, &isOperandExpected));
+        else                   _PARSE(ParseOperator(lexer, parser, &isOperandExpected));
+    }
 
-    TREE_ASSERT(SwapNode(&node, &funcNode));
+    _PARSE(ReduceItems(parser, 0));
 
-    return node;
+    RETURN_IF_TRUE(parser->openBrackets > 0, SYNTAX_ERR_FOR_TOKEN(lexer, "expected ')'"));
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static Node_t* GetMinus(const Token_t* token, size_t* tp, const char* input)
+// isOperandExpected stays true after unary minus, function or '('
+static TreeErr ParseOperand(Lexer_t* lexer, Parser_t* parser, bool* isOperandExpected)
 {
-    assert(token);
-    assert(tp);
-
-    if (IsOperationBeforeMinus(token, tp))
-        SYNTAX_ERR_FOR_TOKEN(token[*tp], input, "Operation before '-'");
+    assert(lexer);
+    assert(parser);
+    assert(isOperandExpected);
 
-    (*tp)++;  
+    TreeErr err = {};
 
-    size_t old_tp = *tp;
+    *isOperandExpected = true;
 
-    Node_t* node = GetMulDiv(token, tp, input);
+    if (IsTokenMinus(lexer))
+    {
+        RETURN_IF_TRUE(IsOperationBeforeMinus(lexer), SYNTAX_ERR_FOR_TOKEN(lexer, "Operation before '-'"));
 
-    if (old_tp == *tp)
-        SYNTAX_ERR_FOR_TOKEN(token[*tp], input, "Nothig after '-'");
+        _PARSE(PushItem(parser, ParseItemType::unary_minus_item, Operation::minus, Function::undefined_function));
+        return LexerNext(lexer);
+    }
 
-    Node_t* new_node = {};
-    _SUB(&new_node, node, nullptr);
+    if (IsTokenFunction(lexer))
+    {
+        Function function = GetTokenFunction(lexer);
+        _PARSE(LexerNext(lexer));
 
-    TREE_ASSERT(SwapNode(&node, &new_node));
+        RETURN_IF_FALSE(IsTokenLeftBracket(lexer), SYNTAX_ERR_FOR_TOKEN(lexer, "expected '('"));
 
-    return node;
-}
+        _PARSE(PushItem(parser, ParseItemType::function_item, Operation::undefined_operation, function));
+        return LexerNext(lexer);
+    }
 
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+    if (IsTokenLeftBracket(lexer))
+    {
+        _PARSE(PushItem(parser, ParseItemType::bracket_item, Operation::undefined_operation, Function::undefined_function));
+        return LexerNext(lexer);
+    }
 
-static bool IsTokenEnd(const Token_t* token, const size_t* tp)
-{   
-    assert(token);
-    assert(tp);
+    Node_t* node = {};
 
-    TokenType type = token[*tp].type;
+    if (IsTokenVariable(lexer))
+    {
+        _VAR(&node, GetTokenVariable(lexer));
+    }
 
-    return (type == TokenType::EndSymbol_t);
-}
+    else if (IsTokenNum(lexer))
+    {
+        _NUM(&node, GetTokenNumber(lexer));
+    }
 
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+    else
+    {
+        return SYNTAX_ERR_FOR_TOKEN(lexer, "expected math expressiion");
+    }
 
-static bool IsTokenNum(const Token_t* token, const size_t* tp)
-{
-    assert(token);
-    assert(tp);
+    _PARSE(PushNode(parser, node));
 
-    TokenType type = token[*tp].type;
+    *isOperandExpected = false;
 
-    return (type == TokenType::Number_t);
+    return LexerNext(lexer);
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static bool IsTokenVariable(const Token_t* token, const size_t* tp)
+// isOperandExpected is true after binary operation, or false after ')'
+static TreeErr ParseOperator(Lexer_t* lexer, Parser_t* parser, bool* isOperandExpected)
 {
-    assert(token);
-    assert(tp);
+    assert(lexer);
+    assert(parser);
+    assert(isOperandExpected);
 
-    TokenType type = token[*tp].type;
+    TreeErr err = {};
 
-    return (type == TokenType::Variable_t);
-}
+    if (IsTokenOperation(lexer))
+    {
+        Operation operation = GetTokenOperation(lexer);
 
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+        _PARSE(ReduceItems(parser, GetOperationPriority(operation)));
+        _PARSE(PushItem(parser, ParseItemType::binary_item, operation, Function::undefined_function));
 
-static bool IsTokenOperation(const Token_t* token, const size_t* tp)
-{
-    assert(token);
-    assert(tp);
+        *isOperandExpected = true;
 
-    TokenType type = token[*tp].type;
+        return LexerNext(lexer);
+    }
 
-    return (type == TokenType::Operation_t);
-}
+    RETURN_IF_FALSE(IsTokenRightBracket(lexer), SYNTAX_ERR_FOR_TOKEN(lexer, (parser->openBrackets > 0) ? "expected ')'" : "expected '$'"));
 
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+    _PARSE(ReduceItems(parser, 0));
 
-static bool IsTokenFunction(const Token_t* token, const size_t* tp)
-{   
-    assert(token);
-    assert(tp);
+    RETURN_IF_TRUE(parser->openBrackets == 0, SYNTAX_ERR_FOR_TOKEN(lexer, "expected '$'"));
 
-    TokenType type = token[*tp].type;
+    ParseItem_t bracket = parser->items[--parser->itemsSize];
+    parser->openBrackets--;
 
-    return (type == TokenType::Function_t);
-}
+    if (bracket.type == ParseItemType::function_item)
+    {
+        Node_t* arg  = PopNode(parser);
+        Node_t* node = {};
 
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+        _FUNC(&node, bracket.function, arg);
+        _PARSE(PushNode(parser, node));
+    }
 
-static bool IsAddSub(const Token_t* token, const size_t* tp)
-{   
-    assert(token);
-    assert(tp);
+    *isOperandExpected = false;
 
-    TokenType type = token[*tp].type;
+    return LexerNext(lexer);
+}
 
-    RETURN_IF_FALSE(type == TokenType::Operation_t, false);
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-    Operation operation = token[*tp].data.operation;
+// every operation on top of stack with priority >= given one gets its operands
+static TreeErr ReduceItems(Parser_t* parser, size_t priority)
+{
+    assert(parser);
 
-    return (operation == Operation::plus) || (operation == Operation::minus);
-}
+    TreeErr err = {};
 
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+    while (parser->itemsSize > 0)
+    {
+        const ParseItem_t* top = &parser->items[parser->itemsSize - 1];
 
-static bool IsMulDiv(const Token_t* token, const size_t* tp)
-{   
-    assert(token);
-    assert(tp);
+        if (top->type == ParseItemType::bracket_item || top->type == ParseItemType::function_item) break;
 
-    TokenType type = token[*tp].type;
+        size_t topPriority = (top->type == ParseItemType::unary_minus_item) ? 2 : GetOperationPriority(top->operation);
 
-    RETURN_IF_FALSE(type == TokenType::Operation_t, false);
+        if (topPriority < priority) break;
 
-    Operation operation = token[*tp].data.operation;
+        _PARSE(ReduceItem(parser));
+    }
 
-    return (operation == Operation::mul) || (operation == Operation::dive);
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static bool IsPow(const Token_t* token, const size_t* tp)
-{   
-    assert(token);
-    assert(tp);
-    assert(token + *tp);
+static TreeErr ReduceItem(Parser_t* parser)
+{
+    assert(parser);
+    assert(parser->itemsSize > 0);
 
-    Token_t tokenCopy = token[*tp];
+    ParseItem_t item = parser->items[--parser->itemsSize];
 
-    TokenType type = tokenCopy.type;
+    Node_t* right = PopNode(parser);
+    Node_t* node  = {};
 
-    RETURN_IF_FALSE(type == TokenType::Operation_t, false);
+    if (item.type == ParseItemType::unary_minus_item)
+    {
+        _SUB(&node, right, nullptr);
+    }
 
-    Operation operation = tokenCopy.data.operation;
+    else
+    {
+        Node_t* left = PopNode(parser);
+        _OPER(&node, item.operation, left, right);
+    }
 
-    return (operation == Operation::power);
+    return PushNode(parser, node);
 }
 
+#undef _PARSE
+
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static bool IsTokenLeftBracket (const Token_t* token, const size_t* tp)
+// unary minus has priority 2
+static size_t GetOperationPriority(Operation operation)
 {
-    assert(token);
-    assert(tp);
-
-    TokenType type = token[*tp].type;
-
-    RETURN_IF_FALSE(type == TokenType::Bracket_t, false);
-
-    Bracket bracket = token[*tp].data.bracket;
+    switch (operation)
+    {
+        case Operation::plus:
+        case Operation::minus: return 1;
+        case Operation::mul:
+        case Operation::dive:  return 3;
+        case Operation::power: return 4;
+        case Operation::undefined_operation:
+        default: assert(0 && "undefined operation in parser.\n"); break;
+    }
 
-    return (bracket == Bracket::left);
+    return 0;
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static bool IsTokenMinus(const Token_t* token, const size_t* tp)
+static TreeErr ParserCtor(Parser_t* parser)
 {
-    assert(token);
-    assert(tp);
+    assert(parser);
 
-    TokenType type = token[*tp].type;
+    static const size_t StartCapacity = 64;
 
-    RETURN_IF_FALSE(type == TokenType::Operation_t, false);
+    TreeErr err = {};
 
-    Operation operation = token[*tp].data.operation;
+    *parser = {};
 
-    return (operation == Operation::minus);
+    parser->items         = (ParseItem_t*) calloc(StartCapacity, sizeof(ParseItem_t));
+    parser->itemsCapacity = StartCapacity;
+
+    parser->nodes         = (Node_t**)     calloc(StartCapacity, sizeof(Node_t*));
+    parser->nodesCapacity = StartCapacity;
+
+    if (!parser->items || !parser->nodes)
+    {
+        ParserDtor(parser);
+        err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static bool IsTokenRightBracket(const Token_t* token, const size_t* tp)
+// subtrees, that are left on stack after syntax error, are freed too
+static void ParserDtor(Parser_t* parser)
 {
-    assert(token);
-    assert(tp);
+    assert(parser);
 
-    TokenType type = token[*tp].type;
+    while (parser->nodesSize > 0) TREE_ASSERT(NodeAndUnderTreeDtor(PopNode(parser)));
 
-    RETURN_IF_FALSE(type == TokenType::Bracket_t, false);
+    FREE(parser->items);
+    FREE(parser->nodes);
 
-    Bracket bracket = token[*tp].data.bracket;
+    *parser = {};
 
-    return (bracket == Bracket::right);
+    return;
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static bool IsOperationBeforeMinus(const Token_t* token, const size_t* tp)
+// on realloc fail old stack stays in parser, ParserDtor frees it
+static TreeErr PushItem(Parser_t* parser, ParseItemType type, Operation operation, Function function)
 {
-    assert(token);
-    assert(tp);
-    assert(IsOperationToken(token, *tp));
-    assert(token[*tp].data.operation == Operation::minus);
+    assert(parser);
 
-    return (*tp >= 1 && IsOperationToken(token, *tp - 1));   
-}
-
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-
-static bool IsOperationToken(const Token_t* token, size_t tp)
-{
-    assert(token);
+    TreeErr err = {};
 
-    TokenType type = token[tp].type;
+    if (parser->itemsSize == parser->itemsCapacity)
+    {
+        ParseItem_t* items = (ParseItem_t*) realloc(parser->items, 2 * parser->itemsCapacity * sizeof(ParseItem_t));
+        RETURN_IF_FALSE(items, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
 
-    return (type == TokenType::Operation_t);   
-}
+        parser->items          = items;
+        parser->itemsCapacity *= 2;
+    }
 
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+    parser->items[parser->itemsSize++] = {type, operation, function};
 
-static Number GetTokenNumber(const Token_t* token, const size_t* tp)
-{
-    assert(token);
-    assert(tp);
-    assert(IsTokenNum(token, tp));
+    if (type == ParseItemType::bracket_item || type == ParseItemType::function_item) parser->openBrackets++;
 
-    Number number = token[*tp].data.number;
-    return number;
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static Variable GetTokenVariable(const Token_t* token, const size_t* tp)
+// node, that didn't get on stack, is freed here: ParserDtor doesn't see it
+static TreeErr PushNode(Parser_t* parser, Node_t* node)
 {
-    assert(token);
-    assert(tp);
-    assert(IsTokenVariable(token, tp));
+    assert(parser);
+    assert(node);
 
-    Variable variable = token[*tp].data.variable;
+    TreeErr err = {};
 
-    return variable;
-}
+    if (parser->nodesSize == parser->nodesCapacity)
+    {
+        Node_t** nodes = (Node_t**) realloc(parser->nodes, 2 * parser->nodesCapacity * sizeof(Node_t*));
 
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+        if (!nodes)
+        {
+            TREE_ASSERT(NodeAndUnderTreeDtor(node));
+            err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+            CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+            return err;
+        }
 
-static Operation GetTokenOperation(const Token_t* token, const size_t* tp)
-{
-    assert(token);
-    assert(tp);
-    assert(IsTokenOperation(token, tp));
+        parser->nodes          = nodes;
+        parser->nodesCapacity *= 2;
+    }
 
-    Operation operation = token[*tp].data.operation;
-    return operation;
+    parser->nodes[parser->nodesSize++] = node;
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
 }
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static Function GetTokenFunction(const Token_t* token, const size_t* tp)
+static Node_t* PopNode(Parser_t* parser)
 {
-    assert(token);
-    assert(tp);
-    assert(IsTokenFunction(token, tp));
+    assert(parser);
+    assert(parser->nodesSize > 0);
 
-    Function function = token[*tp].data.function;
-    return function;
+    return parser->nodes[--parser->nodesSize];
 }
 
-//=============================== Recursive Descent (Build Tree) End =================================================================================================================================
+//=============================== Operator Precedence (Build Tree) End ===============================================================================================================================
 
 // const char* ReadFile(const char* file)
 // {
@@ -1112,3 +1329,4 @@ static Function GetTokenFunction(const Token_t* token, const size_t* tp)
 // }
 
 #undef SYNTAX_ERR
+#undef SYNTAX_ERR_FOR_TOKEN
@@ -12,6 +12,7 @@ struct FilePlace
 {
     size_t line;
     size_t placeInLine;
+    size_t offset;      // from start of input
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -64,9 +65,24 @@ struct Token_t
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-Token_t* ReadInputStr (const char* input, size_t* tokenArrSize);
-void     TokenDtor    (Token_t* tokenArr);
-Node_t*  GetTree      (const Token_t* tokens, const char* input);
+// input is rejected with INPUT_SYNTAX_ERROR, syntaxErr tells where and why
+struct SyntaxErr_t
+{
+    FilePlace   place;
+    const char* msg;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// reading stops at '$'
+TreeErr  GetTreeIterative(Node_t** root, const char* input, SyntaxErr_t* syntaxErr);
+
+// expression is input[0, inputSize) and needs no '$': end of buffer is end of expression.
+// input[inputSize] is read by lexer, so it must be a separator ('$', '\n' or '\0'), as in BulkInput
+TreeErr  GetTreeBuffer   (Node_t** root, const char* input, size_t inputSize, SyntaxErr_t* syntaxErr);
+
+// prints line of input with error and points to its place
+void     SyntaxErrPrint  (const char* input, const SyntaxErr_t* syntaxErr);
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
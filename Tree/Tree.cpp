@@ -1,9 +1,12 @@
 #include <malloc.h>
 #include <assert.h>
 #include <string.h>
+#include <math.h>
 #include "Tree.h"
 #include "TreeDump.h"
 #include "ReadTree.h"
+#include "NodeTable.h"
+#include "../Differentiator/MathFunctions.h"
 #include "../Common/ColorPrint.h"
 #include "../Common/GlobalInclude.h"
 
@@ -20,24 +23,82 @@ static bool         IsNodeVariableTypeUndef        (const Node_t* node);
 
 //======================================================================================================================================================================
 
+static TreeErr      TreeCtorHelper             (Tree_t* tree, const char* input, size_t inputSize, SyntaxErr_t* syntaxErr);
 static void         PrintError                 (const TreeErr* err);
 static TreeErr      AllNodeVerif               (const Node_t* node, size_t* treeSize);
 
+//======================================================================================================================================================================
+
+static NodeArena_t* GetCurrentArena            ();
+static bool         IsDagArena                 (const NodeArena_t* arena);
+static Node_t*      NodeArenaAlloc             (NodeArena_t* arena);
+static void         NodeArenaFree              (NodeArena_t* arena, Node_t* node);
+static bool         IsArenaNode                (const NodeArena_t* arena, const Node_t* node);
+
+static uint32_t     NodeVarMask                (NodeArgType type, NodeData_t data, const Node_t* left, const Node_t* right);
+
+static const size_t NodeBlockMinCapacity = 64;
+static const size_t NodeBlockMaxCapacity = 1 << 16;
+static const size_t UniqueTableCapacity  = 1 << 10;
+
+// there is no default arena: node without tree would live until end of thread
+static thread_local NodeArena_t* CurrentArena = nullptr;
+
 
 //============================== Tree functions ============================================================================================================================
 
 TreeErr TreeCtor(Tree_t* tree, const char* input)
 {
-    TreeErr err = {};
+    assert(tree);
+    assert(input);
+
+    return TreeCtorHelper(tree, input, SIZE_MAX, nullptr);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr DagCtor(Tree_t* dag, const char* input)
+{
+    assert(dag);
+    assert(input);
+
+    TREE_ASSERT(DagArenaCtor(&dag->arena));
+
+    return TreeCtorHelper(dag, input, SIZE_MAX, nullptr);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr TreeCtorBuffer(Tree_t* tree, const char* input, size_t inputSize, SyntaxErr_t* syntaxErr)
+{
+    assert(tree);
+    assert(input);
+    assert(syntaxErr);
+
+    return TreeCtorHelper(tree, input, inputSize, syntaxErr);
+}
 
-    size_t tokenQuant = 0;
-    Token_t* token = ReadInputStr(input, &tokenQuant);
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// without syntaxErr of caller, syntax error is printed with line of input
+static TreeErr TreeCtorHelper(Tree_t* tree, const char* input, size_t inputSize, SyntaxErr_t* syntaxErr)
+{
+    SyntaxErr_t localSyntaxErr = {};
+    if (!syntaxErr) syntaxErr = &localSyntaxErr;
+
+    NodeArena_t* oldArena = NodeArenaSwitch(&tree->arena);
+    TreeErr      err      = GetTreeBuffer(&tree->root, input, inputSize, syntaxErr);
+    NodeArenaSwitch(oldArena);
 
-    TOKEN_GRAPHIC_DUMP(token, tokenQuant);
+    if (err.err != TreeErrorType::NO_ERR)
+    {
+        if (err.err == TreeErrorType::INPUT_SYNTAX_ERROR && syntaxErr == &localSyntaxErr) SyntaxErrPrint(input, syntaxErr);
 
-    tree->root = GetTree(token, input);
+        TREE_ASSERT(NodeArenaDtor(&tree->arena));
+        tree->root = nullptr;
 
-    TokenDtor(token);
+        return err;
+    }
 
     return TREE_VERIF(tree, err);
 }
@@ -51,7 +112,7 @@ TreeErr TreeDtor(Tree_t* tree)
 
     TreeErr Err = {};
 
-    TREE_ASSERT(NodeAndUnderTreeDtor(tree->root));
+    TREE_ASSERT(NodeArenaDtor(&tree->arena));
 
     tree->size = 0;
     tree->root = nullptr;
@@ -65,7 +126,7 @@ TreeErr NodeAndUnderTreeDtor(Node_t* node)
 {
     TreeErr err = {};
 
-    if (node == nullptr)
+    if (node == nullptr || IsDagArena(GetCurrentArena()))
     {
         return err;
     }
@@ -91,7 +152,15 @@ TreeErr NodeCtor(Node_t** node, NodeArgType type, NodeData_t data, Node_t* left,
 {
     TreeErr err = {};
 
-    *node = (Node_t*) calloc(1, sizeof(Node_t));
+    NodeArena_t* arena = GetCurrentArena();
+
+    if (IsDagArena(arena))
+    {
+        *node = NodeTableFind(arena->unique, type, data, left, right);
+        RETURN_IF_TRUE(*node, err);
+    }
+
+    *node = NodeArenaAlloc(arena);
 
     if (*node == NULL)
     {
@@ -106,7 +175,17 @@ TreeErr NodeCtor(Node_t** node, NodeArgType type, NodeData_t data, Node_t* left,
     (*node)->left      = left;
     (*node)->right     = right;
 
-    return NODE_VERIF(*node, err);
+    (*node)->hash      = NodeHash(type, data, left, right);
+    (*node)->varMask   = NodeVarMask(type, data, left, right);
+
+    err = NODE_VERIF(*node, err);
+
+    if (IsDagArena(arena) && err.err == TreeErrorType::NO_ERR)
+    {
+        err = NodeTableInsert(arena->unique, *node);
+    }
+
+    return err;
 }
 
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -117,15 +196,175 @@ TreeErr NodeDtor(Node_t* node)
 
     TreeErr err = {};
 
-    node->left  = nullptr;
-    node->right = nullptr;
+    NodeArena_t* arena = GetCurrentArena();
+
+    if (!IsDagArena(arena))
+    {
+        NodeArenaFree(arena, node);
+    }
+
+    CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+    return err;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+NodeArena_t* NodeArenaSwitch(NodeArena_t* arena)
+{
+    NodeArena_t* oldArena = CurrentArena;
+    CurrentArena = arena;
+    return oldArena;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+TreeErr NodeArenaDtor(NodeArena_t* arena)
+{
+    assert(arena);
+
+    TreeErr err = {};
+
+    NodeBlock_t* block = arena->block;
+
+    while (block)
+    {
+        NodeBlock_t* prev = block->prev;
 
-    FREE(node);
+        FREE(block->nodes);
+        FREE(block);
+
+        block = prev;
+    }
+
+    arena->block    = nullptr;
+    arena->freeNode = nullptr;
+
+    if (arena->unique)
+    {
+        TREE_ASSERT(NodeTableDtor(arena->unique));
+        FREE(arena->unique);
+    }
 
     CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
     return err;
 }
 
+//---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// arena with unique table makes tree hash-consed dag, it must be done before first node is built
+TreeErr DagArenaCtor(NodeArena_t* arena)
+{
+    assert(arena);
+    assert(!arena->block);
+    assert(!arena->unique);
+
+    TreeErr err = {};
+
+    arena->unique = (NodeTable_t*) calloc(1, sizeof(NodeTable_t));
+
+    if (!arena->unique)
+    {
+        err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    return NodeTableCtor(arena->unique, UniqueTableCapacity);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static NodeArena_t* GetCurrentArena()
+{
+    assert(CurrentArena && "nodes are built and freed only in arena of tree, NodeArenaSwitch to it first.\n");
+
+    return CurrentArena;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static bool IsDagArena(const NodeArena_t* arena)
+{
+    assert(arena);
+
+    return arena->unique != nullptr;
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static Node_t* NodeArenaAlloc(NodeArena_t* arena)
+{
+    assert(arena);
+
+    Node_t* node = arena->freeNode;
+
+    if (node)
+    {
+        arena->freeNode = node->right;
+        *node = {};
+        return node;
+    }
+
+    NodeBlock_t* block = arena->block;
+
+    if (!block || block->used == block->capacity)
+    {
+        size_t capacity = block ? 2 * block->capacity : NodeBlockMinCapacity;
+        if (capacity > NodeBlockMaxCapacity) capacity = NodeBlockMaxCapacity;
+
+        NodeBlock_t* newBlock = (NodeBlock_t*) calloc(1, sizeof(NodeBlock_t));
+        RETURN_IF_FALSE(newBlock, nullptr);
+
+        newBlock->nodes = (Node_t*) calloc(capacity, sizeof(Node_t));
+        RETURN_IF_FALSE(newBlock->nodes, nullptr, FREE(newBlock));
+
+        newBlock->prev     = block;
+        newBlock->capacity = capacity;
+        newBlock->used     = 0;
+
+        arena->block = newBlock;
+        block        = newBlock;
+    }
+
+    node = &block->nodes[block->used];
+    block->used++;
+
+    return node;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static void NodeArenaFree(NodeArena_t* arena, Node_t* node)
+{
+    assert(arena);
+    assert(node);
+    assert(IsArenaNode(arena, node) && "node is freed not into arena, it was built in.\n");
+
+    node->type  = NodeArgType::undefined;
+    node->left  = nullptr;
+    node->right = arena->freeNode;
+
+    arena->freeNode = node;
+
+    return;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// free list of other arena would give node to other tree, and it would die with its own arena under that tree
+static bool IsArenaNode(const NodeArena_t* arena, const Node_t* node)
+{
+    assert(arena);
+    assert(node);
+
+    for (const NodeBlock_t* block = arena->block; block; block = block->prev)
+    {
+        RETURN_IF_TRUE(block->nodes <= node && node < block->nodes + block->used, true);
+    }
+
+    return false;
+}
+
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
 TreeErr NodeCopy(Node_t** copy, const Node_t* node)
@@ -136,26 +375,34 @@ TreeErr NodeCopy(Node_t** copy, const Node_t* node)
 
     NodeArgType type  = node->type;
     NodeData_t  data  = node->data;
-    Node_t*     left  = node->left;
-    Node_t*     right = node->right;
-
-    TREE_ASSERT(NodeCtor(copy, type, data, left, right));
+    Node_t*     left  = nullptr;
+    Node_t*     right = nullptr;
 
+    NodeArena_t* arena = GetCurrentArena();
 
-    if (*copy == nullptr)
+    // node of this dag is its own copy
+    if (IsDagArena(arena))
     {
-        err.err = TreeErrorType::NODE_NULL;
-        return NODE_VERIF(*copy, err);
+        Node_t* own = NodeTableFind(arena->unique, type, data, node->left, node->right);
+        RETURN_IF_TRUE(own == node, NODE_VERIF(*copy, err), *copy = own);
     }
 
     if (node->left)
     {
-        TREE_ASSERT(NodeCopy(&(*copy)->left,  node->left));
+        TREE_ASSERT(NodeCopy(&left,  node->left));
     }
 
     if (node->right)
     {
-        TREE_ASSERT(NodeCopy(&(*copy)->right, node->right));
+        TREE_ASSERT(NodeCopy(&right, node->right));
+    }
+
+    TREE_ASSERT(NodeCtor(copy, type, data, left, right));
+
+    if (*copy == nullptr)
+    {
+        err.err = TreeErrorType::NODE_NULL;
+        return NODE_VERIF(*copy, err);
     }
 
     return NODE_VERIF(*copy, err);
@@ -223,9 +470,95 @@ TreeErr SetNode(Node_t* node, NodeArgType type, NodeData_t data, Node_t* left, N
 
     node->data = data;
 
+    node->hash    = NodeHash(type, data, left, right);
+    node->varMask = NodeVarMask(type, data, left, right);
+
+    return NODE_VERIF(node, err);
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// recomputes cached fields of node, must be called after its children were changed in place
+TreeErr NodeUpdate(Node_t* node)
+{
+    assert(node);
+
+    TreeErr err = {};
+
+    node->hash    = NodeHash   (node->type, node->data, node->left, node->right);
+    node->varMask = NodeVarMask(node->type, node->data, node->left, node->right);
+
     return NODE_VERIF(node, err);
 }
 
+//---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+uint32_t VariableBit(Variable var)
+{
+    switch (var)
+    {
+        case Variable::x: return 1u << 0;
+        case Variable::y: return 1u << 1;
+        case Variable::undefined_variable:
+        default: assert(0 && "undefined variable.\n"); break;
+    }
+
+    return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static uint32_t NodeVarMask(NodeArgType type, NodeData_t data, const Node_t* left, const Node_t* right)
+{
+    uint32_t mask = (type == NodeArgType::variable) ? VariableBit(data.var) : 0;
+
+    if (left)  mask |= left->varMask;
+    if (right) mask |= right->varMask;
+
+    return mask;
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+bool TreeEqual(const Node_t* first, const Node_t* second)
+{
+    RETURN_IF_TRUE(first == second,                         true);
+    RETURN_IF_TRUE(!first || !second,                       false);
+    RETURN_IF_TRUE(first->hash != second->hash,             false);
+    RETURN_IF_TRUE(first->type != second->type,             false);
+    RETURN_IF_FALSE(NodeDataEqual(first->type, first->data, second->data), false);
+
+    return TreeEqual(first->left, second->left) && TreeEqual(first->right, second->right);
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+double (*GetMathFunction(Function function)) (double)
+{
+    switch (function)
+    {
+        case Function::Sqrt:   return sqrt;
+        case Function::Ln:     return log;
+        case Function::Sin:    return sin;
+        case Function::Cos:    return cos;
+        case Function::Tg:     return tan;
+        case Function::Ctg:    return ctg;
+        case Function::Sh:     return sinh;
+        case Function::Ch:     return cosh;
+        case Function::Th:     return tanh;
+        case Function::Cth:    return ctgh;
+        case Function::Arcsin: return asin;
+        case Function::Arccos: return acos;
+        case Function::Arctg:  return atan;
+        case Function::Arcctg: return actg;
+        case Function::undefined_function:
+        default: assert(0 && "undefined function type"); break;
+    }
+
+    assert(0 && "we must be here");
+    return nullptr;
+}
+
 //---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
 TreeErr SwapNode(Node_t** node1, Node_t** node2)
@@ -259,6 +592,12 @@ TreeErr TreeVerif(const Tree_t* tree, TreeErr* err, const char* file, const int
 
     RETURN_IF_TRUE(IsError(err), *err);
 
+    // dag nodes are immutable and every one was verified in NodeCtor, walking shared subtrees again is exponential
+    if (tree->arena.unique)
+    {
+        return NodeVerif(tree->root, err, file, line, func);
+    }
+
     size_t treeSize = 0;
     *err = AllNodeVerif(tree->root, &treeSize);
 
@@ -450,6 +789,7 @@ static bool IsNodeVariableTypeUndef(const Node_t* node)
 
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
+// explicit stack instead of recursion, so long chains of operations from parser don't overflow call stack
 static TreeErr AllNodeVerif(const Node_t* node, size_t* treeSize)
 {
     assert(node);
@@ -457,129 +797,125 @@ static TreeErr AllNodeVerif(const Node_t* node, size_t* treeSize)
 
     TreeErr err = {};
 
-    TREE_ASSERT(NODE_VERIF(node, err));
+    size_t stackSize     = 0;
+    size_t stackCapacity = 64;
 
-    if (node->left)
-    {
-        (*treeSize)++;
-        err = AllNodeVerif(node->left, treeSize);
-        RETURN_IF_TRUE(IsError(&err), err);
-    }
-
-    if (node->right)
-    {
-        (*treeSize)++;
-        err = AllNodeVerif(node->right, treeSize);
-        RETURN_IF_TRUE(IsError(&err), err);
-    }
-
-    return err;
-}
-
-//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+    const Node_t** stack = (const Node_t**) calloc(stackCapacity, sizeof(*stack));
+    RETURN_IF_FALSE(stack, err, err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL, CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__));
 
-static void PrintError(const TreeErr* Err)
-{
-    assert(Err);
-    TreeErrorType err = Err->err;
+    stack[stackSize++] = node;
 
-    switch (err)
+    while (stackSize > 0)
     {
-        case TreeErrorType::NO_ERR:
-            return;
-            break;
-    
-        case TreeErrorType::NODE_NULL:
-            COLOR_PRINT(RED, "Error: node is nullptr and now this is bad.\n");
-            break;
-        
-        case TreeErrorType::CTOR_CALLOC_RETURN_NULL:
-            COLOR_PRINT(RED, "Error: failed alocate memory in ctor.\n");
-            break;
+        node = stack[--stackSize];
 
-        case TreeErrorType::INSERT_INCORRECT_SITUATION:
-            COLOR_PRINT(RED, "Error: undefined situation in insert.\n");
-            break;
+        TREE_ASSERT(NODE_VERIF(node, err));
 
-        case TreeErrorType::DTOR_NODE_WITH_CHILDREN:
-            COLOR_PRINT(RED, "Error: Dtor node that childern has.\n");
-            break;
-        
-        case TreeErrorType::INCORRECT_TREE_SIZE:
-            COLOR_PRINT(RED, "Error: Incorrect tree size.\n");
+        if (node->hash != NodeHash(node->type, node->data, node->left, node->right))
+        {
+            err.err = TreeErrorType::NODE_HASH_INCORRECT;
+            CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
             break;
+        }
 
-        case TreeErrorType::NUM_TYPE_NODES_ARG_IS_UNDEFINED:
-            COLOR_PRINT(RED, "Error: Node has 'number' type, but arg is undefined.\n");
+        if (node->varMask != NodeVarMask(node->type, node->data, node->left, node->right))
+        {
+            err.err = TreeErrorType::NODE_VAR_MASK_INCORRECT;
+            CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
             break;
+        }
 
-        case TreeErrorType::NUM_HAS_INCORRECT_CHILD_QUANT:
-            COLOR_PRINT(RED, "Error: Node has 'number' type, but child quant is incorrect.\n");
-            break;
-        
-        case TreeErrorType::VAR_TYPE_NODES_ARG_IS_UNDEFINED:
-            COLOR_PRINT(RED, "Error: Node has 'variable' type, but arg is undefined.\n");
-            break;
+        if (stackSize + 2 > stackCapacity)
+        {
+            const Node_t** newStack = (const Node_t**) realloc(stack, 2 * stackCapacity * sizeof(*stack));
 
-        case TreeErrorType::VAR_HAS_INCORRECT_CHILD_QUANT:
-            COLOR_PRINT(RED, "Error: Node has 'varible' type, but child quant is incorrect.\n");
-            break;
+            if (!newStack)
+            {
+                err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+                CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+                break;
+            }
 
-        case TreeErrorType::OPER_TYPE_NODES_ARG_IS_UNDEFINED:
-            COLOR_PRINT(RED, "Error: Node has 'operation' type, but arg is undefined.\n");
-            break;
+            stack          = newStack;
+            stackCapacity *= 2;
+        }
 
-        case TreeErrorType::OPER_HAS_INCORRECT_CHILD_QUANT:
-            COLOR_PRINT(RED, "Error: Node has 'operation' type, but child quant is incorrect.\n");
-            break;
+        // right is pushed first, so left subtree is checked first, as before
+        if (node->right)
+        {
+            (*treeSize)++;
+            stack[stackSize++] = node->right;
+        }
 
-        case TreeErrorType::FUNC_TYPE_NODES_ARG_IS_UNDEFINED:
-            COLOR_PRINT(RED, "Error: Node has 'function' type, but arg is undefined type.\n");
-            break;
+        if (node->left)
+        {
+            (*treeSize)++;
+            stack[stackSize++] = node->left;
+        }
+    }
 
-        case TreeErrorType::FUNC_HAS_INCORRECT_CHILD_QUANT:
-            COLOR_PRINT(RED, "Error: Node has 'function' type, but child quant is incorrect.\n");
-            break;
+    FREE(stack);
 
-        case TreeErrorType::UNDEFINED_NODE_TYPE:
-            COLOR_PRINT(RED, "Error: Node has undefined type.\n");
-            break;
+    return err;
+}
 
-        case TreeErrorType::NODE_IS_NUM_TYPE_BUT_OTHER_NODE_TYPED_IS_UNDEFINED:
-            COLOR_PRINT(RED, "Error: Node has 'number' type, but not only her 'number' type is defined.\n");
-            break;
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-        case TreeErrorType::NODE_IS_OPERATION_TYPE_BUT_OTHER_NODE_TYPED_IS_UNDEFINED:
-            COLOR_PRINT(RED, "Error: Node has 'operation' type, but not only her 'operation' type is defined.\n");
-            break;
+static void PrintError(const TreeErr* Err)
+{
+    assert(Err);
 
-        case TreeErrorType::NODE_IS_FUNCTION_TYPE_BUT_OTHER_NODE_TYPED_IS_UNDEFINED:
-            COLOR_PRINT(RED, "Error: Node has 'function' type, but not only her 'function' type is defined.\n");
-            break;
+    if (Err->err == TreeErrorType::NO_ERR) return;
 
-        case TreeErrorType::NODE_IS_VARIABLE_TYPE_BUT_OTHER_NODE_TYPED_IS_UNDEFINED:
-            COLOR_PRINT(RED, "Error: Node has 'variable' type, but not only her 'variable' type is defined.\n");
-            break;
-        
-        case TreeErrorType::UNDEFINED_FUNCTION_TYPE:
-            COLOR_PRINT(RED, "Error: Node has 'function' type, bit it is undefined.\n");
-            break;
+    COLOR_PRINT(RED, "Error: %s\n", TreeErrorMessage(Err->err));
 
-        case TreeErrorType::UNDEFINED_OPERATION_TYPE:
-            COLOR_PRINT(RED, "Error: Node has 'operation' type, bit it is undefined.\n");
-            break;
+    return;
+}
 
-        case TreeErrorType::DIVISION_BY_0:
-            COLOR_PRINT(RED, "Error: division by 0.\n");
-            break;
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
+const char* TreeErrorMessage(TreeErrorType err)
+{
+    switch (err)
+    {
+        case TreeErrorType::NODE_NULL:                                                return "node is nullptr and now this is bad.";
+        case TreeErrorType::CTOR_CALLOC_RETURN_NULL:                                  return "failed alocate memory in ctor.";
+        case TreeErrorType::INSERT_INCORRECT_SITUATION:                               return "undefined situation in insert.";
+        case TreeErrorType::DTOR_NODE_WITH_CHILDREN:                                  return "Dtor node that childern has.";
+        case TreeErrorType::INCORRECT_TREE_SIZE:                                      return "Incorrect tree size.";
+        case TreeErrorType::NUM_TYPE_NODES_ARG_IS_UNDEFINED:                          return "Node has 'number' type, but arg is undefined.";
+        case TreeErrorType::NUM_HAS_INCORRECT_CHILD_QUANT:                            return "Node has 'number' type, but child quant is incorrect.";
+        case TreeErrorType::VAR_TYPE_NODES_ARG_IS_UNDEFINED:                          return "Node has 'variable' type, but arg is undefined.";
+        case TreeErrorType::VAR_HAS_INCORRECT_CHILD_QUANT:                            return "Node has 'varible' type, but child quant is incorrect.";
+        case TreeErrorType::OPER_TYPE_NODES_ARG_IS_UNDEFINED:                         return "Node has 'operation' type, but arg is undefined.";
+        case TreeErrorType::OPER_HAS_INCORRECT_CHILD_QUANT:                           return "Node has 'operation' type, but child quant is incorrect.";
+        case TreeErrorType::FUNC_TYPE_NODES_ARG_IS_UNDEFINED:                         return "Node has 'function' type, but arg is undefined type.";
+        case TreeErrorType::FUNC_HAS_INCORRECT_CHILD_QUANT:                           return "Node has 'function' type, but child quant is incorrect.";
+        case TreeErrorType::UNDEFINED_NODE_TYPE:                                      return "Node has undefined type.";
+        case TreeErrorType::NODE_IS_NUM_TYPE_BUT_OTHER_NODE_TYPED_IS_UNDEFINED:       return "Node has 'number' type, but not only her 'number' type is defined.";
+        case TreeErrorType::NODE_IS_OPERATION_TYPE_BUT_OTHER_NODE_TYPED_IS_UNDEFINED: return "Node has 'operation' type, but not only her 'operation' type is defined.";
+        case TreeErrorType::NODE_IS_FUNCTION_TYPE_BUT_OTHER_NODE_TYPED_IS_UNDEFINED:  return "Node has 'function' type, but not only her 'function' type is defined.";
+        case TreeErrorType::NODE_IS_VARIABLE_TYPE_BUT_OTHER_NODE_TYPED_IS_UNDEFINED:  return "Node has 'variable' type, but not only her 'variable' type is defined.";
+        case TreeErrorType::UNDEFINED_FUNCTION_TYPE:                                  return "Node has 'function' type, bit it is undefined.";
+        case TreeErrorType::UNDEFINED_OPERATION_TYPE:                                 return "Node has 'operation' type, bit it is undefined.";
+        case TreeErrorType::DIVISION_BY_0:                                            return "division by 0.";
+        case TreeErrorType::FLAT_CHILD_INDEX_INCORRECT:                               return "flat tree node has child with not less index.";
+        case TreeErrorType::NODE_HASH_INCORRECT:                                      return "cached hash of node doesn't match its subtree.";
+        case TreeErrorType::NODE_VAR_MASK_INCORRECT:                                  return "cached variable mask of node doesn't match its subtree.";
+        case TreeErrorType::CODE_GENERATE_FAILED:                                     return "generated code wasn't built or loaded.";
+        case TreeErrorType::NOT_RATIONAL_EXPRESSION:                                  return "expression has functions, not integer power or number, that is not rational.";
+        case TreeErrorType::RATIONAL_OVERFLOW:                                        return "rational coefficient doesn't fit in 64 bits.";
+        case TreeErrorType::INPUT_FILE_READ_FAILED:                                   return "can't open or map input file.";
+        case TreeErrorType::OUTPUT_FILE_OPEN_FAILED:                                  return "can't open output file.";
+        case TreeErrorType::INPUT_SYNTAX_ERROR:                                       return "syntax error in input expression.";
+        case TreeErrorType::THREAD_CREATE_FAILED:                                     return "can't start worker thread.";
+        case TreeErrorType::NO_ERR:
         default:
-            assert(0 && "you forgot about some error in print error.\n");
-            return;
+            assert(0 && "you forgot about some error in error message.\n");
             break;
     }
 
-    return;
+    return "unknown error.";
 }
 
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include "../Common/ColorPrint.h"
 #include "../Common/GlobalInclude.h"
 
@@ -31,6 +32,16 @@ enum TreeErrorType
     INCORRECT_TREE_SIZE,
     DIVISION_BY_0,
     NODE_NULL,
+    FLAT_CHILD_INDEX_INCORRECT,
+    NODE_HASH_INCORRECT,
+    NODE_VAR_MASK_INCORRECT,
+    CODE_GENERATE_FAILED,
+    NOT_RATIONAL_EXPRESSION,
+    RATIONAL_OVERFLOW,
+    INPUT_FILE_READ_FAILED,
+    OUTPUT_FILE_OPEN_FAILED,
+    INPUT_SYNTAX_ERROR,
+    THREAD_CREATE_FAILED,
 };
 
 
@@ -106,30 +117,73 @@ union NodeData_t
 struct Node_t
 {
     NodeArgType type;
+    uint32_t    varMask; // VariableBit of every variable in subtree, kept together with hash
     NodeData_t  data;
     Node_t*     right;
     Node_t*     left;
+    size_t      hash;   // structural hash of subtree, NodeCtor and SetNode keep it, NodeUpdate repairs it after children change
 };
 
 
 
+// nodes of one tree live in blocks of its arena, blocks grow twice up to NodeBlockMaxCapacity
+struct NodeBlock_t
+{
+    NodeBlock_t* prev;
+    Node_t*      nodes;
+    size_t       capacity;
+    size_t       used;
+};
+
+
+struct NodeTable_t;
+struct SyntaxErr_t;
+
+
+// freed nodes are linked into freeNode list through their 'right' field
+// if unique table is set, tree is hash-consed dag: nodes are shared, immutable and die only with arena
+struct NodeArena_t
+{
+    NodeBlock_t* block;
+    Node_t*      freeNode;
+    NodeTable_t* unique;
+};
+
+
 struct Tree_t
 {
-    Node_t* root;
-    size_t  size;
+    Node_t*     root;
+    size_t      size;
+    NodeArena_t arena;
 };
-    
+
 
 TreeErr TreeCtor               (Tree_t* tree, const char* input);
+TreeErr DagCtor                (Tree_t* dag,  const char* input);
+// parses input[0, inputSize) without copying, e.g. one expression of mapped file (see BulkInput).
+// rejected input is not printed: place and reason are in syntaxErr, tree is left empty
+TreeErr TreeCtorBuffer         (Tree_t* tree, const char* input, size_t inputSize, SyntaxErr_t* syntaxErr);
 TreeErr TreeDtor               (Tree_t*  root);
 TreeErr NodeCtor               (Node_t** node, NodeArgType type, NodeData_t data, Node_t* left, Node_t* right);
 TreeErr NodeDtor               (Node_t*  node);
 TreeErr NodeAndUnderTreeDtor   (Node_t* node);
 
+// NodeCtor and NodeDtor work with current arena of the thread, it must be set. Node is freed only into arena, it was built in
+NodeArena_t* NodeArenaSwitch   (NodeArena_t* arena);
+TreeErr      NodeArenaDtor     (NodeArena_t* arena);
+TreeErr      DagArenaCtor      (NodeArena_t* arena);
+
 TreeErr NodeCopy               (Node_t** copy, const Node_t* node);
 TreeErr NodeSetCopy            (Node_t*  copy, const Node_t* node);
 TreeErr SetNode                (Node_t*  node, NodeArgType type, NodeData_t data, Node_t* left, Node_t* right);
 TreeErr SwapNode               (Node_t** node1, Node_t** node2);
+TreeErr NodeUpdate             (Node_t*  node);
+uint32_t VariableBit           (Variable var);
+
+// compares subtrees by structure, different hashes reject in O(1)
+bool    TreeEqual              (const Node_t* first, const Node_t* second);
+
+double (*GetMathFunction(Function function)) (double);
 
 TreeErr TreeVerif              (const Tree_t* tree, TreeErr* Err, const char* file, const int line, const char* func);
 TreeErr NodeVerif              (const Node_t* node, TreeErr* err, const char* file, const int line, const char* func);
@@ -213,6 +267,9 @@ TreeErr NodeVerif              (const Node_t* node, TreeErr* err, const char* fi
 
 void TreeAssertPrint(TreeErr* Err, const char* File, int Line, const char* Func);
 
+// reason of error without place and color, e.g. for error line in output
+const char* TreeErrorMessage(TreeErrorType err);
+
 
 
 
@@ -226,7 +283,7 @@ struct DefaultFunction
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static DefaultFunction DefaultFunctions[]
+static constexpr DefaultFunction DefaultFunctions[]
 {
     {"sqrt"  , Function::Sqrt  },
     {"ln"    , Function::Ln    },
@@ -251,6 +308,27 @@ const size_t DefaultFunctionsQuant = sizeof(DefaultFunctions) / sizeof(DefaultFu
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
+struct DefaultVariable
+{
+    const char* name;
+    Variable    value;
+};
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static constexpr DefaultVariable DefaultVariables[]
+{
+    {"x", Variable::x},
+    {"y", Variable::y},
+};
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+const size_t DefaultVariablesQuant = sizeof(DefaultVariables) / sizeof(DefaultVariables[0]);
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
 struct DefaultOperation
 {
     const char* name;
@@ -4,29 +4,25 @@
 #include <math.h>
 #include "TreeDump.h"
 #include "Tree.h"
-#include "ReadTree.h"
+#include "NodeTable.h"
+#include "FlatTree.h"
+#include "LetTree.h"
 #include "../Differentiator/MathFunctions.h"
 #include "../Common/GlobalInclude.h"
 
 
-static void TokenGraphicDumpHelper(const Token_t* tokenArr, size_t arrSize, const char* dotFileName, const char* file, const int line, const char* func);
-
-static void DotTokenBegin    (FILE* dotFile);
-static void CreateAllTokens  (const Token_t* tokenArr, size_t arrSize, FILE* dotFile);
-static void CreateToken      (const Token_t* token,    size_t pointer, FILE* dotFile);
-
-static const char* GetTokenColor     (const Token_t* token);
-static const char* GetTokenTypeInStr (const Token_t* token);
-static const char* GetTokenDataInStr (const Token_t* token);
-
-
 static void DotNodeBegin          (FILE* dotFile);
 static void DotEnd                (FILE* dotFile);
-static void DotCreateAllNodes     (FILE* dotFile, const Node_t* node);
+static void DotCreateAllNodes     (FILE* dotFile, const Node_t* node, NodeMap_t* visited);
+static void DotCreateNodeLabel    (FILE* dotFile, const Node_t* node);
 static void DotCreateEdges        (FILE* dotFile, const Node_t* node);
-static void DotCreateEdgesHelper  (FILE* dotFile, const Node_t* node);
+static void DotCreateEdgesHelper  (FILE* dotFile, const Node_t* node, NodeMap_t* visited);
 static void DotCreateDumpPlace    (FILE* dotFile,                               const char* file, const int line, const char* func);
 static void TreeDumpHelper        (const Node_t* node, const char* dotFileName, const char* file, const int line, const char* func);
+static void FlatTreeDumpHelper    (const FlatTree_t* flat, const char* dotFileName, const char* file, const int line, const char* func);
+static void LetTreeDumpHelper     (const LetTree_t* let,   const char* dotFileName, const char* file, const int line, const char* func);
+static void DotLetBinding         (FILE* dotFile, const LetTree_t* let, const Node_t* top, size_t owner);
+static void DotLetNodes           (FILE* dotFile, const LetTree_t* let, const Node_t* node, size_t owner);
 
 static const char* GetNodeColor       (const Node_t* node);
 static const char* GetNodeTypeInStr   (const Node_t* node);
@@ -38,52 +34,52 @@ static const char* GetFuncInStr       (Function func);
 
 static const double eps = 1e-50;
 
-//=============================== Token Dump =============================================================================================================================================
+//=============================== Tree Dump ==================================================================================================================================================
 
-void TokenTextDump(const Token_t* tokenArr, size_t tokenNum, const char* file, const int line, const char* func)
+void NodeTextDump(const Node_t* node, const char* file, const int line, const char* func)
 {
-    assert(tokenArr);
     assert(file);
-    assert(file);
-
-    COLOR_PRINT(GREEN, "\nToken Dump:\n\n");
-
-    PRINT_PLACE(BLUE, file, line, func);
+    assert(func);
 
-    COLOR_PRINT(GREEN, "\n\ntoken[%lu]:\n", tokenNum);
+    COLOR_PRINT(GREEN, "\nNode Dump:\n\n");
 
-    COLOR_PRINT(CYAN, "type: '%s'\n", GetTokenTypeInStr(&tokenArr[tokenNum]));
+    PRINT_PLACE(YELLOW, file, line, func);
+    
+    COLOR_PRINT(GREEN, "\nnode:\n");
 
-    if (tokenArr[tokenNum].type == TokenType::Number_t)
+    if (!node)
     {
-        Number number = tokenArr[tokenNum].data.number;
+        COLOR_PRINT(RED, "'nullptr'\n\n");
+        return;
+    }
 
-        if (IsDoubleEqual(number, floor(number), eps))
-        {
-            COLOR_PRINT(CYAN, "data: '%d'\n", (int) number);
-        }
+    COLOR_PRINT(CYAN,  "type = '%s'\n", GetNodeTypeInStr  (node));
 
-        else
-        {
-            COLOR_PRINT(CYAN, "data: '%lf'\n", tokenArr[tokenNum].data.number);
-        }
+    NodeArgType type = node->type;
+
+    if (type == NodeArgType::number)
+    {
+        COLOR_PRINT(CYAN, "data = '%lf'\n", node->data.num);
     }
 
     else
     {
-        COLOR_PRINT(CYAN, "data: '%s'\n", GetTokenDataInStr(&tokenArr[tokenNum]));
+        COLOR_PRINT(CYAN,  "data = '%s'\n", GetNodeDataInStr(node));
     }
 
-    COLOR_PRINT(GREEN, "\nToken Dump End.\n\n\n");
+    COLOR_PRINT(VIOLET, "left  = %p\n", node->left);
+    COLOR_PRINT(VIOLET, "right = %p\n", node->right);
+
+    COLOR_PRINT(GREEN, "\nNode Dump End.\n\n");
 
     return;
 }
 
 //----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-void TokenGraphicDump(const Token_t* tokenArr, size_t arrSize, const char* file, const int line, const char* func)
+void TreeDump(const Node_t* node, const char* file, const int line, const char* func)
 {
-    assert(tokenArr);
+    assert(node);
     assert(file);
     assert(func);
 
@@ -91,15 +87,15 @@ void TokenGraphicDump(const Token_t* tokenArr, size_t arrSize, const char* file,
 
     static const size_t MaxfileNameLen = 128;
     char outfile[MaxfileNameLen] = {};
-    sprintf(outfile, "token%lu.png", ImgQuant);
+    sprintf(outfile, "tree%lu.png", ImgQuant);
     ImgQuant++;
 
     static const size_t MaxCommandLen = 256;
     char command[MaxCommandLen] = {};
-    static const char* dotFileName = "token.dot";
+    static const char* dotFileName = "tree.dot";
     sprintf(command, "dot -Tpng %s > %s", dotFileName, outfile);
-    
-    TokenGraphicDumpHelper(tokenArr, arrSize, dotFileName, file, line, func);
+
+    TreeDumpHelper(node, dotFileName, file, line, func);
     system(command);
 
     return;
@@ -107,307 +103,219 @@ void TokenGraphicDump(const Token_t* tokenArr, size_t arrSize, const char* file,
 
 //----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static void TokenGraphicDumpHelper(const Token_t* tokenArr, size_t arrSize, const char* dotFileName, const char* file, const int line, const char* func)
+static void TreeDumpHelper(const Node_t* node, const char* dotFileName, const char* file, const int line, const char* func)
 {
-    assert(tokenArr);
+    assert(node);
+    assert(dotFileName);
     assert(file);
     assert(func);
+    assert(true || line);
 
     FILE* dotFile = fopen(dotFileName, "w");
     assert(dotFile);
 
-    DotTokenBegin(dotFile);
+    DotNodeBegin(dotFile);
 
     DotCreateDumpPlace(dotFile, file, line, func);
 
-    CreateAllTokens(tokenArr, arrSize, dotFile);
+    // nodes of hash-consed dag can have many parents, so every node is printed only once
+    NodeMap_t visited = {};
+    TREE_ASSERT(NodeMapCtor(&visited, 0));
+    DotCreateAllNodes(dotFile, node, &visited);
+    TREE_ASSERT(NodeMapDtor(&visited));
+
+    DotCreateEdges(dotFile, node);
+
     DotEnd(dotFile);
 
     fclose(dotFile);
+    dotFile = nullptr;
 
     return;
 }
 
-//----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-
-static void DotTokenBegin(FILE* dotFile)
+void FlatTreeDump(const FlatTree_t* flat, const char* file, const int line, const char* func)
 {
-    assert(dotFile);
-    fprintf(dotFile, "digraph G{\nrankdir=TB\ngraph [bgcolor=\"#000000\"];\nsize = \"100 5\"\n");
-    return;
-}
+    assert(flat);
+    assert(file);
+    assert(func);
 
-//----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+    static size_t ImgQuant = 1;
 
-static void CreateAllTokens(const Token_t* tokenArr, size_t arrSize, FILE* dotFile)
-{
-    assert(tokenArr);
-    assert(dotFile);
+    static const size_t MaxfileNameLen = 128;
+    char outfile[MaxfileNameLen] = {};
+    sprintf(outfile, "flat_tree%lu.png", ImgQuant);
+    ImgQuant++;
 
-    for (size_t i = 0; i < arrSize; i++)
-    {
-        CreateToken(&tokenArr[i], i, dotFile);
-    }
+    static const size_t MaxCommandLen = 256;
+    char command[MaxCommandLen] = {};
+    static const char* dotFileName = "flat_tree.dot";
+    sprintf(command, "dot -Tpng %s > %s", dotFileName, outfile);
+
+    FlatTreeDumpHelper(flat, dotFileName, file, line, func);
+    system(command);
 
     return;
 }
 
 //----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static void CreateToken(const Token_t* token, size_t pointer, FILE* dotFile)
+// flat tree is dumped by two linear passes over its arrays, index of node is its name in dot file
+static void FlatTreeDumpHelper(const FlatTree_t* flat, const char* dotFileName, const char* file, const int line, const char* func)
 {
-    assert(dotFile);
-
-    if (!token)
-    {
-        fprintf(dotFile, "token%lu", pointer);
-        fprintf(dotFile, "[shape=Mrecord, style=filled, fillcolor=\"#0125fe\", ");
-        fprintf(dotFile, "label = \"nullptr\"");
-        fprintf(dotFile, "color = \"#777777\"];\n");
-        return;
-    }
-
-    const char* tokenColor = GetTokenColor(token);
-
-    assert(tokenColor);
-
-    TokenType type = token->type;
+    assert(flat);
+    assert(dotFileName);
+    assert(file);
+    assert(func);
+    assert(true || line);
 
-    fprintf(dotFile, "token%lu", pointer);
-    fprintf(dotFile, "[shape=Mrecord, style=filled, fillcolor=\"%s\",", tokenColor);
+    FILE* dotFile = fopen(dotFileName, "w");
+    assert(dotFile);
 
-    const char* tokenType = GetTokenTypeInStr(token);
-    assert(tokenType);
+    DotNodeBegin(dotFile);
 
-    fprintf(dotFile, "label = \" { %s | ", tokenType);
+    DotCreateDumpPlace(dotFile, file, line, func);
 
-    if (type == TokenType::Number_t)
+    for (size_t i = 0; i < flat->size; i++)
     {
-        Number number = token->data.number;
-        fprintf(dotFile, " %lf | ", number);
-    }
+        Node_t view = {};
+        view.type = flat->type[i];
+        view.data = flat->data[i];
 
-    else
-    {
-        const char* tokenData  = GetTokenDataInStr(token);
-        assert(tokenData);
-        fprintf(dotFile, "%s | ", tokenData);
+        fprintf(dotFile, "node%lu", i);
+        DotCreateNodeLabel(dotFile, &view);
     }
 
-    fprintf(dotFile, " token[%lu] | ", pointer + 1);
-    fprintf(dotFile, " input::%lu::%lu } \", ", token->place.line, token->place.placeInLine);
-    fprintf(dotFile, "color = \"#777777\"];\n");
-
-    return;
-}
-
-//---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-
-static const char* GetTokenColor(const Token_t* token)
-{
-    assert(token);
-
-    TokenType type = token->type;
+    fprintf(dotFile, "edge[color=\"#373737\"];\n");
 
-    switch (type)
+    for (size_t i = 0; i < flat->size; i++)
     {
-        case TokenType::Number_t:      return "#1cb9ff";
-        case TokenType::Variable_t:    return "#f31807";
-        case TokenType::Operation_t:   return "#00ca2c";
-        case TokenType::Function_t:    return "#0cf108";
-        case TokenType::Bracket_t:     return "#e69c0c";
-        case TokenType::EndSymbol_t:   return "#ffffff";
-        default: assert(0 && "undefined token type."); break; 
+        if (flat->left [i] != FlatNull) fprintf(dotFile, "node%lu->node%u;\n", i, flat->left [i]);
+        if (flat->right[i] != FlatNull) fprintf(dotFile, "node%lu->node%u;\n", i, flat->right[i]);
     }
 
-    assert(0 && "we must not be here");
-    return "wtf";
-}
-
-//---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-
-static const char* GetTokenTypeInStr(const Token_t* token)
-{
-    assert(token);
-
-    TokenType type = token->type;
+    DotEnd(dotFile);
 
-    switch (type)
-    {
-        case TokenType::Number_t:    return "number";
-        case TokenType::Variable_t:  return "variable";
-        case TokenType::Operation_t: return "operation";
-        case TokenType::Function_t:  return "function";
-        case TokenType::Bracket_t:   return "bracket";
-        case TokenType::EndSymbol_t: return "end";
-        default: assert(0 && "nudefindef type."); return "undefined";
-    }
+    fclose(dotFile);
+    dotFile = nullptr;
 
-    return "undefined";
+    return;
 }
 
-//---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static const char* GetTokenDataInStr(const Token_t* token)
+void LetTreeDump(const LetTree_t* let, const char* file, const int line, const char* func)
 {
-    assert(token);
-
-    TokenType type = token->type;
+    assert(let);
+    assert(file);
+    assert(func);
 
-    switch (type)
-    {
-        case TokenType::Number_t:
-        {    
-            assert(0 && "Number is drugaja situation.");
-            return "undefined";
-        }
+    static size_t ImgQuant = 1;
 
-        case TokenType::Variable_t:
-        {
-            Variable variable = token->data.variable;
-            switch (variable)
-            {
-                case Variable::x: return "x";
-                case Variable::y: return "y";
-                case Variable::undefined_variable:
-                default: assert(0 && "undefined variable."); break;
-            }
-            break;
-        }
-    
-        case TokenType::Operation_t:
-        {
-            Operation operation = token->data.operation;
-            return GetOperationInStr(operation); //
-        }
-        case TokenType::Function_t:
-        {
-            Function function = token->data.function;
-            return GetFuncInStr(function); //
-        }
-         
-        case TokenType::Bracket_t:
-        {
-            Bracket bracket = token->data.bracket;
-            switch (bracket)
-            {
-                case Bracket::left: return "(";
-                case Bracket::right: return ")";
-                default: assert(0 && "undefined bracket type."); break;
-            }
-            break;
-        }
-    
-        case TokenType::EndSymbol_t:
-        {
-            EndSymbol end = token->data.end;
-            switch (end)
-            {
-                case EndSymbol::end: return "$";
-                default: assert(0 && "undefined end syn=mbol.");
-            }
-            break;
-        }
-        default: assert(0 && "undefined type."); return "undefined";
-    }
+    static const size_t MaxfileNameLen = 128;
+    char outfile[MaxfileNameLen] = {};
+    sprintf(outfile, "let_tree%lu.png", ImgQuant);
+    ImgQuant++;
 
-    return "undefined";
-}
+    static const size_t MaxCommandLen = 256;
+    char command[MaxCommandLen] = {};
+    static const char* dotFileName = "let_tree.dot";
+    sprintf(command, "dot -Tpng %s > %s", dotFileName, outfile);
 
-//=============================== Token Dump End =============================================================================================================================================
+    LetTreeDumpHelper(let, dotFileName, file, line, func);
+    system(command);
 
+    return;
+}
 
-//=============================== Tree Dump ==================================================================================================================================================
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-void NodeTextDump(const Node_t* node, const char* file, const int line, const char* func)
+static void LetTreeDumpHelper(const LetTree_t* let, const char* dotFileName, const char* file, const int line, const char* func)
 {
+    assert(let);
+    assert(dotFileName);
     assert(file);
     assert(func);
+    assert(true || line);
 
-    COLOR_PRINT(GREEN, "\nNode Dump:\n\n");
-
-    PRINT_PLACE(YELLOW, file, line, func);
-    
-    COLOR_PRINT(GREEN, "\nnode:\n");
+    FILE* dotFile = fopen(dotFileName, "w");
+    assert(dotFile);
 
-    if (!node)
-    {
-        COLOR_PRINT(RED, "'nullptr'\n\n");
-        return;
-    }
+    DotNodeBegin(dotFile);
 
-    COLOR_PRINT(CYAN,  "type = '%s'\n", GetNodeTypeInStr  (node));
+    DotCreateDumpPlace(dotFile, file, line, func);
 
-    NodeArgType type = node->type;
+    fprintf(dotFile, "edge[color=\"#373737\"];\n");
 
-    if (type == NodeArgType::number)
+    for (size_t i = 0; i < let->size; i++)
     {
-        COLOR_PRINT(CYAN, "data = '%lf'\n", node->data.num);
+        DotLetBinding(dotFile, let, let->bindings[i], i);
     }
 
-    else
-    {
-        COLOR_PRINT(CYAN,  "data = '%s'\n", GetNodeDataInStr(node));
-    }
+    DotLetBinding(dotFile, let, let->result, let->size);
 
-    COLOR_PRINT(VIOLET, "left  = %p\n", node->left);
-    COLOR_PRINT(VIOLET, "right = %p\n", node->right);
+    DotEnd(dotFile);
 
-    COLOR_PRINT(GREEN, "\nNode Dump End.\n\n");
+    fclose(dotFile);
+    dotFile = nullptr;
 
     return;
 }
 
-//----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-void TreeDump(const Node_t* node, const char* file, const int line, const char* func)
+// every binding is drawn as own tree, binding number is prefix of names of its nodes, result has number let->size
+static void DotLetBinding(FILE* dotFile, const LetTree_t* let, const Node_t* top, size_t owner)
 {
-    assert(node);
-    assert(file);
-    assert(func);
+    assert(dotFile);
+    assert(let);
+    assert(top);
 
-    static size_t ImgQuant = 1;
+    fprintf(dotFile, "let%lu[shape=Mrecord, style=filled, fillcolor=\"#1771a0\", ", owner);
 
-    static const size_t MaxfileNameLen = 128;
-    char outfile[MaxfileNameLen] = {};
-    sprintf(outfile, "tree%lu.png", ImgQuant);
-    ImgQuant++;
+    if (owner < let->size) fprintf(dotFile, "label = \"t%lu =\", ", owner);
+    else                   fprintf(dotFile, "label = \"result =\", ");
 
-    static const size_t MaxCommandLen = 256;
-    char command[MaxCommandLen] = {};
-    static const char* dotFileName = "tree.dot";
-    sprintf(command, "dot -Tpng %s > %s", dotFileName, outfile);
+    fprintf(dotFile, "color = \"#777777\"];\n");
+    fprintf(dotFile, "let%lu->let%lu_node%p;\n", owner, owner, top);
 
-    TreeDumpHelper(node, dotFileName, file, line, func);
-    system(command);
+    DotLetNodes(dotFile, let, top, owner);
 
     return;
 }
 
-//----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static void TreeDumpHelper(const Node_t* node, const char* dotFileName, const char* file, const int line, const char* func)
+// node of earlier binding is drawn as leaf with its name
+static void DotLetNodes(FILE* dotFile, const LetTree_t* let, const Node_t* node, size_t owner)
 {
+    assert(dotFile);
+    assert(let);
     assert(node);
-    assert(dotFileName);
-    assert(file);
-    assert(func);
-    assert(true || line);
 
-    FILE* dotFile = fopen(dotFileName, "w");
-    assert(dotFile);
+    fprintf(dotFile, "let%lu_node%p", owner, node);
 
-    DotNodeBegin(dotFile);
+    size_t binding = LetTreeFind(let, node);
 
-    DotCreateDumpPlace(dotFile, file, line, func);
+    if (binding < owner)
+    {
+        fprintf(dotFile, "[shape=Mrecord, style=filled, fillcolor=\"#1771a0\", label = \"t%lu\", color = \"#777777\"];\n", binding);
+        return;
+    }
 
-    DotCreateAllNodes(dotFile, node);
-    DotCreateEdges(dotFile, node);
+    DotCreateNodeLabel(dotFile, node);
 
-    DotEnd(dotFile);
+    if (node->left)
+    {
+        fprintf(dotFile, "let%lu_node%p->let%lu_node%p;\n", owner, node, owner, node->left);
+        DotLetNodes(dotFile, let, node->left, owner);
+    }
 
-    fclose(dotFile);
-    dotFile = nullptr;
+    if (node->right)
+    {
+        fprintf(dotFile, "let%lu_node%p->let%lu_node%p;\n", owner, node, owner, node->right);
+        DotLetNodes(dotFile, let, node->right, owner);
+    }
 
     return;
 }
@@ -423,14 +331,39 @@ static void DotNodeBegin(FILE* dotFile)
 
 //---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static void DotCreateAllNodes(FILE* dotFile, const Node_t* node)
+static void DotCreateAllNodes(FILE* dotFile, const Node_t* node, NodeMap_t* visited)
 {
     assert(dotFile);
     assert(node);
+    assert(visited);
 
+    if (NodeMapContains(visited, node)) return;
+    TREE_ASSERT(NodeMapInsert(visited, node, nullptr));
 
-    const char* nodeColor = GetNodeColor(node);
     fprintf(dotFile, "node%p", node);
+    DotCreateNodeLabel(dotFile, node);
+
+    if (node->left)
+    {
+        DotCreateAllNodes(dotFile, node->left, visited);
+    }
+
+    if (node->right)
+    {
+        DotCreateAllNodes(dotFile, node->right, visited);
+    }
+
+    return;
+}
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static void DotCreateNodeLabel(FILE* dotFile, const Node_t* node)
+{
+    assert(dotFile);
+    assert(node);
+
+    const char* nodeColor = GetNodeColor(node);
     fprintf(dotFile, "[shape=Mrecord, style=filled, fillcolor=\"%s\"", nodeColor);
 
     NodeArgType type = node->type;
@@ -462,16 +395,6 @@ static void DotCreateAllNodes(FILE* dotFile, const Node_t* node)
 
     fprintf(dotFile, "color = \"#777777\"];\n");
 
-    if (node->left)
-    {
-        DotCreateAllNodes(dotFile, node->left);
-    }
-
-    if (node->right)
-    {
-        DotCreateAllNodes(dotFile, node->right);
-    }
-
     return;
 }
 
@@ -483,30 +406,38 @@ static void DotCreateEdges(FILE* dotFile, const Node_t* node)
     assert(node);
 
     fprintf(dotFile, "edge[color=\"#373737\"];\n");
-    DotCreateEdgesHelper(dotFile, node);
+
+    NodeMap_t visited = {};
+    TREE_ASSERT(NodeMapCtor(&visited, 0));
+    DotCreateEdgesHelper(dotFile, node, &visited);
+    TREE_ASSERT(NodeMapDtor(&visited));
 
     return;
 }
 
 //----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static void DotCreateEdgesHelper(FILE* dotFile, const Node_t* node)
+static void DotCreateEdgesHelper(FILE* dotFile, const Node_t* node, NodeMap_t* visited)
 {
     assert(dotFile);
     assert(node);
+    assert(visited);
+
+    if (NodeMapContains(visited, node)) return;
+    TREE_ASSERT(NodeMapInsert(visited, node, nullptr));
 
     if (node->left)
     {
         fprintf(dotFile, "node%p->node%p;\n", node, node->left);
 
-        DotCreateEdgesHelper(dotFile, node->left);
+        DotCreateEdgesHelper(dotFile, node->left, visited);
     }
 
     if (node->right)
     {
         fprintf(dotFile, "node%p->node%p;\n", node, node->right);
 
-        DotCreateEdgesHelper(dotFile, node->right);
+        DotCreateEdgesHelper(dotFile, node->right, visited);
     }
 
     return;
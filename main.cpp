@@ -1,14 +1,38 @@
 #include <stdio.h>
+#include <assert.h>
 #include "Tree/Tree.h"
 #include "Tree/TreeDump.h"
 #include "Differentiator/Differentiator.h"
 #include "Differentiator/SimplifyTree.h"
+#include "Differentiator/EGraph.h"
 #include "Differentiator/Taylor.h"
 #include "Tree/ReadTree.h"
+#include "Tree/LetTree.h"
+#include "Differentiator/BatchEval.h"
+#include "Differentiator/Jit.h"
+#include "Tree/BulkInput.h"
+#include "Differentiator/BatchDiff.h"
 
+static TreeErr SampleDerivative    (const Tree_t* tree);
+static TreeErr BenchmarkDerivative (const Tree_t* tree);
+static TreeErr DiffFile            (const char* input, const char* output, size_t threads, size_t* errors);
 
-int main()
+
+// ./main.exe corpus.txt [derivatives.txt] [threads] differentiates every expression of file ('$' or new line after each one),
+// derivatives are written in input order (to stdout, if there is no output file), threads = 0 is all cores.
+// exit status is EXIT_FAILURE, if some expression was rejected
+int main(int argc, const char* argv[])
 {
+    if (argc > 1)
+    {
+        const char* output  = (argc > 2) ? argv[2] : nullptr;
+        size_t      threads = (argc > 3) ? strtoul(argv[3], nullptr, 10) : 0;
+        size_t      errors  = 0;
+
+        TREE_ASSERT(DiffFile(argv[1], output, threads, &errors));
+        return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     Tree_t tree = {};
 
     const char* input = "arccos(x)^arcsin(x)$";
@@ -22,8 +46,20 @@ int main()
     TREE_ASSERT(SimplifyTree(&tree));
     TREE_GRAPHIC_DUMP(tree.root);
 
+    // rules of SimplifyTree go one way, e-graph keeps every equal form and takes the smallest one
+    TREE_ASSERT(EGraphSimplify(&tree, &EGraphDefaultBudget));
+    TREE_GRAPHIC_DUMP(tree.root);
+
+    LetTree_t let = {};
+    TREE_ASSERT(LetTreeCtor(&let, &tree));
+    LET_TREE_GRAPHIC_DUMP(&let);
+    TREE_ASSERT(LetTreeDtor(&let));
+
+    TREE_ASSERT(SampleDerivative(&tree));
+    TREE_ASSERT(BenchmarkDerivative(&tree));
+
     Tree_t taylor = {};
-    TREE_ASSERT(Taylor(&tree, &taylor, 3));
+    TREE_ASSERT(Taylor(&tree, &taylor, 3, 0));
     TREE_GRAPHIC_DUMP(taylor.root);
 
     TREE_ASSERT(SimplifyTree(&taylor));
@@ -33,4 +69,95 @@ int main()
     TREE_ASSERT(TreeDtor(&tree));
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
+
+
+static TreeErr SampleDerivative(const Tree_t* tree)
+{
+    TreeErr err = {};
+
+    static const size_t PointsQuant = 1 << 20;
+
+    Number* x   = (Number*) calloc(PointsQuant, sizeof(Number));
+    Number* out = (Number*) calloc(PointsQuant, sizeof(Number));
+
+    if (!x || !out)
+    {
+        FREE(x);
+        FREE(out);
+        err.err = TreeErrorType::CTOR_CALLOC_RETURN_NULL;
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    for (size_t i = 0; i < PointsQuant; i++) x[i] = -0.9 + 1.8 * (double) i / PointsQuant;
+
+    Bytecode_t bytecode = {};
+    TREE_ASSERT(BytecodeCompile(tree, &bytecode));
+
+    BatchStats_t stats = {};
+    TREE_ASSERT(BatchEval(&bytecode, x, nullptr, out, PointsQuant, &stats));
+
+    COLOR_PRINT(GREEN, "derivative sampled at %lu points: %.3lf s, %.3le points/s\n", stats.points, stats.seconds, stats.pointsPerSecond);
+
+    TREE_ASSERT(BytecodeDtor(&bytecode));
+
+    FREE(x);
+    FREE(out);
+
+    return err;
+}
+
+
+static TreeErr BenchmarkDerivative(const Tree_t* tree)
+{
+    TreeErr err = {};
+
+    static const size_t PointsQuant = 1 << 18;
+
+    JitBenchmark_t bench = {};
+    TREE_ASSERT(JitBenchmark(tree, PointsQuant, &bench));
+
+    COLOR_PRINT(GREEN, "tree walk: %.3lf s, bytecode: %.3lf s, jit: %.3lf s (%.1lfx faster, than tree walk)\n",
+                bench.treeSeconds, bench.bytecodeSeconds, bench.jitSeconds, bench.treeSeconds / bench.jitSeconds);
+
+    return err;
+}
+
+
+// expressions are parsed right from mapped file, nothing is copied
+static TreeErr DiffFile(const char* input, const char* output, size_t threads, size_t* errors)
+{
+    assert(errors);
+
+    TreeErr err = {};
+
+    FILE* out = output ? fopen(output, "w") : stdout;
+
+    if (!out)
+    {
+        err.err = TreeErrorType::OUTPUT_FILE_OPEN_FAILED;
+        CodePlaceCtor(&err.place, __FILE__, __LINE__, __func__);
+        return err;
+    }
+
+    BulkInput_t bulk = {};
+    TREE_ASSERT(BulkInputCtor(&bulk, input));
+
+    BatchDiffStats_t stats = {};
+    TREE_ASSERT(BatchDiff(&bulk, out, threads, &stats));
+
+    if (output) fclose(out);
+
+    // stdout may be derivatives stream, so stats go to stderr
+    COLOR_FPRINT(stderr, GREEN, "%lu expressions (%lu bytes) differentiated by %lu threads: %.3lf s, %.3le expressions/s\n",
+                 stats.expressions, bulk.size, stats.threads, stats.seconds, stats.expressionsPerSecond);
+
+    if (stats.errors > 0) COLOR_FPRINT(stderr, RED, "%lu expressions failed, see error lines in output\n", stats.errors);
+
+    *errors = stats.errors;
+
+    TREE_ASSERT(BulkInputDtor(&bulk));
+
+    return err;
+}